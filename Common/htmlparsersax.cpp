@@ -1,123 +1,255 @@
 #include "htmlparsersax.h"
+namespace
+{
+    const struct
+    {
+        const char *name;
+        ushort ch;
+    } entities[]=
+    {
+        {"amp",'&'},
+        {"lt",'<'},
+        {"gt",'>'},
+        {"quot",'"'},
+        {"apos",'\''},
+        {"nbsp",0xa0}
+    };
+    QString decodeEntities(const QStringRef &ref)
+    {
+        int ampPos=ref.indexOf('&');
+        if(ampPos==-1) return ref.toString();
+        QString text;
+        text.reserve(ref.size());
+        text.append(ref.left(ampPos));
+        const QChar *begin=ref.unicode(), *end=begin+ref.size();
+        for(const QChar *iter=begin+ampPos;iter!=end;++iter)
+        {
+            if(*iter!='&')
+            {
+                text+=*iter;
+                continue;
+            }
+            const QChar *semi=iter+1;
+            while(semi!=end && semi-iter<12 && *semi!=';' && *semi!='&') ++semi;
+            if(semi==end || *semi!=';')
+            {
+                text+=*iter;
+                continue;
+            }
+            QStringRef name(ref.string(),ref.position()+int(iter-begin)+1,int(semi-iter)-1);
+            uint ch=0;
+            if(name.startsWith('#'))
+            {
+                bool ok;
+                if(name.size()>1 && (name.at(1)=='x' || name.at(1)=='X'))
+                    ch=name.mid(2).toUInt(&ok,16);
+                else
+                    ch=name.mid(1).toUInt(&ok);
+                if(!ok) ch=0;
+            }
+            else
+            {
+                for(const auto &entity:entities)
+                {
+                    if(name==QLatin1String(entity.name))
+                    {
+                        ch=entity.ch;
+                        break;
+                    }
+                }
+            }
+            if(ch==0)
+            {
+                text+=*iter;
+                continue;
+            }
+            if(QChar::requiresSurrogates(ch))
+            {
+                text+=QChar(QChar::highSurrogate(ch));
+                text+=QChar(QChar::lowSurrogate(ch));
+            }
+            else
+            {
+                text+=QChar(ch);
+            }
+            iter=semi;
+        }
+        return text;
+    }
+}
 
 void HTMLParserSax::parseNode()
 {
-    begin++;
-    if(begin==end)return;
-    if(*begin=='!')
+    pos++;
+    if(pos>=length)return;
+    if(data[pos]=='!')
     {
         parseComment();
-		nodeName.clear();
-		propertyMap.clear();
+        clearNode();
         return;
     }
-    QString::const_iterator iter=begin;
-    nodeName.clear();
-    isStart=!(*iter=='/');
+    int iter=pos;
+    isStart=!(data[iter]=='/');
     if(!isStart)iter++;
-    while (iter!=end && iter->isLetterOrNumber()) nodeName+=*iter++;
-    propertyMap.clear();
-    while(iter!=end && *iter!='>')
+    int nameStart=iter;
+    while (iter<length && data[iter].isLetterOrNumber()) iter++;
+    nodeName=QStringRef(&content,nameStart,iter-nameStart);
+    properties.resize(0);
+    while(iter<length && data[iter]!='>')
     {
-        while(iter!=end && iter->isSpace())iter++;
-        if(*iter=='/')
+        while(iter<length && data[iter].isSpace())iter++;
+        if(iter>=length)break;
+        if(data[iter]=='/')
         {
-            while(iter!=end && *iter!='>')iter++;
+            while(iter<length && data[iter]!='>')iter++;
             break;
         }
-        else if(*iter!='>')
+        else if(data[iter]!='>')
         {
-            QString propertyName,propertyVal;
-            while (iter!=end && *iter!='=') propertyName+=*iter++;
-            iter++;
-            QChar q(*iter++);
-            while (iter!=end && *iter!=q) propertyVal+=*iter++;
-            propertyMap.insert(propertyName,propertyVal);
-            iter++;
+            int propStart=iter;
+            while (iter<length && data[iter]!='=' && data[iter]!='>' && !data[iter].isSpace()) iter++;
+            Property property;
+            property.name=QStringRef(&content,propStart,iter-propStart);
+            if(iter<length && data[iter]=='=')
+            {
+                iter++;
+                int valStart;
+                if(iter<length && (data[iter]=='"' || data[iter]=='\''))
+                {
+                    QChar q(data[iter++]);
+                    valStart=iter;
+                    while (iter<length && data[iter]!=q) iter++;
+                    property.value=QStringRef(&content,valStart,iter-valStart);
+                    if(iter<length)iter++;
+                }
+                else
+                {
+                    valStart=iter;
+                    while (iter<length && data[iter]!='>' && !data[iter].isSpace()) iter++;
+                    property.value=QStringRef(&content,valStart,iter-valStart);
+                }
+            }
+            if(!property.name.isEmpty())
+                properties.append(property);
         }
     }
-    if(*iter=='>')iter++;
-    begin=iter;
+    if(iter<length && data[iter]=='>')iter++;
+    pos=iter;
 }
 
 void HTMLParserSax::parseComment()
 {
     int commentState=0;
-    while(begin!=end)
+    while(pos<length)
     {
-        if(*begin=='-')
+        if(data[pos]=='-')
         {
             if(commentState==0)commentState=1;
             else if(commentState==1)commentState=2;
         }
-        else if(*begin=='>' && commentState==2)
+        else if(data[pos]=='>' && commentState==2)
         {
-            begin++;
+            pos++;
             break;
         }
         else
         {
             commentState=0;
         }
-        begin++;
+        pos++;
     }
 }
 
-void HTMLParserSax::skip()
+void HTMLParserSax::clearNode()
 {
-    while(begin!=end)
+    isStart=false;
+    nodeName=QStringRef();
+    properties.resize(0);
+}
+
+QStringRef HTMLParserSax::findProperty(QLatin1String name) const
+{
+    for(const Property &property:properties)
     {
-        if(*begin!='<')begin++;
-        else return;
+        if(property.name==name) return property.value;
     }
+    return QStringRef();
 }
 
-HTMLParserSax::HTMLParserSax(const QString &content):isStart(false)
+QStringRef HTMLParserSax::findProperty(const QString &name) const
 {
-    begin=content.cbegin();
-    end=content.cend();
+    for(const Property &property:properties)
+    {
+        if(property.name==name) return property.value;
+    }
+    return QStringRef();
+}
+
+HTMLParserSax::HTMLParserSax(const QString &content):content(content),isStart(false)
+{
+    data=this->content.constData();
+    pos=0;
+    length=this->content.length();
 }
 
 void HTMLParserSax::readNext()
 {
-    if(begin==end)return;
-    if(begin->isSpace())
-        while(begin!=end && begin->isSpace())begin++;
-    if(*begin=='<')
+    if(pos>=length)return;
+    while(pos<length && data[pos].isSpace())pos++;
+    if(pos<length && data[pos]=='<')
     {
         parseNode();
     }
     else
     {
-        skip();
-        isStart=false;
-        nodeName.clear();
-        propertyMap.clear();
+        //QString::indexOf scans for a single QChar with SIMD
+        pos=content.indexOf('<',pos);
+        if(pos==-1)pos=length;
+        clearNode();
     }
 }
 
 QString HTMLParserSax::readContentText()
 {
-    int contentState=0;
-    QString text;
-    while(begin!=end)
+    int textEnd=content.indexOf(QLatin1String("</"),pos);
+    if(textEnd==-1)textEnd=length;
+    QStringRef text(&content,pos,textEnd-pos);
+    pos=textEnd;
+    return decodeEntities(text);
+}
+
+bool HTMLParserSax::seekTo(const char *tag, const char *className)
+{
+    QLatin1String tagName(tag),classToken(className);
+    while(pos<length)
     {
-        if(*begin=='<')
+        pos=content.indexOf('<',pos);
+        if(pos==-1)
         {
-            if(contentState==0)contentState=1;
-        }
-        else if(*begin=='/' && contentState==1)
-        {
-            begin-=1;
+            pos=length;
             break;
         }
-        else
+        parseNode();
+        if(!isStart)continue;
+        if(tagName.size()>0 && nodeName.compare(tagName,Qt::CaseInsensitive)!=0)continue;
+        if(!className)return true;
+        QStringRef classVal(findProperty(QLatin1String("class")));
+        //class holds space separated names
+        for(const QStringRef &cls:classVal.split(' ',QString::SkipEmptyParts))
         {
-            if(contentState==1)
-                text+='<';
-            text+=*begin;
+            if(cls==classToken)return true;
         }
-        begin++;
     }
-    return text;
+    clearNode();
+    return false;
+}
+
+QString HTMLParserSax::currentNodeProperty(const char *name) const
+{
+    return decodeEntities(findProperty(QLatin1String(name)));
+}
+
+QString HTMLParserSax::currentNodeProperty(const QString &name) const
+{
+    return decodeEntities(findProperty(name));
 }
@@ -2,25 +2,40 @@
 #define HTMLPARSERSAX_H
 #include <QtCore>
 
+//Node names and properties are views into the content, nothing is copied until a value is read
 class HTMLParserSax
 {
-    QString::const_iterator begin,end;
+    struct Property
+    {
+        QStringRef name,value;
+    };
+    const QString content;
+    const QChar *data;
+    int pos,length;
 
-    QString nodeName;
-    QMap<QString,QString> propertyMap;
+    QStringRef nodeName;
+    QVarLengthArray<Property,8> properties;
     bool isStart;
     void parseNode();
     void parseComment();
-    void skip();
+    void clearNode();
+    QStringRef findProperty(QLatin1String name) const;
+    QStringRef findProperty(const QString &name) const;
+    Q_DISABLE_COPY(HTMLParserSax)
 public:
     HTMLParserSax(const QString &content);
     void readNext();
-    inline bool atEnd(){return begin==end;}
+    inline bool atEnd(){return pos>=length;}
     QString readContentText();
+    //skip to the next start node with this tag name(any tag if empty) and class, false if no such node
+    bool seekTo(const char *tag, const char *className=nullptr);
 
     inline bool isStartNode(){return isStart;}
-    inline const QString &currentNode(){return nodeName;}
-    inline QString currentNodeProperty(const QString &name){return propertyMap.value(name);}
+    inline const QStringRef &currentNode(){return nodeName;}
+    //entities are decoded here, the raw view is enough for comparing
+    QString currentNodeProperty(const char *name) const;
+    QString currentNodeProperty(const QString &name) const;
+    inline QStringRef currentNodePropertyRef(const char *name) const {return findProperty(QLatin1String(name));}
 
 };
 
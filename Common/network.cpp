@@ -1,161 +1,484 @@
 #include "network.h"
 
-QByteArray Network::httpGet(const QString &url, QUrlQuery &query, QStringList &header)
+namespace
 {
-    QUrl queryUrl(url);
-    if(!query.isEmpty())
-        queryUrl.setQuery(query);
-    QNetworkRequest request;
-    request.setUrl(queryUrl);
-    if(header.size()>=2)
+    QThreadStorage<QNetworkAccessManager *> managers;
+    const struct
+    {
+        const char *prefix;
+        int ttl;
+    } cacheRules[]={
+        //search
+        {"search.aixifan.com/search",3600},
+        {"api.bilibili.com/x/web-interface/search",3600},
+        {"api.acplay.net/api/v2/search",3600},
+        {"ani.gamer.com.tw/search.php",3600},
+        {"www.5dm.tv/search",3600},
+        {"so.iqiyi.com/so",3600},
+        {"api.bgm.tv/search",3600},
+        //episode and anime metadata
+        {"bangumi.bilibili.com/view/web_api/season",86400},
+        {"ani.gamer.com.tw/animeRef.php",86400},
+        {"ani.gamer.com.tw/animeVideo.php",86400},
+        {"www.acfun.cn/v/",86400},
+        {"www.acfun.cn/bangumi/",86400},
+        {"api.bgm.tv/subject/",86400},
+        {"bgm.tv/subject/",86400}
+    };
+    struct FixtureConfig
+    {
+        enum Mode
+        {
+            Off,
+            Record,
+            Replay
+        };
+        Mode mode;
+        QString dir;
+        int latency;
+        int bandwidth; //bytes per ms, 0: unlimited
+    };
+    const quint32 fixtureMagic=0x4b504658; //KPFX
+    const FixtureConfig &fixtureConfig()
+    {
+        static const FixtureConfig config=[](){
+            FixtureConfig config;
+            QByteArray mode(qgetenv("KIKOPLAY_FIXTURE"));
+            config.mode=mode=="record"?FixtureConfig::Record:(mode=="replay"?FixtureConfig::Replay:FixtureConfig::Off);
+            config.dir=QString::fromLocal8Bit(qgetenv("KIKOPLAY_FIXTURE_DIR"));
+            if(config.dir.isEmpty())config.dir=QCoreApplication::applicationDirPath()+"/fixtures";
+            config.latency=qEnvironmentVariableIntValue("KIKOPLAY_FIXTURE_LATENCY");
+            config.bandwidth=qEnvironmentVariableIntValue("KIKOPLAY_FIXTURE_BANDWIDTH")*1024/1000;
+            if(config.mode!=FixtureConfig::Off)QDir().mkpath(config.dir);
+            return config;
+        }();
+        return config;
+    }
+    QString fixtureFile(QNetworkAccessManager::Operation op,const QUrl &url,const QByteArray &data)
+    {
+        QByteArray key(op==QNetworkAccessManager::PostOperation?"POST ":"GET ");
+        key.append(url.toEncoded());
+        key.append('\n');
+        key.append(data);
+        return QString("%1/%2.fixture").arg(fixtureConfig().dir,QString(QCryptographicHash::hash(key,QCryptographicHash::Sha1).toHex()));
+    }
+    QNetworkRequest buildRequest(const QUrl &url,const QStringList &header)
     {
-        for(int i=0;i<header.size();i+=2)
-            request.setRawHeader(header[i].toUtf8(),header[i+1].toUtf8());
+        QNetworkRequest request;
+        request.setUrl(url);
+        if(header.size()>=2)
+        {
+            for(int i=0;i<header.size();i+=2)
+                request.setRawHeader(header[i].toUtf8(),header[i+1].toUtf8());
+        }
+        //request.setRawHeader("User-Agent", "Mozilla/5.0 (Windows NT 10.0; Win64; x64; rv:62.0) Gecko/20100101 Firefox/62.0");
+        //Accept-Encoding is left to QNetworkAccessManager, which adds gzip/deflate and decodes the reply itself
+        return request;
     }
-	//request.setRawHeader("User-Agent", "Mozilla/5.0 (Windows NT 10.0; Win64; x64; rv:62.0) Gecko/20100101 Firefox/62.0");
-    QTimer timer;
-    timer.setInterval(timeout);
+}
+
+QNetworkAccessManager *Network::manager()
+{
+    if(!managers.hasLocalData())
+        managers.setLocalData(new QNetworkAccessManager);
+    return managers.localData();
+}
+
+Network::SharedDiskCache::SharedDiskCache(const QString &cacheDir, qint64 maxSize)
+{
+    diskCache.setCacheDirectory(cacheDir);
+    diskCache.setMaximumCacheSize(maxSize);
+}
+
+QNetworkCacheMetaData Network::SharedDiskCache::metaData(const QUrl &url)
+{
+    QMutexLocker locker(&lock);
+    return diskCache.metaData(url);
+}
+
+void Network::SharedDiskCache::updateMetaData(const QNetworkCacheMetaData &metaData)
+{
+    QMutexLocker locker(&lock);
+    diskCache.updateMetaData(metaData);
+}
+
+QIODevice *Network::SharedDiskCache::data(const QUrl &url)
+{
+    QMutexLocker locker(&lock);
+    return diskCache.data(url);
+}
+
+bool Network::SharedDiskCache::remove(const QUrl &url)
+{
+    QMutexLocker locker(&lock);
+    return diskCache.remove(url);
+}
+
+qint64 Network::SharedDiskCache::cacheSize() const
+{
+    QMutexLocker locker(&lock);
+    return diskCache.cacheSize();
+}
+
+QIODevice *Network::SharedDiskCache::prepare(const QNetworkCacheMetaData &metaData)
+{
+    QMutexLocker locker(&lock);
+    return diskCache.prepare(metaData);
+}
+
+void Network::SharedDiskCache::insert(QIODevice *device)
+{
+    QMutexLocker locker(&lock);
+    diskCache.insert(device);
+}
+
+void Network::SharedDiskCache::clear()
+{
+    QMutexLocker locker(&lock);
+    diskCache.clear();
+}
+
+QAbstractNetworkCache *Network::cache()
+{
+    //one directory and one size limit for the whole process
+    static SharedDiskCache *sharedCache=new SharedDiskCache(QCoreApplication::applicationDirPath()+"/cache/network",maxCacheSize);
+    return sharedCache;
+}
+
+int Network::cacheTTL(const QUrl &url)
+{
+    QString target(url.host()+url.path());
+    for(const auto &rule:cacheRules)
+    {
+        if(target.startsWith(QLatin1String(rule.prefix)))
+            return rule.ttl;
+    }
+    return 0;
+}
+
+Network::AsyncRequest::AsyncRequest(QNetworkAccessManager::Operation op, const QNetworkRequest &request, const QByteArray &data, ReplyCallback callback,
+                                    ChunkCallback chunkCallback):
+    op(op),request(request),data(data),callback(callback),chunkCallback(chunkCallback),deliveredSize(0),reply(nullptr),
+    retryCount(0),redirectCount(0),aborted(false),timedOut(false),finished(false)
+{
     timer.setSingleShot(true);
-    QNetworkAccessManager manager;
-    QNetworkReply *reply = manager.get(request);
-    QEventLoop eventLoop;
-	QObject::connect(&timer, &QTimer::timeout, &eventLoop, &QEventLoop::quit);
-    QObject::connect(&manager, &QNetworkAccessManager::finished, &eventLoop, &QEventLoop::quit);
-    timer.start();
-    eventLoop.exec();
-    bool hasError=false;
-    QString errorInfo;
-    QByteArray replyBytes;
-    if (timer.isActive())
+    QObject::connect(&timer,&QTimer::timeout,this,[this](){
+        if(!reply)return;
+        timedOut=true;
+        reply->abort();
+    });
+    costTimer.start();
+    if(fixtureConfig().mode!=FixtureConfig::Off)
     {
-        timer.stop();
-        if (reply->error() == QNetworkReply::NoError)
+        fixtureFile=::fixtureFile(op,request.url(),data);
+        if(fixtureConfig().mode==FixtureConfig::Replay)
         {
-            int nStatusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-            if(nStatusCode==301 || nStatusCode==302)
-            {
-                try
-                {
-                    QString location(reply->header(QNetworkRequest::LocationHeader).toString());
-                    if (location.isEmpty())
-                        location = reply->rawHeader("Location");
-                    QUrl redirectUrl(location);
-                    if (redirectUrl.isRelative())
-                    {
-                        QString host(queryUrl.host());
-                        QString scheme(queryUrl.scheme());
-                        if (!location.startsWith('/'))
-                            location.push_front('/');
-                        location = QString("%1://%2%3").arg(scheme).arg(host).arg(location);
-                    }
-                    replyBytes=httpGet(location,QUrlQuery(),header);
-                }
-                catch(NetworkError &error)
-                {
-                    hasError=true;
-                    errorInfo=error.errorInfo;
-                }
-            }
-            else if(nStatusCode==200)
+            replayFixture();
+            return;
+        }
+    }
+    cacheTTL=op==QNetworkAccessManager::GetOperation && !chunkCallback?Network::cacheTTL(request.url()):0;
+    if(cacheTTL>0)
+    {
+        cacheUrl=request.url();
+        cacheMeta=Network::cache()->metaData(cacheUrl);
+        if(cacheMeta.isValid())
+        {
+            if(cacheMeta.expirationDate()>QDateTime::currentDateTimeUtc())
             {
-                replyBytes = reply->readAll();
+                //fresh entry, answer without touching the network, but still asynchronously
+                QMetaObject::invokeMethod(this,[this](){
+                    if(!finished && !replyFromCache(false))start();
+                },Qt::QueuedConnection);
+                return;
             }
-            else
+            for(const QNetworkCacheMetaData::RawHeader &header:cacheMeta.rawHeaders())
             {
-                hasError=true;
-                errorInfo=QObject::tr("Error,Status Code:%1").arg(nStatusCode);
+                if(header.first.toLower()=="etag")
+                    this->request.setRawHeader("If-None-Match",header.second);
             }
-        }
-        else
-        {
-            hasError=true;
-            errorInfo=reply->errorString();
+            if(cacheMeta.lastModified().isValid())
+                this->request.setHeader(QNetworkRequest::IfModifiedSinceHeader,cacheMeta.lastModified());
         }
     }
-    else
+    start();
+}
+
+bool Network::AsyncRequest::replyFromCache(bool revalidated)
+{
+    QAbstractNetworkCache *diskCache=Network::cache();
+    QIODevice *device=diskCache->data(cacheUrl);
+    if(!device)return false;
+    QByteArray content(device->readAll());
+    delete device;
+    if(revalidated)
     {
-        QObject::disconnect(reply, &QNetworkReply::finished, &eventLoop, &QEventLoop::quit);
-        reply->abort();
-        hasError=true;
-        errorInfo=QObject::tr("Replay Timeout");
+        cacheMeta.setExpirationDate(QDateTime::currentDateTimeUtc().addSecs(cacheTTL));
+        diskCache->updateMetaData(cacheMeta);
     }
-    reply->deleteLater();
-    if(hasError)
+    finish(false,QString(),content,true);
+    return true;
+}
+
+void Network::AsyncRequest::saveToCache(QNetworkReply *curReply, const QByteArray &content)
+{
+    QNetworkCacheMetaData metaData;
+    metaData.setUrl(cacheUrl);
+    metaData.setRawHeaders(curReply->rawHeaderPairs());
+    metaData.setLastModified(curReply->header(QNetworkRequest::LastModifiedHeader).toDateTime());
+    metaData.setExpirationDate(QDateTime::currentDateTimeUtc().addSecs(cacheTTL));
+    metaData.setSaveToDisk(true);
+    QAbstractNetworkCache *diskCache=Network::cache();
+    QIODevice *device=diskCache->prepare(metaData);
+    if(!device)return;
+    device->write(content);
+    diskCache->insert(device);
+}
+
+void Network::AsyncRequest::replayFixture()
+{
+    const FixtureConfig &config=fixtureConfig();
+    QByteArray content;
+    bool ok=false;
+    QFile file(fixtureFile);
+    if(file.open(QIODevice::ReadOnly))
     {
-        throw NetworkError(errorInfo);
+        QDataStream ds(&file);
+        quint32 magic=0;
+        QString url;
+        ds>>magic>>url>>content;
+        ok=magic==fixtureMagic && ds.status()==QDataStream::Ok;
     }
+    int delay=config.latency+(config.bandwidth>0?content.size()/config.bandwidth:0);
+    QTimer::singleShot(delay,this,[this,ok,content](){
+        if(ok && chunkCallback)
+        {
+            chunkCallback(content);
+            finish(false,QString());
+        }
+        else if(ok)
+            finish(false,QString(),content);
+        else
+            finish(true,QObject::tr("No Fixture: %1").arg(request.url().toString()));
+    });
+}
+
+void Network::AsyncRequest::recordFixture(const QByteArray &content)
+{
+    QSaveFile file(fixtureFile);
+    if(!file.open(QIODevice::WriteOnly))return;
+    QDataStream ds(&file);
+    ds<<fixtureMagic<<request.url().toString()<<content;
+    file.commit();
+}
+
+void Network::AsyncRequest::abort()
+{
+    if(finished)return;
+    aborted=true;
+    if(reply)
+        reply->abort();
     else
+        finish(true,QObject::tr("Request Canceled"));
+}
+
+void Network::AsyncRequest::start()
+{
+    timedOut=false;
+    //one deadline for the whole request, retries and redirects included
+    qint64 remaining=timeout-costTimer.elapsed();
+    if(remaining<=0)
     {
-        return replyBytes;
+        finish(true,QObject::tr("Replay Timeout"));
+        return;
     }
+    QNetworkAccessManager *manager=Network::manager();
+    reply=op==QNetworkAccessManager::PostOperation?manager->post(request,data):manager->get(request);
+    QObject::connect(reply,&QNetworkReply::finished,this,&AsyncRequest::onReplyFinished);
+    if(chunkCallback)
+        QObject::connect(reply,&QNetworkReply::readyRead,this,[this](){deliverChunk(reply);});
+    timer.start(int(remaining));
 }
 
-QByteArray Network::httpPost(const QString &url, QByteArray &data, QStringList &header)
+void Network::AsyncRequest::deliverChunk(QNetworkReply *curReply)
 {
-    QUrl queryUrl(url);
-    QNetworkRequest request;
-    if(header.size()>=2)
+    //bodies of redirects and errors are not part of the content
+    if(aborted || curReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()!=200)return;
+    QByteArray chunk(curReply->readAll());
+    if(chunk.isEmpty())return;
+    deliveredSize+=chunk.size();
+    if(fixtureConfig().mode==FixtureConfig::Record)recordBuffer.append(chunk);
+    chunkCallback(chunk);
+}
+
+void Network::AsyncRequest::onReplyFinished()
+{
+    timer.stop();
+    QNetworkReply *curReply=reply;
+    reply=nullptr;
+    curReply->deleteLater();
+    if(aborted)
     {
-        for(int i=0;i<header.size();i+=2)
-            request.setRawHeader(header[i].toUtf8(),header[i+1].toUtf8());
+        finish(true,QObject::tr("Request Canceled"));
+        return;
     }
-    request.setUrl(queryUrl);
-
-    bool hasError=false;
+    bool retryable=false;
     QString errorInfo;
-    QByteArray replyData;
-
-    QTimer timer;
-    timer.setInterval(timeout);
-    timer.setSingleShot(true);
-    QNetworkAccessManager manager;
-    QNetworkReply *reply = manager.post(request, data);
-    QEventLoop eventLoop;
-	QObject::connect(&timer, &QTimer::timeout, &eventLoop, &QEventLoop::quit);
-    QObject::connect(&manager, &QNetworkAccessManager::finished, &eventLoop, &QEventLoop::quit);
-    timer.start();
-    eventLoop.exec();
-
-    if (timer.isActive())
+    if(timedOut)
+    {
+        retryable=true;
+        errorInfo=QObject::tr("Replay Timeout");
+    }
+    else if(curReply->error()==QNetworkReply::NoError)
     {
-        timer.stop();
-        if (reply->error() == QNetworkReply::NoError)
+        int nStatusCode = curReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if((nStatusCode==301 || nStatusCode==302) && op==QNetworkAccessManager::GetOperation)
         {
-            int nStatusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-            if(nStatusCode==200)
+            if(++redirectCount>maxRedirect)
             {
-                replyData = reply->readAll();
-            }
-            else
-            {
-                hasError=true;
-                errorInfo=QObject::tr("Error,Status Code:%1").arg(nStatusCode);
+                finish(true,QObject::tr("Too Many Redirects"));
+                return;
             }
+            QString location(curReply->header(QNetworkRequest::LocationHeader).toString());
+            if (location.isEmpty())
+                location = curReply->rawHeader("Location");
+            request.setUrl(request.url().resolved(QUrl(location)));
+            start();
+            return;
         }
-        else
+        else if(nStatusCode==200 && chunkCallback)
+        {
+            deliverChunk(curReply);
+            finish(false,QString());
+            return;
+        }
+        else if(nStatusCode==200)
+        {
+            QByteArray content(curReply->readAll());
+            if(cacheTTL>0)saveToCache(curReply,content);
+            finish(false,QString(),content);
+            return;
+        }
+        else if(nStatusCode==304 && cacheTTL>0 && replyFromCache(true))
         {
-            hasError=true;
-            errorInfo=reply->errorString();
+            return;
         }
+        retryable=nStatusCode>=500;
+        errorInfo=QObject::tr("Error,Status Code:%1").arg(nStatusCode);
     }
     else
     {
-        QObject::disconnect(reply, &QNetworkReply::finished, &eventLoop, &QEventLoop::quit);
-        reply->abort();
-        hasError=true;
-        errorInfo=QObject::tr("Replay Timeout");
+        retryable=isTransient(curReply->error());
+        errorInfo=curReply->errorString();
     }
-    reply->deleteLater();
-    if(hasError)
+    //a POST may have been applied even though the reply failed, only idempotent requests are sent again
+    bool idempotent=op==QNetworkAccessManager::GetOperation || op==QNetworkAccessManager::HeadOperation;
+    int backoff=retryInterval<<retryCount;
+    //part of the body is already with the caller, starting over would hand it over twice
+    if(deliveredSize>0)retryable=false;
+    if(retryable && idempotent && retryCount<maxRetry && costTimer.elapsed()+backoff<timeout)
     {
-        throw NetworkError(errorInfo);
+        QTimer::singleShot(backoff,this,[this](){
+            if(!aborted)start();
+        });
+        retryCount++;
+        return;
     }
-    else
+    finish(true,errorInfo);
+}
+
+void Network::AsyncRequest::finish(bool hasError, const QString &errorInfo, const QByteArray &content, bool fromCache)
+{
+    if(finished)return;
+    finished=true;
+#ifdef QT_DEBUG
+    qDebug()<<"http:"<<request.url().host()<<", retry:"<<retryCount<<", cache:"<<fromCache<<", time:"<<costTimer.elapsed()<<"ms"<<(hasError?errorInfo:QString());
+#endif
+    if(!hasError && fixtureConfig().mode==FixtureConfig::Record)
+        recordFixture(chunkCallback?recordBuffer:content);
+    Reply result;
+    result.hasError=hasError;
+    result.fromCache=fromCache;
+    result.errorInfo=errorInfo;
+    result.content=content;
+    if(callback)callback(result);
+    deleteLater();
+}
+
+bool Network::AsyncRequest::isTransient(QNetworkReply::NetworkError error)
+{
+    switch (error)
     {
-        return replyData;
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::InternalServerError:
+    case QNetworkReply::ServiceUnavailableError:
+    case QNetworkReply::UnknownServerError:
+        return true;
+    default:
+        return false;
     }
 }
 
+Network::AsyncRequest *Network::httpGetAsync(const QString &url, const QUrlQuery &query, const QStringList &header, ReplyCallback callback)
+{
+    QUrl queryUrl(url);
+    if(!query.isEmpty())
+        queryUrl.setQuery(query);
+    return new AsyncRequest(QNetworkAccessManager::GetOperation,buildRequest(queryUrl,header),QByteArray(),callback);
+}
+
+Network::AsyncRequest *Network::httpPostAsync(const QString &url, const QByteArray &data, const QStringList &header, ReplyCallback callback)
+{
+    return new AsyncRequest(QNetworkAccessManager::PostOperation,buildRequest(QUrl(url),header),data,callback);
+}
+
+Network::AsyncRequest *Network::httpGetStream(const QString &url, const QUrlQuery &query, const QStringList &header, ChunkCallback chunkCallback, ReplyCallback callback)
+{
+    QUrl queryUrl(url);
+    if(!query.isEmpty())
+        queryUrl.setQuery(query);
+    return new AsyncRequest(QNetworkAccessManager::GetOperation,buildRequest(queryUrl,header),QByteArray(),callback,chunkCallback);
+}
+
+QByteArray Network::httpGet(const QString &url, const QUrlQuery &query, const QStringList &header, bool *fromCache)
+{
+    Reply result;
+    bool done=false;
+    QEventLoop eventLoop;
+    httpGetAsync(url,query,header,[&](const Reply &reply){
+        result=reply;
+        done=true;
+        eventLoop.quit();
+    });
+    if(!done)eventLoop.exec();
+    if(result.hasError)
+        throw NetworkError(result.errorInfo);
+    if(fromCache)*fromCache=result.fromCache;
+    return result.content;
+}
+
+QByteArray Network::httpPost(const QString &url, const QByteArray &data, const QStringList &header, bool *fromCache)
+{
+    Reply result;
+    bool done=false;
+    QEventLoop eventLoop;
+    httpPostAsync(url,data,header,[&](const Reply &reply){
+        result=reply;
+        done=true;
+        eventLoop.quit();
+    });
+    if(!done)eventLoop.exec();
+    if(result.hasError)
+        throw NetworkError(result.errorInfo);
+    if(fromCache)*fromCache=result.fromCache;
+    return result.content;
+}
+
 QJsonDocument Network::toJson(const QString &str)
 {
     QJsonParseError jsonError;
@@ -3,12 +3,97 @@
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
 #include <QtCore>
+#include <functional>
 namespace Network
 {
-    const int timeout=10000;
-    QByteArray httpGet(const QString &url,QUrlQuery &query,QStringList &header=QStringList());
-    QByteArray httpPost(const QString &url,QByteArray &data,QStringList &header=QStringList());
+    const int timeout=10000; //for the whole request, retries and redirects included
+    const int maxRetry=2;
+    const int retryInterval=500;
+    const int maxRedirect=5;
+    const qint64 maxCacheSize=64*1024*1024;
+    struct Reply
+    {
+        bool hasError;
+        bool fromCache;
+        QString errorInfo;
+        QByteArray content;
+    };
+    //requests finished on the current thread, and how many of them were served from the disk cache
+    typedef std::function<void(const Reply &)> ReplyCallback;
+    typedef std::function<void(const QByteArray &)> ChunkCallback;
+    //Replies can be recorded to and replayed from fixture files to run providers offline.
+    //Controlled by environment variables:
+    //  KIKOPLAY_FIXTURE=record|replay
+    //  KIKOPLAY_FIXTURE_DIR, default: <app dir>/fixtures
+    //  KIKOPLAY_FIXTURE_LATENCY(ms) and KIKOPLAY_FIXTURE_BANDWIDTH(KB/s) shape replayed replies
+    //One request in flight, deletes itself after the callback returns.
+    //Keep it in a QPointer if abort() may be called later.
+    class AsyncRequest : public QObject
+    {
+    public:
+        //with chunkCallback the body is handed over as it arrives and the Reply carries no content
+        AsyncRequest(QNetworkAccessManager::Operation op,const QNetworkRequest &request,const QByteArray &data,ReplyCallback callback,
+                     ChunkCallback chunkCallback=ChunkCallback());
+        void abort();
+    private:
+        QNetworkAccessManager::Operation op;
+        QNetworkRequest request;
+        QByteArray data;
+        ReplyCallback callback;
+        ChunkCallback chunkCallback;
+        qint64 deliveredSize;
+        QByteArray recordBuffer;
+        QNetworkReply *reply;
+        QTimer timer;
+        int retryCount,redirectCount;
+        bool aborted,timedOut,finished;
+        QElapsedTimer costTimer;
+        int cacheTTL;
+        QUrl cacheUrl;
+        QNetworkCacheMetaData cacheMeta;
+        QString fixtureFile;
+        void start();
+        void replayFixture();
+        void recordFixture(const QByteArray &content);
+        bool replyFromCache(bool revalidated);
+        void saveToCache(QNetworkReply *curReply,const QByteArray &content);
+        void deliverChunk(QNetworkReply *curReply);
+        void onReplyFinished();
+        void finish(bool hasError,const QString &errorInfo,const QByteArray &content=QByteArray(),bool fromCache=false);
+        static bool isTransient(QNetworkReply::NetworkError error);
+    };
+    //One manager per thread, so connections, TLS sessions and DNS lookups are reused
+    QNetworkAccessManager *manager();
+    //One QNetworkDiskCache for all threads, every call goes through a mutex as the cache itself is not thread-safe
+    class SharedDiskCache : public QAbstractNetworkCache
+    {
+    public:
+        SharedDiskCache(const QString &cacheDir,qint64 maxSize);
+        virtual QNetworkCacheMetaData metaData(const QUrl &url) override;
+        virtual void updateMetaData(const QNetworkCacheMetaData &metaData) override;
+        virtual QIODevice *data(const QUrl &url) override;
+        virtual bool remove(const QUrl &url) override;
+        virtual qint64 cacheSize() const override;
+        virtual QIODevice *prepare(const QNetworkCacheMetaData &metaData) override;
+        virtual void insert(QIODevice *device) override;
+        virtual void clear() override;
+    private:
+        mutable QMutex lock;
+        QNetworkDiskCache diskCache;
+    };
+    //GET replies of search and metadata endpoints are kept on disk for a per-endpoint TTL,
+    //stale entries are revalidated with ETag/Last-Modified
+    QAbstractNetworkCache *cache();
+    int cacheTTL(const QUrl &url);
+    AsyncRequest *httpGetAsync(const QString &url,const QUrlQuery &query,const QStringList &header,ReplyCallback callback);
+    AsyncRequest *httpPostAsync(const QString &url,const QByteArray &data,const QStringList &header,ReplyCallback callback);
+    //the body goes to chunkCallback as it arrives, not cached, not retried once part of it was handed over
+    AsyncRequest *httpGetStream(const QString &url,const QUrlQuery &query,const QStringList &header,ChunkCallback chunkCallback,ReplyCallback callback);
+    //fromCache: set to whether the reply came from the disk cache
+    QByteArray httpGet(const QString &url,const QUrlQuery &query,const QStringList &header=QStringList(),bool *fromCache=nullptr);
+    QByteArray httpPost(const QString &url,const QByteArray &data,const QStringList &header=QStringList(),bool *fromCache=nullptr);
     QJsonDocument toJson(const QString &str);
     QJsonValue getValue(QJsonObject &obj, const QString &path);
     class NetworkError
@@ -0,0 +1,83 @@
+#include "zlibstream.h"
+
+InflateStream::InflateStream():finished(false),error(false)
+{
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.avail_in = 0;
+    stream.next_in = Z_NULL;
+    //15+32: detect zlib or gzip header automatically
+    error = inflateInit2(&stream,15+32)!=Z_OK;
+}
+
+InflateStream::~InflateStream()
+{
+    if(!error || finished)
+        (void)inflateEnd(&stream);
+}
+
+bool InflateStream::feed(const char *data, int size, const Sink &sink)
+{
+    if(error)return false;
+    if(finished || size<=0)return true;
+    stream.next_in = (Bytef *)data;
+    stream.avail_in = size;
+    do
+    {
+        stream.avail_out = chunkSize;
+        stream.next_out = (Bytef *)outBuf;
+        int ret = inflate(&stream, Z_NO_FLUSH);
+        switch (ret)
+        {
+        case Z_NEED_DICT:
+        case Z_DATA_ERROR:
+        case Z_MEM_ERROR:
+            error=true;
+            (void)inflateEnd(&stream);
+            return false;
+        case Z_STREAM_END:
+            finished=true;
+            break;
+        }
+        int have = chunkSize - stream.avail_out;
+        if(have>0)sink(outBuf,have);
+    } while (!finished && stream.avail_out == 0);
+    return true;
+}
+
+bool InflateXmlReader::feed(const char *data, int size)
+{
+    if(error)return false;
+    const int inputChunk=16384;
+    //tokens are handled after each chunk, so at most one inflated chunk waits in the reader
+    for(int pos=0;pos<size && !inflater.isFinished();pos+=inputChunk)
+    {
+        bool ret=inflater.feed(data+pos,qMin(inputChunk,size-pos),[this](const char *data,int size){
+            reader.addData(QByteArray(data,size));
+        });
+        if(!ret)
+        {
+            error=true;
+            return false;
+        }
+        while(!reader.atEnd())
+        {
+            reader.readNext();
+            if(reader.error()==QXmlStreamReader::PrematureEndOfDocumentError)break;
+            if(reader.hasError())
+            {
+                error=true;
+                return false;
+            }
+            handler(reader);
+        }
+    }
+    return true;
+}
+
+bool InflateXmlReader::read(const QByteArray &compressed, const TokenHandler &handler)
+{
+    InflateXmlReader reader(handler);
+    return reader.feed(compressed);
+}
@@ -0,0 +1,43 @@
+#ifndef ZLIBSTREAM_H
+#define ZLIBSTREAM_H
+#include <QtCore>
+#include <functional>
+#include "zlib.h"
+//Incremental inflate for zlib or gzip data.
+//Output goes to the sink chunk by chunk, so the whole inflated data is never held at once.
+class InflateStream
+{
+public:
+    typedef std::function<void(const char *,int)> Sink;
+    InflateStream();
+    ~InflateStream();
+    bool feed(const char *data,int size,const Sink &sink);
+    inline bool feed(const QByteArray &data,const Sink &sink){return feed(data.constData(),data.size(),sink);}
+    inline bool isFinished() const {return finished;}
+    inline bool hasError() const {return error;}
+private:
+    static const int chunkSize=16384;
+    z_stream stream;
+    bool finished,error;
+    char outBuf[chunkSize];
+};
+//Inflate data and feed it into a QXmlStreamReader as it arrives.
+//handler is called for every token that is complete, it may not use readElementText
+class InflateXmlReader
+{
+public:
+    typedef std::function<void(QXmlStreamReader &)> TokenHandler;
+    explicit InflateXmlReader(const TokenHandler &handler):handler(handler),error(false){}
+    //the next piece of compressed data, any size, false once the data is found broken
+    bool feed(const char *data,int size);
+    inline bool feed(const QByteArray &data){return feed(data.constData(),data.size());}
+    inline bool isFinished() const {return inflater.isFinished();}
+    static bool read(const QByteArray &compressed,const TokenHandler &handler);
+private:
+    TokenHandler handler;
+    QXmlStreamReader reader;
+    InflateStream inflater;
+    bool error;
+};
+
+#endif // ZLIBSTREAM_H
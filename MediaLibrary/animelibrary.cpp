@@ -679,19 +679,15 @@ QString AnimeWorker::downloadLabelInfo(Anime *anime, QMap<QString, QSet<QString>
             QRegExp yearRe("(19|20)\\d{2}");
             QStringList trivialTags={"TV","OVA","WEB"};
             QStringList tagList;
-            while(!parser.atEnd())
+            while(parser.seekTo("a"))
             {
-                if(parser.currentNode()=="a" && parser.isStartNode())
-                {
-                    parser.readNext();
-                    QString tagName(parser.readContentText());
-                    if(yearRe.indexIn(tagName)==-1 && !trivialTags.contains(tagName)
-                            && !anime->title.contains(tagName))
-                        tagList.append(tagName);
-                    if(tagList.count()>9)
-                        break;
-                }
                 parser.readNext();
+                QString tagName(parser.readContentText());
+                if(yearRe.indexIn(tagName)==-1 && !trivialTags.contains(tagName)
+                        && !anime->title.contains(tagName))
+                    tagList.append(tagName);
+                if(tagList.count()>9)
+                    break;
             }
 
             QSqlDatabase db=QSqlDatabase::database("WT");
@@ -57,12 +57,37 @@ void BottomLayout::addDanmu(QSharedPointer<DanmuComment> danmu, DanmuDrawInfo *d
                 bottomdanmu.insert(msPos,dmobj);
                 break;
             }
+#ifdef DANMU_STATIS
+            lostCount++;
+#endif
 #ifdef QT_DEBUG
             qDebug()<<"bottom lost: "<<danmu->text<<",send time:"<<danmu->date;
 #endif
             delete dmobj;
+            return;
         }while(false);
     }
+    grid.insert(dmobj);
+}
+
+void BottomLayout::addPlannedDanmu(QSharedPointer<DanmuComment> danmu, DanmuDrawInfo *drawInfo, float y, float elapsed)
+{
+    if(elapsed>=life_time)
+    {
+        render->refDesc(drawInfo);
+        return;
+    }
+    DanmuObject *dmobj=new DanmuObject;
+    dmobj->src=danmu;
+    dmobj->drawInfo=drawInfo;
+    dmobj->extraData=life_time-elapsed;
+    dmobj->x=(render->surfaceRect.width()-drawInfo->width)/2;
+    dmobj->y=y;
+    auto iter=bottomdanmu.begin();
+    while(iter!=bottomdanmu.end() && (*iter)->y>y)
+        ++iter;
+    bottomdanmu.insert(iter,dmobj);
+    grid.insert(dmobj);
 }
 
 void BottomLayout::moveLayout(float step)
@@ -83,6 +108,7 @@ void BottomLayout::moveLayout(float step)
             iter=bottomdanmu.erase(iter);
         }
     }
+    updateGrid();
 }
 
 void BottomLayout::drawLayout()
@@ -94,22 +120,11 @@ void BottomLayout::drawLayout()
     }
 }
 
-QSharedPointer<DanmuComment> BottomLayout::danmuAt(QPointF point)
-{
-    for(auto iter=bottomdanmu.cbegin();iter!=bottomdanmu.cend();++iter)
-    {
-        DanmuObject *curDMObj=*iter;
-        if(curDMObj->x<point.x() && curDMObj->x+curDMObj->drawInfo->width>point.x() &&
-                curDMObj->y<point.y() && curDMObj->y+curDMObj->drawInfo->height>point.y())
-            return curDMObj->src;
-    }
-    return nullptr;
-}
-
 void BottomLayout::cleanup()
 {
     qDeleteAll(bottomdanmu);
     bottomdanmu.clear();
+    updateGrid();
 }
 
 BottomLayout::~BottomLayout()
@@ -131,6 +146,12 @@ void BottomLayout::removeBlocked()
             iter++;
         }
     }
+    updateGrid();
 }
 
-
+void BottomLayout::updateGrid()
+{
+    grid.reset(render->surfaceRect);
+    for(auto current:bottomdanmu)
+        grid.insert(current);
+}
@@ -8,16 +8,17 @@ public:
     BottomLayout(DanmuRender *render);
 
     virtual void addDanmu(QSharedPointer<DanmuComment> danmu,DanmuDrawInfo *drawInfo) override;
+    virtual void addPlannedDanmu(QSharedPointer<DanmuComment> danmu,DanmuDrawInfo *drawInfo,float y,float elapsed) override;
     virtual void moveLayout(float step) override;
     virtual void drawLayout() override;
-    virtual QSharedPointer<DanmuComment> danmuAt(QPointF point) override;
     inline virtual int danmuCount(){return bottomdanmu.count();}
     virtual void cleanup() override;
     virtual ~BottomLayout();
     virtual void removeBlocked();
 private:
     float life_time;
-    QLinkedList<DanmuObject *> bottomdanmu;    
+    QLinkedList<DanmuObject *> bottomdanmu;
+    void updateGrid();    
 };
 
 #endif // BOTTOMLAYOUT_H
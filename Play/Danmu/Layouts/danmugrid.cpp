@@ -0,0 +1,83 @@
+#include "danmugrid.h"
+#include "Play/Danmu/common.h"
+namespace
+{
+    const float cellWidth=128;
+    const float cellHeight=32;
+}
+DanmuGrid::DanmuGrid():cols(0),rows(0)
+{
+
+}
+
+void DanmuGrid::reset(const QRectF &bound)
+{
+    int newCols=qMax(1,qCeil(bound.width()/cellWidth)),
+        newRows=qMax(1,qCeil(bound.height()/cellHeight));
+    this->bound=bound;
+    if(newCols!=cols || newRows!=rows)
+    {
+        cols=newCols;
+        rows=newRows;
+        cells.clear();
+        cells.resize(cols*rows);
+        return;
+    }
+    for(auto &cell:cells)
+        cell.resize(0);
+}
+
+void DanmuGrid::insert(DanmuObject *obj)
+{
+    if(cells.isEmpty())return;
+    int c1=cellCol(obj->x),c2=cellCol(obj->x+obj->drawInfo->width),
+        r1=cellRow(obj->y),r2=cellRow(obj->y+obj->drawInfo->height);
+    for(int r=r1;r<=r2;++r)
+        for(int c=c1;c<=c2;++c)
+            cells[r*cols+c].append(obj);
+}
+
+QSharedPointer<DanmuComment> DanmuGrid::danmuAt(const QPointF &point) const
+{
+    if(cells.isEmpty() || !bound.contains(point))return nullptr;
+    for(DanmuObject *curDMObj:cells[cellRow(point.y())*cols+cellCol(point.x())])
+    {
+        if(curDMObj->x<point.x() && curDMObj->x+curDMObj->drawInfo->width>point.x() &&
+                curDMObj->y<point.y() && curDMObj->y+curDMObj->drawInfo->height>point.y())
+            return curDMObj->src;
+    }
+    return nullptr;
+}
+
+void DanmuGrid::danmuIn(const QRectF &rect, QList<QSharedPointer<DanmuComment> > &danmuList) const
+{
+    QRectF queryRect(rect.normalized().intersected(bound));
+    if(cells.isEmpty() || queryRect.isEmpty())return;
+    QSet<DanmuObject *> visited;
+    int c1=cellCol(queryRect.left()),c2=cellCol(queryRect.right()),
+        r1=cellRow(queryRect.top()),r2=cellRow(queryRect.bottom());
+    for(int r=r1;r<=r2;++r)
+    {
+        for(int c=c1;c<=c2;++c)
+        {
+            for(DanmuObject *curDMObj:cells[r*cols+c])
+            {
+                if(visited.contains(curDMObj))continue;
+                visited.insert(curDMObj);
+                QRectF dmRect(curDMObj->x,curDMObj->y,curDMObj->drawInfo->width,curDMObj->drawInfo->height);
+                if(dmRect.intersects(queryRect))
+                    danmuList.append(curDMObj->src);
+            }
+        }
+    }
+}
+
+int DanmuGrid::cellCol(float x) const
+{
+    return qBound(0,int((x-bound.left())/cellWidth),cols-1);
+}
+
+int DanmuGrid::cellRow(float y) const
+{
+    return qBound(0,int((y-bound.top())/cellHeight),rows-1);
+}
@@ -0,0 +1,23 @@
+#ifndef DANMUGRID_H
+#define DANMUGRID_H
+#include <QtCore>
+class DanmuObject;
+class DanmuComment;
+class DanmuGrid
+{
+public:
+    DanmuGrid();
+    void reset(const QRectF &bound);
+    void insert(DanmuObject *obj);
+    QSharedPointer<DanmuComment> danmuAt(const QPointF &point) const;
+    void danmuIn(const QRectF &rect, QList<QSharedPointer<DanmuComment> > &danmuList) const;
+private:
+    QRectF bound;
+    int cols,rows;
+    QVector<QVector<DanmuObject *> > cells;
+
+    inline int cellCol(float x) const;
+    inline int cellRow(float y) const;
+};
+
+#endif // DANMUGRID_H
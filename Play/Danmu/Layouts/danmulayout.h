@@ -2,6 +2,7 @@
 #define DANMULAYOUT_H
 #include <QtCore>
 #include <QtGui>
+#include "danmugrid.h"
 class DanmuRender;
 class DanmuComment;
 class DanmuDrawInfo;
@@ -10,16 +11,27 @@ class DanmuLayout
 protected:
     DanmuRender *render;
     const float margin_y=0;
+    DanmuGrid grid;
+#ifdef DANMU_STATIS
+    int lostCount=0;
+#endif
 public:
     DanmuLayout(DanmuRender *render)
     {
         this->render=render;
     }
+#ifdef DANMU_STATIS
+    inline int danmuLostCount() const {return lostCount;}
+    inline void resetLostCount(){lostCount=0;}
+#endif
     virtual void addDanmu(QSharedPointer<DanmuComment> danmu,DanmuDrawInfo *drawInfo)=0;
+    //place at y given by the layout plan, elapsed(ms) since the comment should have appeared
+    virtual void addPlannedDanmu(QSharedPointer<DanmuComment> danmu,DanmuDrawInfo *drawInfo,float y,float elapsed)=0;
     virtual void moveLayout(float step)=0;
     virtual void drawLayout()=0;
     virtual ~DanmuLayout(){}
-    virtual QSharedPointer<DanmuComment> danmuAt(QPointF point)=0;
+    inline QSharedPointer<DanmuComment> danmuAt(QPointF point) const {return grid.danmuAt(point);}
+    inline void danmuIn(const QRectF &rect, QList<QSharedPointer<DanmuComment> > &danmuList) const {grid.danmuIn(rect,danmuList);}
     virtual void cleanup()=0;
     virtual int danmuCount()=0;
     virtual void removeBlocked()=0;
@@ -85,18 +85,41 @@ void RollLayout::addDanmu(QSharedPointer<DanmuComment> danmu, DanmuDrawInfo *dra
                 }
                 break;
             }
+#ifdef DANMU_STATIS
+            lostCount++;
+#endif
 #ifdef QT_DEBUG
             qDebug()<<"roll lost: "<<danmu->text<<",send time:"<<danmu->date;
 #endif
             delete dmobj;
+            return;
         }while (false);
     }
+    grid.insert(dmobj);
+}
+
+void RollLayout::addPlannedDanmu(QSharedPointer<DanmuComment> danmu, DanmuDrawInfo *drawInfo, float y, float elapsed)
+{
+    DanmuObject *dmobj=new DanmuObject();
+    dmobj->src=danmu;
+    dmobj->drawInfo=drawInfo;
+    dmobj->extraData=(drawInfo->width/5+base_speed)/1000;
+    dmobj->x=render->surfaceRect.width()-dmobj->extraData*elapsed;
+    dmobj->y=y;
+    if(dmobj->x+drawInfo->width<=0)
+    {
+        delete dmobj;
+        return;
+    }
+    rolldanmu.append(dmobj);
+    grid.insert(dmobj);
 }
 
 void RollLayout::moveLayout(float step)
 {
     moveLayoutList(rolldanmu,step);
     moveLayoutList(lastcol,step);
+    updateGrid();
 }
 
 void RollLayout::drawLayout()
@@ -119,21 +142,13 @@ RollLayout::~RollLayout()
     qDeleteAll(lastcol);
 }
 
-QSharedPointer<DanmuComment> RollLayout::danmuAt(QPointF point)
-{
-    auto ret=danmuAtList(point,rolldanmu);
-    if(!ret.isNull())
-        return ret;
-    ret=danmuAtList(point,lastcol);
-    return ret;
-}
-
 void RollLayout::cleanup()
 {
     qDeleteAll(lastcol);
     qDeleteAll(rolldanmu);
     lastcol.clear();
     rolldanmu.clear();
+    updateGrid();
 }
 
 void RollLayout::setSpeed(float speed)
@@ -175,6 +190,7 @@ void RollLayout::removeBlocked()
             ++iter;
         }
     }
+    updateGrid();
 }
 
 void RollLayout::moveLayoutList(QLinkedList<DanmuObject *> &list, float step)
@@ -196,16 +212,13 @@ void RollLayout::moveLayoutList(QLinkedList<DanmuObject *> &list, float step)
     }
 }
 
-QSharedPointer<DanmuComment> RollLayout::danmuAtList(QPointF point, QLinkedList<DanmuObject *> &list)
+void RollLayout::updateGrid()
 {
-    for(auto iter=list.cbegin();iter!=list.cend();++iter)
-    {
-        DanmuObject *curDMObj=*iter;
-        if(curDMObj->x<point.x() && curDMObj->x+curDMObj->drawInfo->width>point.x() &&
-                curDMObj->y<point.y() && curDMObj->y+curDMObj->drawInfo->height>point.y())
-            return curDMObj->src;
-    }
-    return nullptr;
+    grid.reset(render->surfaceRect);
+    for(auto current:rolldanmu)
+        grid.insert(current);
+    for(auto current:lastcol)
+        grid.insert(current);
 }
 
 bool RollLayout::isCollided(const DanmuObject *d1, const DanmuObject *d2, float *collidedSpace)
@@ -7,9 +7,9 @@ public:
     RollLayout(DanmuRender *render);
 
     virtual void addDanmu(QSharedPointer<DanmuComment> danmu,DanmuDrawInfo *drawInfo) override;
+    virtual void addPlannedDanmu(QSharedPointer<DanmuComment> danmu,DanmuDrawInfo *drawInfo,float y,float elapsed) override;
     virtual void moveLayout(float step) override;
     virtual void drawLayout() override;
-    virtual QSharedPointer<DanmuComment> danmuAt(QPointF point) override;
     inline virtual int danmuCount(){return rolldanmu.count()+lastcol.count();}
     virtual void cleanup() override;
     virtual ~RollLayout();
@@ -21,7 +21,7 @@ private:
     float base_speed;
 
     inline void moveLayoutList(QLinkedList<DanmuObject *> &list, float step);
-    QSharedPointer<DanmuComment> danmuAtList(QPointF point,QLinkedList<DanmuObject *> &list);
+    void updateGrid();
     inline bool isCollided(const DanmuObject *d1, const DanmuObject *d2, float *collidedSpace);
 };
 
@@ -57,12 +57,37 @@ void TopLayout::addDanmu(QSharedPointer<DanmuComment> danmu, DanmuDrawInfo *draw
                 topdanmu.insert(msPos,dmobj);
                 break;
             }
+#ifdef DANMU_STATIS
+            lostCount++;
+#endif
 #ifdef QT_DEBUG
             qDebug()<<"top lost: "<<danmu->text<<",send time:"<<danmu->date;
 #endif
             delete dmobj;
+            return;
         }while(false);
     }
+    grid.insert(dmobj);
+}
+
+void TopLayout::addPlannedDanmu(QSharedPointer<DanmuComment> danmu, DanmuDrawInfo *drawInfo, float y, float elapsed)
+{
+    if(elapsed>=life_time)
+    {
+        render->refDesc(drawInfo);
+        return;
+    }
+    DanmuObject *dmobj=new DanmuObject;
+    dmobj->src=danmu;
+    dmobj->drawInfo=drawInfo;
+    dmobj->extraData=life_time-elapsed;
+    dmobj->x=(render->surfaceRect.width()-drawInfo->width)/2;
+    dmobj->y=y;
+    auto iter=topdanmu.begin();
+    while(iter!=topdanmu.end() && (*iter)->y<y)
+        ++iter;
+    topdanmu.insert(iter,dmobj);
+    grid.insert(dmobj);
 }
 
 void TopLayout::moveLayout(float step)
@@ -83,6 +108,7 @@ void TopLayout::moveLayout(float step)
             iter=topdanmu.erase(iter);
         }
     }
+    updateGrid();
 }
 
 void TopLayout::drawLayout()
@@ -94,22 +120,11 @@ void TopLayout::drawLayout()
     }
 }
 
-QSharedPointer<DanmuComment> TopLayout::danmuAt(QPointF point)
-{
-    for(auto iter=topdanmu.cbegin();iter!=topdanmu.cend();++iter)
-    {
-        DanmuObject *curDMObj=*iter;
-        if(curDMObj->x<point.x() && curDMObj->x+curDMObj->drawInfo->width>point.x() &&
-                curDMObj->y<point.y() && curDMObj->y+curDMObj->drawInfo->height>point.y())
-            return curDMObj->src;
-    }
-    return nullptr;
-}
-
 void TopLayout::cleanup()
 {
     qDeleteAll(topdanmu);
     topdanmu.clear();
+    updateGrid();
 }
 
 void TopLayout::removeBlocked()
@@ -126,6 +141,7 @@ void TopLayout::removeBlocked()
             ++iter;
         }
     }
+    updateGrid();
 }
 
 TopLayout::~TopLayout()
@@ -133,3 +149,9 @@ TopLayout::~TopLayout()
     qDeleteAll(topdanmu);
 }
 
+void TopLayout::updateGrid()
+{
+    grid.reset(render->surfaceRect);
+    for(auto current:topdanmu)
+        grid.insert(current);
+}
@@ -8,9 +8,9 @@ public:
     TopLayout(DanmuRender *render);
 
     virtual void addDanmu(QSharedPointer<DanmuComment> danmu,DanmuDrawInfo *drawInfo) override;
+    virtual void addPlannedDanmu(QSharedPointer<DanmuComment> danmu,DanmuDrawInfo *drawInfo,float y,float elapsed) override;
     virtual void moveLayout(float step) override;
     virtual void drawLayout() override;
-    virtual QSharedPointer<DanmuComment> danmuAt(QPointF point) override;
     inline virtual int danmuCount(){return topdanmu.count();}
     virtual void cleanup() override;
     virtual void removeBlocked();
@@ -18,6 +18,7 @@ public:
 private:
     float life_time;
     QLinkedList<DanmuObject *> topdanmu;
+    void updateGrid();
 };
 
 #endif // TOPLAYOUT_H
@@ -24,9 +24,10 @@ DanmuAccessResult *AcfunProvider::search(const QString &keyword)
     query.addQueryItem("sortField", "score");
     DanmuAccessResult *searchResult=new DanmuAccessResult;
     searchResult->providerId=id();
+    searchResult->fromCache=false;
     try
     {
-        QString str(Network::httpGet(baseUrl,query));
+        QString str(Network::httpGet(baseUrl,query,QStringList(),&searchResult->fromCache));
         QJsonDocument document(Network::toJson(str));
         handleSearchReply(document,searchResult);
     }
@@ -118,7 +119,7 @@ QString AcfunProvider::downloadDanmu(DanmuSourceItem *item, QList<DanmuComment *
     {
         QStringList captured=re.capturedTexts();
         item->id=captured[1].toInt();
-        downloadAllDanmu(danmuList,item->id);
+        errInfo=downloadAllDanmu(danmuList,item->id);
     }
     emit downloadDone(errInfo);
     return errInfo;
@@ -127,8 +128,13 @@ QString AcfunProvider::downloadDanmu(DanmuSourceItem *item, QList<DanmuComment *
 QString AcfunProvider::downloadBySourceURL(const QString &url, QList<DanmuComment *> &danmuList)
 {
     QString videoId=url.mid(url.lastIndexOf(':')+1);
-    downloadAllDanmu(danmuList,videoId.toInt());
-    return QString();
+    return downloadAllDanmu(danmuList,videoId.toInt());
+}
+
+QString AcfunProvider::updateBySourceURL(const QString &url, qint64 sinceDate, QList<DanmuComment *> &danmuList)
+{
+    QString videoId=url.mid(url.lastIndexOf(':')+1);
+    return downloadAllDanmu(danmuList,videoId.toInt(),sinceDate);
 }
 
 void AcfunProvider::handleSearchReply(QJsonDocument &document, DanmuAccessResult *searchResult)
@@ -297,11 +303,13 @@ void AcfunProvider::handleAi(DanmuSourceItem *item, DanmuAccessResult *result)
     result->error=false;
 }
 
-void AcfunProvider::downloadAllDanmu(QList<DanmuComment *> &danmuList, int videoId)
+QString AcfunProvider::downloadAllDanmu(QList<DanmuComment *> &danmuList, int videoId, qint64 sinceDate)
 {
+    int startCount=danmuList.count();
     try
     {
         int downloadCount=0;
+        bool reachSince=false;
         QString timeStamp("4073558400000");
         do
         {
@@ -336,16 +344,27 @@ void AcfunProvider::downloadAllDanmu(QList<DanmuComment *> &danmuList, int video
                     danmu->fontSizeLevel=DanmuComment::Normal;
                 danmu->sender="[Acfun]"+cs[4];
                 danmu->date=cs[5].toLongLong();
+                if(danmu->date<sinceDate)
+                {
+                    //pages come newest first, the rest is already in the pool
+                    reachSince=true;
+                    delete danmu;
+                    break;
+                }
                 if(danmu->type!=DanmuComment::UNKNOW)danmuList.append(danmu);
                 else delete danmu;
             }
             if(danmuList.count()>0)
                 timeStamp=QString::number(danmuList.last()->date);
 
-        }while(downloadCount>=1000);
+        }while(downloadCount>=1000 && !reachSince);
     }
-    catch(Network::NetworkError &)
+    catch(Network::NetworkError &error)
     {
-        return;
+        //pages are newest first, keeping some of them would leave a gap before sinceDate
+        while(danmuList.count()>startCount)
+            delete danmuList.takeLast();
+        return error.errorInfo;
     }
+    return QString();
 }
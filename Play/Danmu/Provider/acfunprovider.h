@@ -21,11 +21,12 @@ public slots:
     virtual DanmuAccessResult *getURLInfo(const QString &url);
     virtual QString downloadDanmu(DanmuSourceItem *item, QList<DanmuComment *> &danmuList);
     virtual QString downloadBySourceURL(const QString &url, QList<DanmuComment *> &danmuList);
+    virtual QString updateBySourceURL(const QString &url, qint64 sinceDate, QList<DanmuComment *> &danmuList);
 private:
     void handleSearchReply(QJsonDocument &document, DanmuAccessResult *searchResult);
     void handleSp(DanmuSourceItem *item,DanmuAccessResult *result,int pageNo=1);
     void handleAi(DanmuSourceItem *item,DanmuAccessResult *result);
-    void downloadAllDanmu(QList<DanmuComment *> &danmuList,int videoId);
+    QString downloadAllDanmu(QList<DanmuComment *> &danmuList,int videoId,qint64 sinceDate=0);
 };
 
 #endif // ACFUNPROVIDER_H
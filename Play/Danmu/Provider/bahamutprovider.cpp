@@ -25,9 +25,10 @@ DanmuAccessResult *BahamutProvider::search(const QString &keyword)
 
     DanmuAccessResult *searchResult=new DanmuAccessResult;
     searchResult->providerId=id();
+    searchResult->fromCache=false;
     try
     {
-        QString str(Network::httpGet(baseUrl,query));
+        QString str(Network::httpGet(baseUrl,query,QStringList(),&searchResult->fromCache));
         handleSearchReply(str,searchResult);
     }
     catch(Network::NetworkError &error)
@@ -125,7 +126,7 @@ void BahamutProvider::handleSearchReply(const QString &reply, DanmuAccessResult
         item.extra=1;//search url need redirect
         while(!parser.atEnd())
         {
-            if(parser.currentNodeProperty("class")=="info")
+            if(parser.currentNodePropertyRef("class")=="info")
             {
                 parser.readNext();
                 item.title=parser.readContentText();
@@ -160,20 +161,16 @@ void BahamutProvider::handleEpReply(QString &reply, DanmuAccessResult *result)
         HTMLParserSax parser(list.at(2));
         DanmuSourceItem item;
         item.extra=0;
-        while(!parser.atEnd())
+        QRegExp snRe("\\?sn=([0-9]+)");
+        while(parser.seekTo("a"))
         {
-            if(parser.currentNode()=="a" && parser.isStartNode())
+            if(snRe.indexIn(parser.currentNodeProperty("href"))!=-1)
             {
-                QRegExp re("\\?sn=([0-9]+)");
-                if(re.indexIn(parser.currentNodeProperty("href"))!=-1)
-                {
-                    QString idStr = re.capturedTexts()[1];
-                    item.id=idStr.toInt();
-                }
-                item.title=parser.readContentText();
-                result->list.append(item);
+                QString idStr = snRe.capturedTexts()[1];
+                item.id=idStr.toInt();
             }
-            parser.readNext();
+            item.title=parser.readContentText();
+            result->list.append(item);
         }
     }
     else
@@ -1,5 +1,6 @@
 #include "bilibiliprovider.h"
 #include "Common/network.h"
+#include "localprovider.h"
 namespace
 {
     const char *supportedUrlRe[]={"(https?://)?www\\.bilibili\\.com/video/av[0-9]+/?",
@@ -19,9 +20,10 @@ DanmuAccessResult *BilibiliProvider::search(const QString &keyword)
     query.addQueryItem("keyword", keyword);
     DanmuAccessResult *searchResult=new DanmuAccessResult;
     searchResult->providerId=id();
+    searchResult->fromCache=false;
     try
     {
-        QString str(Network::httpGet(baseUrl,query,QStringList()<<"Accept"<<"application/json"));
+        QString str(Network::httpGet(baseUrl,query,QStringList()<<"Accept"<<"application/json",&searchResult->fromCache));
         QJsonDocument document(Network::toJson(str));
         handleSearchReply(document,searchResult);
     }
@@ -101,8 +103,8 @@ QString BilibiliProvider::downloadDanmu(DanmuSourceItem *item, QList<DanmuCommen
     QString errInfo;
     try
     {
-        QString replyStr(Network::httpGet(QString("http://comment.bilibili.com/%1.xml").arg(item->subId),QUrlQuery()));
-        handleDownloadReply(replyStr,danmuList);
+        QByteArray replyBytes(Network::httpGet(QString("http://comment.bilibili.com/%1.xml").arg(item->subId),QUrlQuery()));
+        handleDownloadReply(replyBytes,danmuList);
     }
     catch(Network::NetworkError &error)
     {
@@ -344,50 +346,7 @@ void BilibiliProvider::decodeEpList(QByteArray &bytes, DanmuAccessResult *result
     }
 }
 
-void BilibiliProvider::handleDownloadReply(QString &reply, QList<DanmuComment *> &danmuList)
+void BilibiliProvider::handleDownloadReply(const QByteArray &reply, QList<DanmuComment *> &danmuList)
 {
-    QXmlStreamReader reader(reply);
-    while(!reader.atEnd())
-    {
-        if(reader.isStartElement() && reader.name()=="d")
-        {
-            QXmlStreamAttributes attributes=reader.attributes();
-            if(attributes.hasAttribute("p"))
-            {
-                QStringList attrList=attributes.value("p").toString().split(',');
-                if(attrList.length()<8)continue;
-                DanmuComment *danmu=new DanmuComment();
-                danmu->text=reader.readElementText();
-                danmu->time = attrList[0].toFloat() * 1000;
-                danmu->originTime=danmu->time;
-                danmu->setType(attrList[1].toInt());
-                danmu->color=attrList[3].toInt();
-                danmu->date=attrList[4].toLongLong();
-                danmu->sender="[Bilibili]"+attrList[6];
-                switch (attrList[2].toInt())
-                {
-                case 25:
-                    danmu->fontSizeLevel=DanmuComment::Normal;
-                    break;
-                case 18:
-                    danmu->fontSizeLevel=DanmuComment::Small;
-                    break;
-                case 36:
-                    danmu->fontSizeLevel=DanmuComment::Large;
-                    break;
-                default:
-                    break;
-                }
-                if(danmu->type!=DanmuComment::UNKNOW)danmuList.append(danmu);
-                else
-                {
-#ifdef QT_DEBUG
-                    qDebug()<<"unsupport danmu mode:"<<danmu->text;
-#endif
-                    delete danmu;
-                }
-            }
-        }
-        reader.readNext();
-    }
+    LocalProvider::ParseXmlDanmu(reply.constData(),reply.constData()+reply.size(),danmuList,"[Bilibili]",8);
 }
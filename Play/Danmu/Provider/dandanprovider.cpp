@@ -8,9 +8,10 @@ DanmuAccessResult *DandanProvider::search(const QString &keyword)
     query.addQueryItem("anime", keyword);
     DanmuAccessResult *searchResult=new DanmuAccessResult;
     searchResult->providerId=id();
+    searchResult->fromCache=false;
     try
     {
-        QString str(Network::httpGet(baseUrl,query,QStringList()<<"Accept"<<"application/json"));
+        QString str(Network::httpGet(baseUrl,query,QStringList()<<"Accept"<<"application/json",&searchResult->fromCache));
         QJsonDocument document(Network::toJson(str));
         handleSearchReply(document,searchResult);
     }
@@ -22,9 +22,10 @@ DanmuAccessResult *DililiProvider::search(const QString &keyword)
 
     DanmuAccessResult *searchResult=new DanmuAccessResult;
     searchResult->providerId=id();
+    searchResult->fromCache=false;
     try
     {
-        QString str(Network::httpGet(baseUrl,QUrlQuery()));
+        QString str(Network::httpGet(baseUrl,QUrlQuery(),QStringList(),&searchResult->fromCache));
         handleSearchReply(str,searchResult);
     }
     catch(Network::NetworkError &error)
@@ -150,7 +151,7 @@ void DililiProvider::handleSearchReply(const QString &reply, DanmuAccessResult *
         bool itemStart=false;
         while(!parser.atEnd())
         {
-            if(parser.currentNodeProperty("class").startsWith("video-item"))
+            if(parser.currentNodePropertyRef("class").startsWith(QLatin1String("video-item")))
             {
                 if(!itemStart)itemStart=true;
                 else result->list.append(item);
@@ -161,7 +162,7 @@ void DililiProvider::handleSearchReply(const QString &reply, DanmuAccessResult *
                 item.strId=parser.currentNodeProperty("href");
                 item.title=parser.currentNodeProperty("title");
             }
-            else if(parser.currentNodeProperty("class")=="item-content hidden")
+            else if(parser.currentNodePropertyRef("class")=="item-content hidden")
             {
                 parser.readNext();
                 item.description=parser.readContentText();
@@ -190,7 +191,7 @@ void DililiProvider::handleEpReply(const QString &reply, DanmuAccessResult *resu
         bool itemStart=false;
         while(!parser.atEnd())
         {
-            if(parser.currentNode()=='a' && parser.isStartNode())
+            if(parser.currentNode()=="a" && parser.isStartNode())
             {
                 if(!itemStart)itemStart=true;
                 else result->list.append(item);
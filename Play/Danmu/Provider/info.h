@@ -31,6 +31,7 @@ Q_DECLARE_OPAQUE_POINTER(DanmuSourceItem *)
 struct DanmuAccessResult
 {
     bool error;
+    bool fromCache;
     QString errorInfo;
 	QString providerId;
     QList<DanmuSourceItem> list;
@@ -1,7 +1,7 @@
 #include "iqiyiprovider.h"
 #include "Common/htmlparsersax.h"
 #include "Common/network.h"
-#include "Common/zlib.h"
+#include "Common/zlibstream.h"
 
 namespace
 {
@@ -18,9 +18,10 @@ DanmuAccessResult *IqiyiProvider::search(const QString &keyword)
     QString baseUrl = QString("https://so.iqiyi.com/so/q_%1_site_iqiyi_m_").arg(keyword);
     DanmuAccessResult *searchResult=new DanmuAccessResult;
     searchResult->providerId=id();
+    searchResult->fromCache=false;
     try
     {
-        QString str(Network::httpGet(baseUrl,QUrlQuery()));
+        QString str(Network::httpGet(baseUrl,QUrlQuery(),QStringList(),&searchResult->fromCache));
         handleSearchReply(str,searchResult);
     }
     catch(Network::NetworkError &error)
@@ -121,7 +122,7 @@ void IqiyiProvider::handleSearchReply(QString &reply, DanmuAccessResult *result)
         bool epStart=false;
         while(!parser.atEnd())
         {
-            if(parser.currentNodeProperty("class")=="list_item")
+            if(parser.currentNodePropertyRef("class")=="list_item")
             {
                 if(!itemStart)itemStart=true;
 				else
@@ -131,25 +132,25 @@ void IqiyiProvider::handleSearchReply(QString &reply, DanmuAccessResult *result)
                 epStart=false;
                 item.title=parser.currentNodeProperty("data-widget-searchlist-tvname");
             }
-            else if(parser.currentNodeProperty("class")=="result_title")
+            else if(parser.currentNodePropertyRef("class")=="result_title")
             {
                 parser.readNext();
                 item.strId=parser.currentNodeProperty("href");
             }
-            else if(parser.currentNodeProperty("class")=="info_play_btn")
+            else if(parser.currentNodePropertyRef("class")=="info_play_btn")
             {
                 item.strId=parser.currentNodeProperty("href");
             }
-            else if(parser.currentNodeProperty("class")=="result_info_txt")
+            else if(parser.currentNodePropertyRef("class")=="result_info_txt")
             {
                 item.description=parser.readContentText();
             }
-            else if(parser.currentNodeProperty("class")=="result_album clearfix" &&
-                    parser.currentNodeProperty("data-tvlist-elem")=="list")
+            else if(parser.currentNodePropertyRef("class")=="result_album clearfix" &&
+                    parser.currentNodePropertyRef("data-tvlist-elem")=="list")
             {
                 epStart=true;
             }
-            else if(epStart && parser.currentNodeProperty("class")=="album_link")
+            else if(epStart && parser.currentNodePropertyRef("class")=="album_link")
             {
                 if(!parser.currentNodeProperty("href").isEmpty())
                 {
@@ -166,115 +167,72 @@ void IqiyiProvider::handleSearchReply(QString &reply, DanmuAccessResult *result)
     result->error = false;
 }
 
-void IqiyiProvider::downloadAllDanmu(const QString &id, QList<DanmuComment *> &danmuList)
+//Segments are zlib-compressed xml, inflated and parsed while they are being downloaded
+class IqiyiProvider::BulletDecoder : public ProviderBase::SegmentDecoder
 {
-    QString tvId = "0000" + id;
-    QString s1(tvId.mid(tvId.length()-4,2)),s2(tvId.mid(tvId.length()-2));
-    QString baseUrl=QString("http://cmts.iqiyi.com/bullet/%1/%2/%3_300_%4.z").arg(s1).arg(s2).arg(id);
-    int i = 1;
-    while(true)
+public:
+    BulletDecoder():xmlReader([this](QXmlStreamReader &reader){handleToken(reader);})
     {
-        try
+        tmpDanmu.setType(1);
+        tmpDanmu.fontSizeLevel=DanmuComment::Normal;
+    }
+    virtual bool feed(const QByteArray &chunk) override {return xmlReader.feed(chunk);}
+private:
+    InflateXmlReader xmlReader;
+    DanmuComment tmpDanmu;
+    QString elementText;
+    //element text may come in several pieces, also across chunks
+    void handleToken(QXmlStreamReader &reader)
+    {
+        if(reader.isStartElement())
         {
-            QString dmUrl=baseUrl.arg(i++);
-            QByteArray replyBytes(Network::httpGet(dmUrl,QUrlQuery()));
-            QByteArray decompressResult;
-            if(decompress(replyBytes,decompressResult)!=Z_OK)continue;
-            QXmlStreamReader reader(decompressResult);
-            bool dmStart=false;
-            DanmuComment tmpDanmu;
-            tmpDanmu.setType(1);
-            tmpDanmu.fontSizeLevel=DanmuComment::Normal;
-            while(!reader.atEnd())
-            {
-                if(reader.isStartElement())
-                {
-                    if(reader.name()=="bulletInfo")
-                    {
-                        dmStart=true;
-                    }
-                    else if(reader.name()=="contentId")
-                    {
-                        QString idText=reader.readElementText();
-                        tmpDanmu.date=idText.mid(0,10).toLongLong();
-                    }
-                    else if(reader.name()=="content")
-                    {
-                        tmpDanmu.text=reader.readElementText();
-                    }
-                    else if(reader.name()=="showTime")
-                    {
-                        tmpDanmu.time = reader.readElementText().toFloat() * 1000;
-                        tmpDanmu.originTime= tmpDanmu.time;
-                    }
-                    else if(reader.name()=="color")
-                    {
-                        tmpDanmu.color = reader.readElementText().toInt(nullptr,16);
-                    }
-                    else if(reader.name()=="uid")
-                    {
-                        tmpDanmu.sender="[iqiyi]"+reader.readElementText();
-                    }
-                }
-                else if(reader.isEndElement())
-                {
-                    if(reader.name()=="bulletInfo")
-                    {
-                        dmStart=false;
-                        danmuList.append(new DanmuComment(tmpDanmu));
-                    }
-                }
-                reader.readNext();
-            }
+            elementText.clear();
         }
-        catch(Network::NetworkError &)
+        else if(reader.isCharacters())
         {
-            return;
+            elementText.append(reader.text());
         }
-    }
-}
-
-int IqiyiProvider::decompress(const QByteArray &input, QByteArray &output)
-{
-    int ret;
-    unsigned have;
-    const int chunkSize=16384;
-    z_stream stream;
-    stream.zalloc = Z_NULL;
-    stream.zfree = Z_NULL;
-    stream.opaque = Z_NULL;
-    stream.avail_in = 0;
-    stream.next_in = Z_NULL;
-    ret = inflateInit(&stream);
-    if (ret != Z_OK) return ret;
-    unsigned char inBuf[chunkSize];
-    unsigned char outBuf[chunkSize];
-    QDataStream inStream(input);
-    while(!inStream.atEnd())
-    {
-        stream.avail_in=inStream.readRawData((char *)&inBuf,chunkSize);
-        if (stream.avail_in == 0)
-            break;
-        stream.next_in = inBuf;
-        do
+        else if(reader.isEndElement())
         {
-            stream.avail_out = chunkSize;
-            stream.next_out = outBuf;
-            ret = inflate(&stream, Z_NO_FLUSH);
-            switch (ret)
+            if(reader.name()=="contentId")
             {
-            case Z_NEED_DICT:
-                ret = Z_DATA_ERROR;
-            case Z_DATA_ERROR:
-            case Z_MEM_ERROR:
-                (void)inflateEnd(&stream);
-                return ret;
+                tmpDanmu.date=elementText.mid(0,10).toLongLong();
             }
-            have = chunkSize - stream.avail_out;
-            output.append((const char *)outBuf,have);
-        } while (stream.avail_out == 0);
+            else if(reader.name()=="content")
+            {
+                tmpDanmu.text=elementText;
+            }
+            else if(reader.name()=="showTime")
+            {
+                tmpDanmu.time = elementText.toFloat() * 1000;
+                tmpDanmu.originTime= tmpDanmu.time;
+            }
+            else if(reader.name()=="color")
+            {
+                tmpDanmu.color = elementText.toInt(nullptr,16);
+            }
+            else if(reader.name()=="uid")
+            {
+                tmpDanmu.sender="[iqiyi]"+elementText;
+            }
+            else if(reader.name()=="bulletInfo")
+            {
+                danmuList.append(new DanmuComment(tmpDanmu));
+            }
+            elementText.clear();
+        }
     }
-    (void)inflateEnd(&stream);
-    return Z_OK ;
-}
+};
 
+void IqiyiProvider::downloadAllDanmu(const QString &id, QList<DanmuComment *> &danmuList)
+{
+    QString tvId = "0000" + id;
+    QString s1(tvId.mid(tvId.length()-4,2)),s2(tvId.mid(tvId.length()-2));
+    QString baseUrl=QString("http://cmts.iqiyi.com/bullet/%1/%2/%3_300_%4.z").arg(s1).arg(s2).arg(id);
+    //each segment covers 5 minutes, the count is unknown until a segment is missing
+    downloadSegments([baseUrl](int index){
+        return baseUrl.arg(index+1);
+    },-1,[](){
+        return new BulletDecoder;
+    },danmuList);
+}
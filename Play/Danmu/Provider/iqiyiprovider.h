@@ -23,7 +23,7 @@ public slots:
 private:
     void handleSearchReply(QString &reply,DanmuAccessResult *result);
     void downloadAllDanmu(const QString &id, QList<DanmuComment *> &danmuList);
-    int decompress(const QByteArray &input, QByteArray &output);
+    class BulletDecoder;
 };
 
 #endif // IQIYIPROVIDER_H
@@ -1,21 +1,259 @@
 #include "localprovider.h"
+#include <cstring>
+#include <cctype>
+namespace
+{
+    const char dmTag[]="<d p=\"";
+    const int dmTagLength=sizeof(dmTag)-1;
+    const int parallelThreshold=4*1024*1024;
 
+    const char *findTag(const char *begin,const char *end,const char *tag,int tagLength)
+    {
+        while(end-begin>=tagLength)
+        {
+            const char *pos=static_cast<const char *>(memchr(begin,tag[0],end-begin-tagLength+1));
+            if(!pos)return end;
+            if(memcmp(pos,tag,tagLength)==0)return pos;
+            begin=pos+1;
+        }
+        return end;
+    }
+    //any <d element, whatever its attributes look like
+    bool hasDanmuElement(const char *begin,const char *end)
+    {
+        for(const char *p=findTag(begin,end,"<d",2);p<end;p=findTag(p+2,end,"<d",2))
+        {
+            if(p+2<end && (isspace(uchar(p[2])) || p[2]=='>' || p[2]=='/'))return true;
+        }
+        return false;
+    }
+    qint64 parseInt(const char *&p,const char *end)
+    {
+        bool negative=false;
+        if(p<end && *p=='-')
+        {
+            negative=true;
+            ++p;
+        }
+        qint64 val=0;
+        while(p<end && *p>='0' && *p<='9')
+            val=val*10+(*p++-'0');
+        return negative?-val:val;
+    }
+    //seconds with optional fraction, in ms
+    int parseTime(const char *&p,const char *end)
+    {
+        bool negative=(p<end && *p=='-');
+        qint64 ms=qAbs(parseInt(p,end))*1000;
+        if(p<end && *p=='.')
+        {
+            ++p;
+            int scale=100;
+            while(p<end && *p>='0' && *p<='9')
+            {
+                ms+=(*p++-'0')*scale;
+                scale/=10;
+            }
+        }
+        return negative?-ms:ms;
+    }
+    const char *skipField(const char *p,const char *end)
+    {
+        while(p<end && *p!=',' && *p!='"')++p;
+        return p;
+    }
+    QString decodeText(const char *begin,const char *end)
+    {
+        const char *amp=static_cast<const char *>(memchr(begin,'&',end-begin));
+        if(!amp)return QString::fromUtf8(begin,end-begin);
+        QByteArray buf;
+        buf.reserve(end-begin);
+        while(amp)
+        {
+            buf.append(begin,amp-begin);
+            const char *semi=static_cast<const char *>(memchr(amp,';',qMin<qint64>(end-amp,12)));
+            if(!semi)
+            {
+                buf.append('&');
+                begin=amp+1;
+            }
+            else
+            {
+                QByteArray entity(amp+1,semi-amp-1);
+                if(entity=="amp")buf.append('&');
+                else if(entity=="lt")buf.append('<');
+                else if(entity=="gt")buf.append('>');
+                else if(entity=="quot")buf.append('"');
+                else if(entity=="apos")buf.append('\'');
+                else if(entity.startsWith('#'))
+                {
+                    bool ok=false;
+                    uint code=entity.startsWith("#x")?entity.mid(2).toUInt(&ok,16):entity.mid(1).toUInt(&ok);
+                    if(ok)buf.append(QString::fromUcs4(&code,1).toUtf8());
+                }
+                else buf.append(amp,semi-amp+1);
+                begin=semi+1;
+            }
+            amp=static_cast<const char *>(memchr(begin,'&',end-begin));
+        }
+        buf.append(begin,end-begin);
+        return QString::fromUtf8(buf);
+    }
+    void scanRange(const char *begin,const char *end,QList<DanmuComment *> &list,const QString &senderPrefix,int minFields)
+    {
+        const char *p=findTag(begin,end,dmTag,dmTagLength);
+        while(p<end)
+        {
+            p+=dmTagLength;
+            const char *fieldEnd[8];
+            const char *fieldBegin[8];
+            int fieldCount=0;
+            const char *cur=p;
+            while(cur<end && *cur!='"')
+            {
+                const char *next=skipField(cur,end);
+                if(fieldCount<8)
+                {
+                    fieldBegin[fieldCount]=cur;
+                    fieldEnd[fieldCount]=next;
+                }
+                ++fieldCount;
+                cur=(next<end && *next==',')?next+1:next;
+            }
+            const char *tagEnd=static_cast<const char *>(memchr(cur,'>',end-cur));
+            if(!tagEnd)break;
+            const char *textEnd=tagEnd;
+            if(*(tagEnd-1)!='/')
+                textEnd=findTag(tagEnd+1,end,"</d>",4);
+            if(fieldCount>=minFields)
+            {
+                DanmuComment *danmu=new DanmuComment();
+                if(textEnd>tagEnd)
+                    danmu->text=decodeText(tagEnd+1,textEnd);
+                const char *fp=fieldBegin[0];
+                danmu->time=parseTime(fp,fieldEnd[0]);
+                danmu->originTime=danmu->time;
+                fp=fieldBegin[1];
+                danmu->setType(parseInt(fp,fieldEnd[1]));
+                fp=fieldBegin[3];
+                danmu->color=parseInt(fp,fieldEnd[3]);
+                if(fieldCount>4)
+                {
+                    fp=fieldBegin[4];
+                    danmu->date=parseInt(fp,fieldEnd[4]);
+                }
+                if(fieldCount>6)
+                    danmu->sender=senderPrefix+QString::fromLatin1(fieldBegin[6],fieldEnd[6]-fieldBegin[6]);
+                fp=fieldBegin[2];
+                switch (parseInt(fp,fieldEnd[2]))
+                {
+                case 25:
+                    danmu->fontSizeLevel=DanmuComment::Normal;
+                    break;
+                case 18:
+                    danmu->fontSizeLevel=DanmuComment::Small;
+                    break;
+                case 36:
+                    danmu->fontSizeLevel=DanmuComment::Large;
+                    break;
+                default:
+                    break;
+                }
+                if(danmu->type!=DanmuComment::UNKNOW)list.append(danmu);
+                else delete danmu;
+            }
+            p=findTag(textEnd,end,dmTag,dmTagLength);
+        }
+    }
+    class ScanTask : public QRunnable
+    {
+    public:
+        ScanTask(const char *begin,const char *end,QList<DanmuComment *> *list,const QString &senderPrefix,int minFields):
+            begin(begin),end(end),list(list),senderPrefix(senderPrefix),minFields(minFields){}
+        virtual void run() override {scanRange(begin,end,*list,senderPrefix,minFields);}
+    private:
+        const char *begin,*end;
+        QList<DanmuComment *> *list;
+        QString senderPrefix;
+        int minFields;
+    };
+}
 
 void LocalProvider::LoadXmlDanmuFile(QString filePath, QList<DanmuComment *> &list)
 {
     QFile xmlFile(filePath);
-    bool ret=xmlFile.open(QIODevice::ReadOnly|QIODevice::Text);
+    bool ret=xmlFile.open(QIODevice::ReadOnly);
     if(!ret)return;
-    QXmlStreamReader reader(&xmlFile);
+    uchar *data=xmlFile.size()>0?xmlFile.map(0,xmlFile.size()):nullptr;
+    const char *begin=reinterpret_cast<const char *>(data);
+    if(!data || !ParseXmlDanmu(begin,begin+xmlFile.size(),list))
+    {
+        if(data)xmlFile.unmap(data);
+        data=nullptr;
+        xmlFile.seek(0);
+        QXmlStreamReader reader(&xmlFile);
+        LoadXmlDanmu(reader,list);
+    }
+    if(data)xmlFile.unmap(data);
+    xmlFile.close();
+}
+
+bool LocalProvider::ParseXmlDanmu(const char *begin, const char *end, QList<DanmuComment *> &list, const QString &senderPrefix, int minFields)
+{
+    //XML without a declared encoding is UTF-8, anything else goes to QXmlStreamReader
+    if(end-begin>=2 && ((uchar)begin[0]==0xFF || (uchar)begin[0]==0xFE))return false;
+    if(end-begin>=3 && memcmp(begin,"\xEF\xBB\xBF",3)==0)begin+=3;
+    const char *declEnd=(end-begin>5 && memcmp(begin,"<?xml",5)==0)?
+                static_cast<const char *>(memchr(begin,'>',qMin<qint64>(end-begin,256))):nullptr;
+    if(declEnd)
+    {
+        QByteArray decl(begin,declEnd-begin);
+        int pos=decl.indexOf("encoding=");
+        if(pos!=-1)
+        {
+            QByteArray encoding(decl.mid(pos+10).toLower());
+            if(!encoding.startsWith("utf-8") && !encoding.startsWith("utf8"))return false;
+        }
+    }
+    if(minFields<4)minFields=4;
+    int countBefore=list.count();
+    int threads=QThreadPool::globalInstance()->maxThreadCount();
+    if(end-begin<parallelThreshold || threads<2)
+    {
+        scanRange(begin,end,list,senderPrefix,minFields);
+        //<d p='...'>, other attributes before p, etc. are left to QXmlStreamReader
+        return list.count()>countBefore || !hasDanmuElement(begin,end);
+    }
+    QVector<const char *> bounds;
+    bounds.append(begin);
+    for(int i=1;i<threads;++i)
+    {
+        const char *guess=begin+(end-begin)/threads*i;
+        if(guess<bounds.last())guess=bounds.last();
+        bounds.append(findTag(guess,end,dmTag,dmTagLength));
+    }
+    bounds.append(end);
+    QVector<QList<DanmuComment *> > parts(threads);
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for(int i=0;i<threads;++i)
+        pool.start(new ScanTask(bounds[i],bounds[i+1],&parts[i],senderPrefix,minFields));
+    pool.waitForDone();
+    for(const QList<DanmuComment *> &part:parts)
+        list.append(part);
+    return list.count()>countBefore || !hasDanmuElement(begin,end);
+}
+
+void LocalProvider::LoadXmlDanmu(QXmlStreamReader &reader, QList<DanmuComment *> &list)
+{
     while(!reader.atEnd())
     {
         if(reader.isStartElement() && reader.name()=="d")
         {
             QXmlStreamAttributes attributes=reader.attributes();
-            if(attributes.hasAttribute("p"))
+            QStringList attrList=attributes.value("p").toString().split(',');
+            if(attrList.length()>=4)
             {
-                QStringList attrList=attributes.value("p").toString().split(',');
-                if(attrList.length()<4)continue;
                 DanmuComment *danmu=new DanmuComment();
                 danmu->text=reader.readElementText();
                 danmu->time = attrList[0].toFloat() * 1000;
@@ -52,5 +290,4 @@ void LocalProvider::LoadXmlDanmuFile(QString filePath, QList<DanmuComment *> &li
         }
         reader.readNext();
     }
-    xmlFile.close();
 }
@@ -5,6 +5,14 @@ class LocalProvider
 {
 public:
     static void LoadXmlDanmuFile(QString filePath, QList<DanmuComment *> &list);
+    //scan <d p="time,mode,size,color,date,pool,sender,...">text</d> in a UTF-8 buffer without building a DOM,
+    //large buffers are split at <d boundaries and scanned in parallel.
+    //return false if the buffer is not UTF-8, or has <d elements but none in the form above,
+    //the caller should fall back to QXmlStreamReader
+    static bool ParseXmlDanmu(const char *begin, const char *end, QList<DanmuComment *> &list,
+                              const QString &senderPrefix=QString(), int minFields=4);
+private:
+    static void LoadXmlDanmu(QXmlStreamReader &reader, QList<DanmuComment *> &list);
 };
 
 #endif // LOCALPROVIDER_H
@@ -5,6 +5,155 @@
 #include <QSqlRecord>
 
 MatchWorker *MatchProvider::matchWorker=nullptr;
+namespace
+{
+    struct FileHashInfo
+    {
+        qint64 size;
+        qint64 modifyTime;
+        QString hash;
+    };
+    QHash<QString,FileHashInfo> fileHashCache;
+    //paths already looked up in the fingerprint table, found there or not
+    QSet<QString> fileHashLookedUp;
+    QList<QPair<QString,FileHashInfo> > unsavedHashes;
+    QStringList missingPaths;
+    QMutex fileHashLock;
+    //rows per select, below the SQLite limit of bound variables
+    const int fingerprintBatch=500;
+    void scheduleSave()
+    {
+        //called with fileHashLock held
+        if(unsavedHashes.count()+missingPaths.count()==1)
+            QMetaObject::invokeMethod(QCoreApplication::instance(),[](){MatchProvider::flushFileHashes();},Qt::QueuedConnection);
+    }
+    //only the rows of paths, callers may be on any thread
+    void loadFileHashes(const QStringList &paths)
+    {
+        QHash<QString,FileHashInfo> rows;
+        QString connectionName(QString("FP%1").arg(quintptr(QThread::currentThreadId())));
+        {
+            QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE",connectionName);
+            database.setDatabaseName(QCoreApplication::applicationDirPath()+"\\kikoplay.db");
+            if(database.open())
+            {
+                QSqlQuery query(database);
+                for(int pos=0;pos<paths.count();pos+=fingerprintBatch)
+                {
+                    QStringList batch(paths.mid(pos,fingerprintBatch));
+                    QStringList placeholders;
+                    for(int i=0;i<batch.count();++i)placeholders.append("?");
+                    query.prepare(QString("select Path,Size,MTime,MD5 from fingerprint where Path in (%1)").arg(placeholders.join(',')));
+                    for(int i=0;i<batch.count();++i)query.bindValue(i,batch.at(i));
+                    query.exec();
+                    while(query.next())
+                        rows.insert(query.value(0).toString(),{query.value(1).toLongLong(),query.value(2).toLongLong(),query.value(3).toString()});
+                }
+            }
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+        QMutexLocker locker(&fileHashLock);
+        for(const QString &path:paths)
+        {
+            fileHashLookedUp.insert(path);
+            auto iter=rows.constFind(path);
+            //a hash computed meanwhile is newer than the row
+            if(iter!=rows.constEnd() && !fileHashCache.contains(path))
+                fileHashCache.insert(path,iter.value());
+        }
+    }
+}
+
+void MatchProvider::prefetchHashes(const QStringList &fileNames)
+{
+    QStringList paths;
+    {
+        QMutexLocker locker(&fileHashLock);
+        for(const QString &fileName:fileNames)
+        {
+            QFileInfo fileInfo(fileName);
+            QString path(fileInfo.canonicalFilePath());
+            if(path.isEmpty())
+            {
+                //the file is gone, so is its row
+                QString absolutePath(fileInfo.absoluteFilePath());
+                if(fileHashCache.remove(absolutePath)>0 || !fileHashLookedUp.contains(absolutePath))
+                {
+                    fileHashLookedUp.insert(absolutePath);
+                    missingPaths.append(absolutePath);
+                    scheduleSave();
+                }
+                continue;
+            }
+            if(!fileHashLookedUp.contains(path))paths.append(path);
+        }
+    }
+    if(!paths.isEmpty())loadFileHashes(paths);
+}
+
+void MatchProvider::flushFileHashes()
+{
+    QList<QPair<QString,FileHashInfo> > hashList;
+    QStringList removedPaths;
+    {
+        QMutexLocker locker(&fileHashLock);
+        hashList.swap(unsavedHashes);
+        removedPaths.swap(missingPaths);
+    }
+    if(hashList.isEmpty() && removedPaths.isEmpty())return;
+    QSqlDatabase database=QSqlDatabase::database("MT");
+    database.transaction();
+    QSqlQuery query(database);
+    query.prepare("delete from fingerprint where Path=?");
+    for(const QString &path:removedPaths)
+    {
+        query.bindValue(0,path);
+        query.exec();
+    }
+    query.prepare("insert or replace into fingerprint(Path,Size,MTime,MD5) values(?,?,?,?)");
+    for(const auto &pair:hashList)
+    {
+        query.bindValue(0,pair.first);
+        query.bindValue(1,pair.second.size);
+        query.bindValue(2,pair.second.modifyTime);
+        query.bindValue(3,pair.second.hash);
+        query.exec();
+    }
+    database.commit();
+}
+
+QString MatchProvider::fileHash(const QString &fileName)
+{
+    QFileInfo fileInfo(fileName);
+    QString path(fileInfo.canonicalFilePath());
+    if(path.isEmpty())return QString();
+    qint64 size=fileInfo.size(),modifyTime=fileInfo.lastModified().toMSecsSinceEpoch();
+    bool lookedUp;
+    {
+        QMutexLocker locker(&fileHashLock);
+        lookedUp=fileHashLookedUp.contains(path);
+    }
+    if(!lookedUp)loadFileHashes(QStringList()<<path);
+    {
+        QMutexLocker locker(&fileHashLock);
+        auto iter=fileHashCache.constFind(path);
+        if(iter!=fileHashCache.constEnd() && iter->size==size && iter->modifyTime==modifyTime)
+            return iter->hash;
+    }
+    QFile mediaFile(fileName);
+    bool ret=mediaFile.open(QIODevice::ReadOnly);
+    if(!ret)return QString();
+    QByteArray file16MB = mediaFile.read(16*1024*1024);
+    QByteArray hashData = QCryptographicHash::hash(file16MB,QCryptographicHash::Md5);
+    QString hashStr(hashData.toHex());
+    FileHashInfo hashInfo{size,modifyTime,hashStr};
+    QMutexLocker locker(&fileHashLock);
+    //a changed file replaces its old row
+    fileHashCache.insert(path,hashInfo);
+    unsavedHashes.append(qMakePair(path,hashInfo));
+    scheduleSave();
+    return hashStr;
+}
 
 MatchInfo *MatchProvider::SearchFormDandan(const QString &keyword)
 {
@@ -81,27 +230,19 @@ MatchInfo *MatchProvider::MatchFromDandan(QString fileName)
     return curMatchInfo;
 }
 
-MatchInfo *MatchProvider::MatchFromDB(QString fileName)
+MatchInfo *MatchProvider::MatchFromDB(QString fileName, const QString cName)
 {
-    QFile mediaFile(fileName);
-    bool ret=mediaFile.open(QIODevice::ReadOnly);
-    if(!ret)return nullptr;
-    QByteArray file16MB = mediaFile.read(16*1024*1024);
-    QByteArray hashData = QCryptographicHash::hash(file16MB,QCryptographicHash::Md5);
-    QString hashStr(hashData.toHex());
-    return MatchWorker::retrieveInMatchTable(hashStr);
+    QString hashStr(fileHash(fileName));
+    if(hashStr.isEmpty())return nullptr;
+    return MatchWorker::retrieveInMatchTable(hashStr,cName);
 }
 
 QString MatchProvider::updateMatchInfo(QString fileName, MatchInfo *newMatchInfo, const QString cName)
 {
     MatchInfo::DetailInfo detailInfo=newMatchInfo->matches.first();
     QString poolID=addToBangumiTable(detailInfo.animeTitle,detailInfo.title);
-    QFile mediaFile(fileName);
-    bool ret=mediaFile.open(QIODevice::ReadOnly);
-    if(!ret)return poolID;
-    QByteArray file16MB = mediaFile.read(16*1024*1024);
-    QByteArray hashData = QCryptographicHash::hash(file16MB,QCryptographicHash::Md5);
-    QString hashStr(hashData.toHex());
+    QString hashStr(fileHash(fileName));
+    if(hashStr.isEmpty())return poolID;
     addToMatchTable(hashStr,poolID,true,cName);
     return poolID;
 }
@@ -139,6 +280,16 @@ QString MatchProvider::addToBangumiTable(QString animeTitle, QString title, cons
 }
 
 void MatchWorker::handleMatchReply(QJsonDocument &document, MatchInfo *matchInfo)
+{
+    parseMatchReply(document,matchInfo);
+    if(!matchInfo->error && matchInfo->success && matchInfo->matches.count()>0)
+    {
+        matchInfo->poolID=MatchProvider::addToBangumiTable(matchInfo->matches.first().animeTitle,matchInfo->matches.first().title,"WT");
+        MatchProvider::addToMatchTable(matchInfo->fileHash,matchInfo->poolID,true,"WT");
+    }
+}
+
+void MatchWorker::parseMatchReply(const QJsonDocument &document, MatchInfo *matchInfo)
 {
     do
     {
@@ -164,11 +315,6 @@ void MatchWorker::handleMatchReply(QJsonDocument &document, MatchInfo *matchInfo
             matchInfo->matches.append(detailInfo);
         }
         matchInfo->error = false;
-        if(matchInfo->success && matchInfo->matches.count()>0)
-        {
-            matchInfo->poolID=MatchProvider::addToBangumiTable(matchInfo->matches.first().animeTitle,matchInfo->matches.first().title,"WT");
-            MatchProvider::addToMatchTable(matchInfo->fileHash,matchInfo->poolID,"WT");
-        }
         return;
     }while(false);
     matchInfo->error=true;
@@ -245,16 +391,12 @@ MatchInfo *MatchWorker::retrieveInMatchTable(QString fileHash, const QString cNa
 
 void MatchWorker::beginMatch(QString fileName)
 {
-    QFile mediaFile(fileName);
-    bool ret=mediaFile.open(QIODevice::ReadOnly);
-    if(!ret)
+    QString hashStr(MatchProvider::fileHash(fileName));
+    if(hashStr.isEmpty())
     {
         emit matchDone(nullptr);
         return;
     }
-    QByteArray file16MB = mediaFile.read(16*1024*1024);
-    QByteArray hashData = QCryptographicHash::hash(file16MB,QCryptographicHash::Md5);
-    QString hashStr(hashData.toHex());
 
     MatchInfo *localMatchInfo=retrieveInMatchTable(hashStr,"WT");
     if(localMatchInfo)
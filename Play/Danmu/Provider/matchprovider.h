@@ -9,6 +9,8 @@ private:
     void handleDDSearchReply(QJsonDocument &document, MatchInfo *searchInfo);
 public:
     static MatchInfo *retrieveInMatchTable(QString fileHash,const QString cName="MT");
+    //fills matches from a dandan match reply, nothing is written to the DB
+    static void parseMatchReply(const QJsonDocument &document, MatchInfo *matchInfo);
 signals:
     void matchDone(MatchInfo *MatchInfo);
     void ddSearchDone(MatchInfo *searchInfo);
@@ -25,7 +27,14 @@ public:
     static MatchInfo *SearchFormBangumi(const QString &keyword);
     static MatchInfo *SerchFromDB(const QString &keyword);
     static MatchInfo *MatchFromDandan(QString fileName);
-    static MatchInfo *MatchFromDB(QString fileName);
+    static MatchInfo *MatchFromDB(QString fileName,const QString cName="MT");
+    //md5 of the first 16MB, remembered until the file's size or modify time changes
+    static QString fileHash(const QString &fileName);
+    //reads the stored hashes of fileNames in batches, so fileHash needs no query for them,
+    //rows of files that no longer exist are dropped
+    static void prefetchHashes(const QStringList &fileNames);
+    //writes new hashes and drops rows of missing files, on the main thread
+    static void flushFileHashes();
     static QString updateMatchInfo(QString fileName,MatchInfo *newMatchInfo,const QString cName="MT");
     static void addToMatchTable(QString fileHash,QString poolID,bool replace=false,const QString cName="MT");
     static QString addToBangumiTable(QString animeTitle,QString title,const QString cName="MT");
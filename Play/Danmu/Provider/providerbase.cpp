@@ -0,0 +1,51 @@
+#include "providerbase.h"
+#include "Common/network.h"
+
+QString ProviderBase::downloadSegments(SegmentURL segmentURL, int segmentCount, SegmentDecoderFactory createDecoder,
+                                       QList<DanmuComment *> &danmuList, int maxInFlight)
+{
+    QMap<int,QList<DanmuComment *> > segments;
+    QString errInfo;
+    int next=0,inFlight=0,end=segmentCount<0?INT_MAX:segmentCount;
+    QEventLoop eventLoop;
+    std::function<void()> launch;
+    auto segmentDone=[&](){
+        inFlight--;
+        launch();
+        if(inFlight==0 && next>=end)eventLoop.quit();
+    };
+    launch=[&](){
+        while(inFlight<maxInFlight && next<end)
+        {
+            int index=next++;
+            inFlight++;
+            QSharedPointer<SegmentDecoder> decoder(createDecoder());
+            //a broken segment keeps what was decoded before the error
+            QSharedPointer<bool> broken(new bool(false));
+            Network::httpGetStream(segmentURL(index),QUrlQuery(),QStringList(),[decoder,broken](const QByteArray &chunk){
+                if(!*broken)*broken=!decoder->feed(chunk);
+            },[&,index,decoder](const Network::Reply &reply){
+                if(reply.hasError)
+                {
+                    if(segmentCount<0)
+                        end=qMin(end,index);
+                    else if(errInfo.isEmpty())
+                        errInfo=reply.errorInfo;
+                }
+                segments.insert(index,decoder->danmuList);
+                decoder->danmuList.clear();
+                segmentDone();
+            });
+        }
+    };
+    launch();
+    if(inFlight>0)eventLoop.exec();
+    for(auto iter=segments.cbegin();iter!=segments.cend();++iter)
+    {
+        if(iter.key()<end)
+            danmuList.append(iter.value());
+        else
+            qDeleteAll(iter.value());
+    }
+    return errInfo;
+}
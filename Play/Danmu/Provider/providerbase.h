@@ -2,6 +2,7 @@
 #define PROVIDERBASE_H
 
 #include <QObject>
+#include <functional>
 #include "info.h"
 #include "../common.h"
 class ProviderBase : public QObject
@@ -20,6 +21,26 @@ public slots:
     virtual DanmuAccessResult *getURLInfo(const QString &url)=0;
     virtual QString downloadDanmu(DanmuSourceItem *item,QList<DanmuComment *> &danmuList)=0;
     virtual QString downloadBySourceURL(const QString &url,QList<DanmuComment *> &danmuList)=0;
+    //comments older than sinceDate are already known, providers that can page by date stop early
+    virtual QString updateBySourceURL(const QString &url,qint64 sinceDate,QList<DanmuComment *> &danmuList)
+    {Q_UNUSED(sinceDate);return downloadBySourceURL(url,danmuList);}
+protected:
+    //Decodes one segment while it is being downloaded
+    class SegmentDecoder
+    {
+    public:
+        virtual ~SegmentDecoder(){}
+        //the next bytes of the segment, false once the segment is found broken
+        virtual bool feed(const QByteArray &chunk)=0;
+        QList<DanmuComment *> danmuList;
+    };
+    typedef std::function<QString(int)> SegmentURL;
+    typedef std::function<SegmentDecoder *()> SegmentDecoderFactory;
+    //Download segment 0..segmentCount-1 with at most maxInFlight requests at a time.
+    //segmentCount<0: unknown, the first segment that fails marks the end.
+    //Each segment gets its own decoder, fed as bytes arrive, results are appended in segment order.
+    QString downloadSegments(SegmentURL segmentURL,int segmentCount,SegmentDecoderFactory createDecoder,
+                             QList<DanmuComment *> &danmuList,int maxInFlight=4);
 signals:
     void searchDone(DanmuAccessResult *searchInfo);
     void epInfoDone(DanmuAccessResult *epInfo, DanmuSourceItem *srcItem);
@@ -18,9 +18,10 @@ DanmuAccessResult *TucaoProvider::search(const QString &keyword)
 
     DanmuAccessResult *searchResult=new DanmuAccessResult;
     searchResult->providerId=id();
+    searchResult->fromCache=false;
     try
     {
-        QString str(Network::httpGet(baseUrl,query));
+        QString str(Network::httpGet(baseUrl,query,QStringList(),&searchResult->fromCache));
         handleSearchReply(str,searchResult);
     }
     catch(Network::NetworkError &error)
@@ -122,12 +123,12 @@ void TucaoProvider::handleSearchReply(QString &reply, DanmuAccessResult *result)
         bool itemStart=false;
         while(!parser.atEnd())
         {
-            if(parser.currentNodeProperty("class")=="info")
+            if(parser.currentNodePropertyRef("class")=="info")
             {
                 if(!itemStart)itemStart=true;
                 else result->list.append(item);
             }
-            else if(parser.currentNodeProperty("class")=="blue")
+            else if(parser.currentNodePropertyRef("class")=="blue")
             {
                 QRegExp re("h([0-9]+)");
                 re.indexIn(parser.currentNodeProperty("href"));
@@ -135,7 +136,7 @@ void TucaoProvider::handleSearchReply(QString &reply, DanmuAccessResult *result)
                 item.id=hidStr.toInt();
                 item.title=parser.readContentText();
             }
-            else if(parser.currentNodeProperty("class")=="d")
+            else if(parser.currentNodePropertyRef("class")=="d")
             {
                 item.description=parser.readContentText();
             }
@@ -65,7 +65,7 @@ void ComboBoxDelegate::setModelData(QWidget *editor, QAbstractItemModel *model,
     model->setData(index,combo->currentIndex(),Qt::EditRole);
 }
 
-Blocker::Blocker(QObject *parent):QAbstractItemModel(parent),maxId(1)
+Blocker::Blocker(QObject *parent):QAbstractItemModel(parent),maxId(1),revision(0)
 {
     QSqlQuery query(QSqlDatabase::database("MT"));
     query.exec(QString("select * from block"));
@@ -104,6 +104,7 @@ void Blocker::addBlockRule()
     rule->relation=BlockRule::Relation::Contain;
     rule->isRegExp=true;
     rule->enable=true;
+    revision++;
 	int insertPosition = blockList.count();
     beginInsertRows(QModelIndex(), insertPosition, insertPosition);
     blockList.append(rule);
@@ -114,6 +115,7 @@ void Blocker::addBlockRule()
 void Blocker::addBlockRule(BlockRule *rule)
 {
     rule->id=maxId++;
+    revision++;
     int insertPosition = blockList.count();
     beginInsertRows(QModelIndex(), insertPosition, insertPosition);
     blockList.append(rule);
@@ -140,6 +142,7 @@ void Blocker::removeBlockRule(const QModelIndexList &deleteIndexes)
         }
     }
     db.commit();
+    revision++;
     std::sort(rows.rbegin(),rows.rend());
     for(auto iter=rows.begin();iter!=rows.end();++iter)
     {
@@ -169,10 +172,32 @@ void Blocker::checkDanmu(QList<DanmuComment *> &danmuList)
 }
 
 void Blocker::checkDanmu(QList<QSharedPointer<DanmuComment> > &danmuList)
+{
+    applyRules(blockList,danmuList);
+}
+
+QList<BlockRule *> Blocker::cloneRules() const
+{
+    QList<BlockRule *> rules;
+    for(BlockRule *rule:blockList)
+    {
+        BlockRule *copy=new BlockRule;
+        copy->id=rule->id;
+        copy->blockField=rule->blockField;
+        copy->relation=rule->relation;
+        copy->isRegExp=rule->isRegExp;
+        copy->enable=rule->enable;
+        copy->content=rule->content;
+        rules.append(copy);
+    }
+    return rules;
+}
+
+void Blocker::applyRules(const QList<BlockRule *> &rules, QList<QSharedPointer<DanmuComment> > &danmuList)
 {
     for(QSharedPointer<DanmuComment> &danmu:danmuList)
     {
-        for(BlockRule *rule:blockList)
+        for(BlockRule *rule:rules)
         {
             if(rule->blockTest(danmu.data()))
             {
@@ -315,6 +340,7 @@ bool Blocker::setData(const QModelIndex &index, const QVariant &value, int)
         return false;
     }
     updateDB(row,col);
+    revision++;
     emit dataChanged(index,index);
     GlobalObjects::danmuPool->testBlockRule(rule);
     return true;
@@ -34,7 +34,12 @@ public:
     const QStringList relations={tr("Contain"),tr("Equal"),tr("NotEqual")};
     const QStringList headers={tr("Id"),tr("Enable"),tr("Field"),tr("Relation"),tr("RegExp"),tr("Content")};
     const QStringList colToDBRecords={"Id","Enable","Field","Relation","IsRegExp","Content"};
-    
+    //bumped whenever a rule is added, removed or edited
+    inline int getRevision() const {return revision;}
+    //copies for checking comments on another thread, the caller owns them
+    QList<BlockRule *> cloneRules() const;
+    static void applyRules(const QList<BlockRule *> &rules,QList<QSharedPointer<DanmuComment> > &danmuList);
+
 public slots:
 	void addBlockRule();
     void addBlockRule(BlockRule *rule);
@@ -45,6 +50,7 @@ public slots:
 private:
     QList<BlockRule *> blockList;
     int maxId;
+    int revision;
     void updateDB(int row,int col);
     void insertToDB(BlockRule *rule);
 
@@ -5,6 +5,25 @@
 DanmuObject *DanmuObject::head=nullptr;
 int DanmuObject::poolCount=0;
 
+quint64 DanmuComment::contentHash(const QString &text, int originTime, const QString &sender, int color)
+{
+    //64-bit FNV-1a
+    quint64 hash=14695981039346656037ULL;
+    auto feed=[&hash](const void *data,int len){
+        const uchar *p=static_cast<const uchar *>(data);
+        for(int i=0;i<len;++i)
+        {
+            hash^=p[i];
+            hash*=1099511628211ULL;
+        }
+    };
+    feed(text.constData(),text.size()*sizeof(QChar));
+    feed(&originTime,sizeof(int));
+    feed(sender.constData(),sender.size()*sizeof(QChar));
+    feed(&color,sizeof(int));
+    return hash;
+}
+
 bool BlockRule::blockTest(DanmuComment *comment)
 {
     if(!enable)return false;
@@ -5,7 +5,7 @@
 class DanmuComment
 {
 public:
-    DanmuComment():time(0),originTime(0),blockBy(-1){}
+    DanmuComment():time(0),originTime(0),blockBy(-1),id(0){}
     enum DanmuType
     {
         Rolling,
@@ -39,6 +39,9 @@ public:
             break;
         }
     }
+    //identity of a comment within its source, persisted as danmu.Hash
+    static quint64 contentHash(const QString &text,int originTime,const QString &sender,int color);
+    inline quint64 contentHash() const {return contentHash(text,originTime,sender,color);}
     QString text;
     QString sender;
     int color;
@@ -49,6 +52,7 @@ public:
     int originTime;
     int blockBy;
     int source;
+    qint64 id; //rowid in the danmu table, negative for comments not saved, 0 before the pool takes it
 };
 Q_DECLARE_OPAQUE_POINTER(DanmuComment *)
 class DanmuDrawInfo
@@ -87,6 +91,8 @@ struct DanmuSourceInfo
     QString name;
     QString url;
     bool show;
+    //newest comment date in this source, an update only needs comments since then
+    qint64 lastDate;
     QList<QPair<int,int> >timelineInfo;
 };
 struct BlockRule
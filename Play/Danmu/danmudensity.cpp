@@ -0,0 +1,130 @@
+#include "danmudensity.h"
+#include "common.h"
+namespace
+{
+    const int minSeconds=64;
+    inline int toSecond(int time){return time<0?0:time/1000;}
+}
+DanmuDensity::DanmuDensity()
+{
+    clear();
+}
+
+void DanmuDensity::reset(const QList<QSharedPointer<DanmuComment> > &danmuList)
+{
+    clear();
+    int maxTime=0;
+    for(const QSharedPointer<DanmuComment> &danmu:danmuList)
+    {
+        if(danmu->time>maxTime)maxTime=danmu->time;
+    }
+    resize(toSecond(maxTime)+1);
+    QVector<int> &seconds=levels[Second];
+    for(const QSharedPointer<DanmuComment> &danmu:danmuList)
+    {
+        if(danmu->blockBy!=-1)continue;
+        seconds[toSecond(danmu->time)]++;
+        total++;
+    }
+    for(int level=TenSeconds;level<LevelCount;++level)
+    {
+        int ratio=bucketSeconds(Level(level));
+        QVector<int> &buckets=levels[level];
+        for(int i=0;i<seconds.size();++i)
+            buckets[i/ratio]+=seconds.at(i);
+    }
+    for(int level=0;level<LevelCount;++level)
+        maxDirty[level]=true;
+    buildTree();
+}
+
+void DanmuDensity::clear()
+{
+    for(int level=0;level<LevelCount;++level)
+    {
+        levels[level].clear();
+        maxCounts[level]=0;
+        maxDirty[level]=false;
+    }
+    tree.clear();
+    total=0;
+}
+
+void DanmuDensity::add(int time, int count)
+{
+    int second=toSecond(time);
+    if(second>=levels[Second].size())
+        resize(qMax(second+1,levels[Second].size()*2));
+    for(int level=0;level<LevelCount;++level)
+    {
+        int &bucket=levels[level][second/bucketSeconds(Level(level))];
+        bucket+=count;
+        if(count>0)
+        {
+            if(!maxDirty[level] && bucket>maxCounts[level])maxCounts[level]=bucket;
+        }
+        else if(bucket-count==maxCounts[level])
+            maxDirty[level]=true;
+    }
+    for(int i=second+1;i<tree.size();i+=i&-i)
+        tree[i]+=count;
+    total+=count;
+}
+
+int DanmuDensity::rangeCount(int t1, int t2) const
+{
+    if(t2<t1)return 0;
+    int seconds=levels[Second].size();
+    return prefixCount(qMin(toSecond(t2)+1,seconds))-prefixCount(qMin(toSecond(t1),seconds));
+}
+
+int DanmuDensity::maxCount(DanmuDensity::Level level) const
+{
+    if(maxDirty[level])
+    {
+        maxCounts[level]=0;
+        for(int count:levels[level])
+            if(count>maxCounts[level])maxCounts[level]=count;
+        maxDirty[level]=false;
+    }
+    return maxCounts[level];
+}
+
+DanmuDensity::Level DanmuDensity::levelFor(int duration, int width)
+{
+    for(int level=0;level<LevelCount-1;++level)
+    {
+        if(qint64(width)*bucketSeconds(Level(level))>=duration)
+            return Level(level);
+    }
+    return Minute;
+}
+
+void DanmuDensity::resize(int seconds)
+{
+    seconds=qMax(seconds,minSeconds);
+    if(seconds<=levels[Second].size())return;
+    for(int level=0;level<LevelCount;++level)
+        levels[level].resize((seconds-1)/bucketSeconds(Level(level))+1);
+    buildTree();
+}
+
+void DanmuDensity::buildTree()
+{
+    const QVector<int> &seconds=levels[Second];
+    tree.fill(0,seconds.size()+1);
+    for(int i=1;i<tree.size();++i)
+    {
+        tree[i]+=seconds.at(i-1);
+        int parent=i+(i&-i);
+        if(parent<tree.size())tree[parent]+=tree.at(i);
+    }
+}
+
+int DanmuDensity::prefixCount(int seconds) const
+{
+    int count=0;
+    for(int i=seconds;i>0;i-=i&-i)
+        count+=tree.at(i);
+    return count;
+}
@@ -0,0 +1,47 @@
+#ifndef DANMUDENSITY_H
+#define DANMUDENSITY_H
+
+#include <QVector>
+#include <QList>
+#include <QSharedPointer>
+class DanmuComment;
+//counts of unblocked comments in 1s, 10s and 60s buckets, with a Fenwick tree over the 1s buckets for range counts
+class DanmuDensity
+{
+public:
+    enum Level
+    {
+        Second,
+        TenSeconds,
+        Minute,
+        LevelCount
+    };
+    DanmuDensity();
+    static inline int bucketSeconds(Level level){static const int seconds[LevelCount]={1,10,60};return seconds[level];}
+
+    void reset(const QList<QSharedPointer<DanmuComment> > &danmuList);
+    void clear();
+    //time in ms, comments before 0 are counted in the first bucket
+    void add(int time,int count=1);
+    inline void remove(int time){add(time,-1);}
+    inline void move(int oldTime,int newTime){if(oldTime/1000!=newTime/1000){add(oldTime,-1);add(newTime);}}
+    //comments in [t1,t2] ms, at 1s granularity
+    int rangeCount(int t1,int t2) const;
+    inline int totalCount() const {return total;}
+    inline const QVector<int> &buckets(Level level) const {return levels[level];}
+    int maxCount(Level level) const;
+    //the finest level whose buckets are at least 1px wide when duration(s) is drawn in width pixels
+    static Level levelFor(int duration,int width);
+private:
+    QVector<int> levels[LevelCount];
+    QVector<int> tree;
+    int total;
+    mutable int maxCounts[LevelCount];
+    mutable bool maxDirty[LevelCount];
+
+    void resize(int seconds);
+    void buildTree();
+    int prefixCount(int seconds) const;
+};
+
+#endif // DANMUDENSITY_H
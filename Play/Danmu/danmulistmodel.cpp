@@ -0,0 +1,173 @@
+#include "danmulistmodel.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFont>
+#include "danmupool.h"
+namespace
+{
+    const int fetchChunkSize=500;
+    //a few screens of rows
+    const int maxFormattedRows=1024;
+    //changes are applied at most once a frame
+    const int flushInterval=16;
+}
+DanmuListModel::DanmuListModel(DanmuPool *pool, QObject *parent) : QAbstractItemModel(parent),pool(pool),loadedCount(0),
+    resetPending(false),blockPending(false),formatCache(maxFormattedRows)
+{
+    rows=pool->getDanmuList();
+    loadedCount=qMin(fetchChunkSize,rows.count());
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(flushInterval);
+    QObject::connect(&flushTimer,&QTimer::timeout,this,&DanmuListModel::flush);
+    QObject::connect(pool,&DanmuPool::danmuReset,this,[this](){
+        resetPending=true;
+        pendingRemovals.clear();
+        scheduleFlush();
+    });
+    QObject::connect(pool,&DanmuPool::danmuRemoved,this,[this](int first,int last){
+        if(!resetPending)pendingRemovals.append(QPair<int,int>(first,last));
+        scheduleFlush();
+    });
+    QObject::connect(pool,&DanmuPool::blockStateChanged,this,[this](){
+        blockPending=true;
+        scheduleFlush();
+    });
+}
+
+QModelIndex DanmuListModel::getCurrentIndex()
+{
+    flush();
+    int position=pool->getCurrentPosition();
+    if(position<0)return QModelIndex();
+    //a chunk past the position, so it can be scrolled to the top
+    loadTo(position+fetchChunkSize);
+    return createIndex(position,0);
+}
+
+void DanmuListModel::scheduleFlush()
+{
+    if(!flushTimer.isActive())flushTimer.start();
+}
+
+void DanmuListModel::flush()
+{
+    flushTimer.stop();
+    if(resetPending)
+    {
+        beginResetModel();
+        rows=pool->getDanmuList();
+        loadedCount=qMin(fetchChunkSize,rows.count());
+        formatCache.clear();
+        endResetModel();
+    }
+    else if(!pendingRemovals.isEmpty())
+    {
+        //replayed in the order of the pool, rows past loadedCount are dropped silently
+        for(const QPair<int,int> &range:pendingRemovals)
+        {
+            if(range.first>=loadedCount)
+            {
+                rows.erase(rows.begin()+range.first,rows.begin()+range.second+1);
+                continue;
+            }
+            int visibleLast=qMin(range.second,loadedCount-1);
+            beginRemoveRows(QModelIndex(),range.first,visibleLast);
+            rows.erase(rows.begin()+range.first,rows.begin()+range.second+1);
+            loadedCount-=visibleLast-range.first+1;
+            endRemoveRows();
+        }
+        //same content now, share the list of the pool again
+        rows=pool->getDanmuList();
+    }
+    if(blockPending && !resetPending && loadedCount>0)
+    {
+        formatCache.clear();
+        emit dataChanged(createIndex(0,0),createIndex(loadedCount-1,1),{Qt::ForegroundRole,Qt::ToolTipRole,Qt::FontRole});
+    }
+    resetPending=blockPending=false;
+    pendingRemovals.clear();
+}
+
+void DanmuListModel::loadTo(int count)
+{
+    count=qMin(count,rows.count());
+    if(count<=loadedCount)return;
+    beginInsertRows(QModelIndex(),loadedCount,count-1);
+    loadedCount=count;
+    endInsertRows();
+}
+
+const DanmuListModel::FormattedRow *DanmuListModel::formatted(const DanmuComment *comment) const
+{
+    FormattedRow *row=formatCache.object(comment);
+    if(row)return row;
+    row=new FormattedRow;
+    int sec_total=comment->time/1000;
+    int min=sec_total/60;
+    int sec=sec_total-min*60;
+    row->time=QString("%1:%2").arg(min,2,10,QChar('0')).arg(sec,2,10,QChar('0'));
+    //translated in the context of DanmuPool, which used to be the model itself
+    static QString types[3]={QCoreApplication::translate("DanmuPool","Roll"),QCoreApplication::translate("DanmuPool","Top"),QCoreApplication::translate("DanmuPool","Bottom")};
+    row->toolTip=QCoreApplication::translate("DanmuPool","User: %1\nTime: %2\nText: %3\nType: %4%5").arg(comment->sender).
+            arg(QDateTime::fromSecsSinceEpoch(comment->date).toString("yyyy-MM-dd hh:mm:ss"))
+            .arg(comment->text).arg(types[comment->type])
+            .arg(comment->blockBy==-1?"":QCoreApplication::translate("DanmuPool","\nBlock By Rule:%1").arg(comment->blockBy));
+    if(comment->blockBy!=-1)
+        row->foreground=QBrush(QColor(150,150,150));
+    else
+        row->foreground=QBrush(QColor(comment->color>>16,(comment->color>>8)&0xff,comment->color&0xff,200));
+    formatCache.insert(comment,row);
+    return row;
+}
+
+QVariant DanmuListModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || index.row()>=loadedCount) return QVariant();
+    const DanmuComment *comment=rows.at(index.row()).data();
+    int col=index.column();
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    {
+        if(col==0)
+            return formatted(comment)->time;
+        else if(col==1)
+            return comment->text;
+        break;
+    }
+    case Qt::ForegroundRole:
+        return formatted(comment)->foreground;
+    case Qt::ToolTipRole:
+        return formatted(comment)->toolTip;
+    case Qt::FontRole:
+        if (comment->blockBy != -1 && col==1)
+        {
+            static QFont blockedFont("Microsoft YaHei UI", 11, -1, true);
+            return blockedFont;
+        }
+    default:
+        return QVariant();
+    }
+    return QVariant();
+}
+
+QVariant DanmuListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static QString headers[]={QCoreApplication::translate("DanmuPool","Time"),QCoreApplication::translate("DanmuPool","Content")};
+    if (role == Qt::DisplayRole&&orientation == Qt::Horizontal)
+    {
+        if(section<2)return headers[section];
+    }
+    return QVariant();
+}
+
+bool DanmuListModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && loadedCount<rows.count();
+}
+
+void DanmuListModel::fetchMore(const QModelIndex &parent)
+{
+    if(parent.isValid())return;
+    loadTo(loadedCount+fetchChunkSize);
+}
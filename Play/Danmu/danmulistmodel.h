@@ -0,0 +1,55 @@
+#ifndef DANMULISTMODEL_H
+#define DANMULISTMODEL_H
+
+#include <QAbstractItemModel>
+#include <QSharedPointer>
+#include <QBrush>
+#include <QCache>
+#include <QTimer>
+class DanmuPool;
+class DanmuComment;
+//View side of DanmuPool: rows are handed out in chunks through fetchMore, changes of the pool
+//are merged and applied at most once a frame, formatted text is only kept for rows the view asked for
+class DanmuListModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    explicit DanmuListModel(DanmuPool *pool,QObject *parent = nullptr);
+
+    //rows are those the view currently knows, pending changes of the pool are not visible yet
+    inline QSharedPointer<DanmuComment> getDanmu(int row) const {return row>=0 && row<loadedCount?rows.at(row):QSharedPointer<DanmuComment>();}
+    //applies pending changes and loads rows up to the current position of the pool
+    QModelIndex getCurrentIndex();
+private:
+    struct FormattedRow
+    {
+        QString time;
+        QString toolTip;
+        QBrush foreground;
+    };
+    DanmuPool *pool;
+    QList<QSharedPointer<DanmuComment> > rows;
+    int loadedCount;
+    bool resetPending,blockPending;
+    QList<QPair<int,int> > pendingRemovals;
+    QTimer flushTimer;
+    mutable QCache<const DanmuComment *,FormattedRow> formatCache;
+
+    void scheduleFlush();
+    void flush();
+    void loadTo(int count);
+    const FormattedRow *formatted(const DanmuComment *comment) const;
+
+    // QAbstractItemModel interface
+public:
+    inline virtual QModelIndex index(int row, int column, const QModelIndex &parent) const {return parent.isValid()?QModelIndex():createIndex(row,column);}
+    inline virtual QModelIndex parent(const QModelIndex &) const {return QModelIndex();}
+    inline virtual int rowCount(const QModelIndex &parent) const{return parent.isValid()?0:loadedCount;}
+    inline virtual int columnCount(const QModelIndex &parent) const {return parent.isValid()?0:2;}
+    virtual QVariant data(const QModelIndex &index, int role) const;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role) const;
+    virtual bool canFetchMore(const QModelIndex &parent) const;
+    virtual void fetchMore(const QModelIndex &parent);
+};
+
+#endif // DANMULISTMODEL_H
@@ -9,11 +9,13 @@
 #include "common.h"
 #include "globalobjects.h"
 #include "danmupool.h"
+#include "danmurefresher.h"
 PoolInfoWorker *DanmuManager::poolWorker=nullptr;
 DanmuManager::DanmuManager(QObject *parent) : QAbstractItemModel(parent)
 {
     poolWorker=new PoolInfoWorker();
     poolWorker->moveToThread(GlobalObjects::workThread);
+    refresher=new DanmuRefresher(this);
 }
 
 void DanmuManager::refreshPoolInfo()
@@ -73,6 +75,18 @@ void DanmuManager::deletePool(QModelIndexList &deleteIndexes)
     eventLoop.exec();
 }
 
+void DanmuManager::refreshPool(QModelIndexList &refreshIndexes)
+{
+    QStringList poolIDs;
+    for(const QModelIndex &index:refreshIndexes)
+    {
+        if(!index.isValid())continue;
+        poolIDs.append(poolList.at(index.row()).poolID);
+    }
+    if(poolIDs.count()==0) return;
+    refresher->refresh(poolIDs);
+}
+
 QVariant DanmuManager::data(const QModelIndex &index, int role) const
 {
     if(!index.isValid()) return QVariant();
@@ -234,6 +248,7 @@ void PoolInfoWorker::deletePool(const QList<DanmuPoolInfo> &deleteList)
     db.transaction();
     for(const DanmuPoolInfo &poolInfo:deleteList)
     {
+        DanmuPool::markDBChanged(poolInfo.poolID);
         query.bindValue(0,poolInfo.poolID);
         query.exec();
     }
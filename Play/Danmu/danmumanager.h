@@ -9,6 +9,7 @@ struct DanmuPoolInfo
     QString epTitle;
     int danmuCount;
 };
+class DanmuRefresher;
 class PoolInfoWorker : public QObject
 {
     Q_OBJECT
@@ -28,8 +29,10 @@ class DanmuManager : public QAbstractItemModel
     Q_OBJECT
 public:
     explicit DanmuManager(QObject *parent = nullptr);
+    inline DanmuRefresher *getRefresher(){return refresher;}
 private:
     QList<DanmuPoolInfo> poolList;
+    DanmuRefresher *refresher;
     static PoolInfoWorker *poolWorker;
 signals:
 
@@ -37,6 +40,7 @@ public slots:
     void refreshPoolInfo();
     void exportPool(QModelIndexList &exportIndexes, const QString &dir);
     void deletePool(QModelIndexList &deleteIndexes);
+    void refreshPool(QModelIndexList &refreshIndexes);
     // QAbstractItemModel interface
 public:
     inline virtual QModelIndex index(int row, int column, const QModelIndex &parent) const {return parent.isValid()?QModelIndex():createIndex(row,column);}
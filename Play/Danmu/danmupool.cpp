@@ -24,14 +24,27 @@ namespace
             return dm1->time<dm2->time;
         }
     } DanmuSPCompare;
+    const int maxResidentPools=8;
+    //SQLite allows 999 bound parameters in a statement
+    const int deleteBatchSize=500;
+    //beyond this many separate ranges the list is reported as reset instead
+    const int maxRemoveRanges=32;
+    qint64 nextLocalId=-1;
+    //bytes held by a comment besides its strings: the object, shared pointer control block and list node
+    const int danmuOverhead=sizeof(DanmuComment)+48;
 }
-DanmuPool::DanmuPool(QObject *parent) : QAbstractItemModel(parent),currentPosition(0),currentTime(0)
+QMutex DanmuPool::revisionLock;
+QHash<QString,int> DanmuPool::poolRevisions;
+int DanmuPool::allPoolsRevision=0;
+DanmuPool::DanmuPool(QObject *parent) : QObject(parent),currentPosition(0),currentTime(0),revision(0),
+    prefetchedSnapshot(nullptr)
 {
 
 }
 
-void DanmuPool::addDanmu(DanmuSourceInfo &sourceInfo,QList<DanmuComment *> &danmuList)
+void DanmuPool::addDanmu(DanmuSourceInfo &sourceInfo,QList<DanmuComment *> &danmuList,bool saveToDB)
 {
+    revision++;
     DanmuSourceInfo *source(nullptr);
     bool containSource=false;
     int maxId=0;
@@ -55,6 +68,7 @@ void DanmuPool::addDanmu(DanmuSourceInfo &sourceInfo,QList<DanmuComment *> &danm
         newSource.url=sourceInfo.url;
         newSource.name=sourceInfo.name;
         newSource.show=true;
+        newSource.lastDate=0;
         sourcesTable.insert(maxId,newSource);
 		source = &sourcesTable[maxId];
     }
@@ -73,28 +87,37 @@ void DanmuPool::addDanmu(DanmuSourceInfo &sourceInfo,QList<DanmuComment *> &danm
         int newTime = danmu->originTime + source->delay + delay;
         danmu->time = newTime>0?newTime:danmu->originTime;
         danmu->source=source->id;
+        if(danmu->date>source->lastDate)source->lastDate=danmu->date;
         danmuPool.append(QSharedPointer<DanmuComment>(danmu));
     }
     GlobalObjects::blocker->checkDanmu(danmuList);
-    saveDanmu(containSource?nullptr:source,&danmuList);
-    beginResetModel();
+    for(DanmuComment *danmu:danmuList)
+    {
+        if(danmu->blockBy==-1)density.add(danmu->time);
+    }
+    if(saveToDB)saveDanmu(source,&danmuList,!containSource);
+    for(DanmuComment *danmu:danmuList)
+    {
+        if(danmu->id==0)danmu->id=nextLocalId--;
+    }
     std::sort(danmuPool.begin(),danmuPool.end(),DanmuSPCompare);
-    endResetModel();
+    emit danmuReset();
 	currentPosition = std::lower_bound(danmuPool.begin(), danmuPool.end(), currentTime, DanmuComparer) - danmuPool.begin();
-    setStatisInfo();
+    emit statisInfoChange();
 }
 
 void DanmuPool::deleteSource(int sourceIndex)
 {
+    revision++;
     if(!sourcesTable.contains(sourceIndex))return;
     sourcesTable.remove(sourceIndex);
     QCoreApplication::processEvents();
-    beginResetModel();
     for(auto iter=danmuPool.begin();iter!=danmuPool.end();)
     {
         if((*iter)->source==sourceIndex)
         {
             //delete *iter;
+            if((*iter)->blockBy==-1)density.remove((*iter)->time);
             iter=danmuPool.erase(iter);
         }
         else
@@ -102,28 +125,72 @@ void DanmuPool::deleteSource(int sourceIndex)
             ++iter;
         }
     }
-    endResetModel();
+    emit danmuReset();
     mediaTimeJumped(currentTime);
     if(!poolID.isEmpty())
     {
+        markDBChanged(poolID);
         QSqlQuery query(QSqlDatabase::database("MT"));
         query.exec(QString("delete from danmu where PoolID='%1' and Source=%2").arg(poolID).arg(sourceIndex));
         query.exec(QString("delete from source where PoolID='%1' and ID=%2").arg(poolID).arg(sourceIndex));
     }
-    setStatisInfo();
+    emit statisInfoChange();
 }
 
 void DanmuPool::loadDanmuFromDB()
 {
+    revision++;
     if(poolID.isEmpty())return;
-    QSqlQuery query(QSqlDatabase::database("MT"));
-    query.exec(QString("select * from source where PoolID='%1'").arg(poolID));
+    PoolSnapshot *snapshot=takeResident(poolID);
+    bool resident=snapshot!=nullptr,prefetched=false;
+    if(!resident)
+    {
+        snapshot=prefetchedSnapshot;
+        prefetchedSnapshot=nullptr;
+        prefetched=snapshot && snapshot->poolID==poolID && snapshot->dbRevision==poolDBRevision(poolID);
+        if(!prefetched)
+        {
+            delete snapshot;
+            snapshot=loadSnapshot(poolID,"MT");
+        }
+    }
+    //qDeleteAll(danmuPool);
+    sourcesTable.swap(snapshot->sources);
+    danmuPool.swap(snapshot->danmuList);
+    emit danmuReset();
+    bool recheck=snapshot->blockRevision!=GlobalObjects::blocker->getRevision();
+    if(recheck)
+    {
+        for(QSharedPointer<DanmuComment> &danmu:danmuPool)
+            danmu->blockBy=-1;
+        GlobalObjects::blocker->checkDanmu(danmuPool);
+    }
+    if(resident && !recheck)
+        density=snapshot->density;
+    else
+        density.reset(danmuPool);
+    emit statisInfoChange();
+    if(resident)
+        mediaTimeJumped(currentTime);
+    delete snapshot;
+}
+
+PoolSnapshot *DanmuPool::loadSnapshot(const QString &pid, const QString &connection)
+{
+    PoolSnapshot *snapshot=new PoolSnapshot;
+    snapshot->poolID=pid;
+    snapshot->blockRevision=-1;
+    snapshot->dbRevision=poolDBRevision(pid);
+    snapshot->memoryUsage=0;
+    QHash<int,DanmuSourceInfo> &sourcesTable=snapshot->sources;
+    QSqlQuery query(QSqlDatabase::database(connection));
+    query.exec(QString("select * from source where PoolID='%1'").arg(pid));
     int idNo = query.record().indexOf("ID"),
         nameNo=query.record().indexOf("Name"),
         delayNo=query.record().indexOf("Delay"),
         urlNo=query.record().indexOf("URL"),
-        timelineNo=query.record().indexOf("TimeLine");
-    sourcesTable.clear();
+        timelineNo=query.record().indexOf("TimeLine"),
+        lastDateNo=query.record().indexOf("LastDate");
     while (query.next())
     {
         DanmuSourceInfo sourceInfo;
@@ -133,6 +200,7 @@ void DanmuPool::loadDanmuFromDB()
         sourceInfo.url=query.value(urlNo).toString();
         sourceInfo.show=true;
         sourceInfo.count=0;
+        sourceInfo.lastDate=query.value(lastDateNo).toLongLong();
         QStringList timelineList(query.value(timelineNo).toString().split(';',QString::SkipEmptyParts));
         QTextStream ts;
         for(QString &spaceInfo:timelineList)
@@ -147,7 +215,7 @@ void DanmuPool::loadDanmuFromDB()
         });
         sourcesTable.insert(sourceInfo.id,sourceInfo);
     }
-    query.exec(QString("select * from danmu where PoolID='%1'").arg(poolID));
+    query.exec(QString("select rowid,* from danmu where PoolID='%1'").arg(pid));
     int timeNo = query.record().indexOf("Time"),
         dateNo=query.record().indexOf("Date"),
         colorNo=query.record().indexOf("Color"),
@@ -156,9 +224,6 @@ void DanmuPool::loadDanmuFromDB()
         sourceNo=query.record().indexOf("Source"),
         userNo=query.record().indexOf("User"),
         textNo=query.record().indexOf("Text");
-    beginResetModel();
-    //qDeleteAll(danmuPool);
-    danmuPool.clear();
     while (query.next())
     {
         DanmuComment *danmu=new DanmuComment();
@@ -170,83 +235,271 @@ void DanmuPool::loadDanmuFromDB()
         danmu->source=query.value(sourceNo).toInt();
         danmu->text=query.value(textNo).toString();
         danmu->originTime=query.value(timeNo).toInt();
+        danmu->id=query.value(0).toLongLong();
         int delay=0;
         if(sourcesTable.contains(danmu->source))
         {
-            for(auto &spaceItem:sourcesTable[danmu->source].timelineInfo)
+            DanmuSourceInfo &sourceInfo=sourcesTable[danmu->source];
+            for(auto &spaceItem:sourceInfo.timelineInfo)
             {
                 if(danmu->originTime>spaceItem.first)delay+=spaceItem.second;
                 else break;
             }
-            delay+=sourcesTable[danmu->source].delay;
-            sourcesTable[danmu->source].count++;
+            delay+=sourceInfo.delay;
+            sourceInfo.count++;
+            if(danmu->date>sourceInfo.lastDate)sourceInfo.lastDate=danmu->date;
         }
         danmu->time=danmu->originTime+delay<0?danmu->originTime:danmu->originTime+delay;
-        danmuPool.append(QSharedPointer<DanmuComment>(danmu));
+        snapshot->danmuList.append(QSharedPointer<DanmuComment>(danmu));
     }
-    std::sort(danmuPool.begin(),danmuPool.end(),DanmuSPCompare);
-    endResetModel();
-    GlobalObjects::blocker->checkDanmu(danmuPool);
-    setStatisInfo();
+    std::sort(snapshot->danmuList.begin(),snapshot->danmuList.end(),DanmuSPCompare);
+    return snapshot;
+}
+
+void DanmuPool::setPrefetchedSnapshot(PoolSnapshot *snapshot)
+{
+    if(prefetchedSnapshot)delete prefetchedSnapshot;
+    prefetchedSnapshot=snapshot;
+}
+
+void DanmuPool::markDBChanged(const QString &pid)
+{
+    QMutexLocker locker(&revisionLock);
+    if(pid.isEmpty())
+        allPoolsRevision++;
+    else
+        poolRevisions[pid]++;
+}
+
+int DanmuPool::poolDBRevision(const QString &pid)
+{
+    QMutexLocker locker(&revisionLock);
+    return allPoolsRevision+poolRevisions.value(pid,0);
+}
+
+void DanmuPool::keepResident()
+{
+    if(poolID.isEmpty() || danmuPool.isEmpty())return;
+    qint64 budget=GlobalObjects::appSetting->value("Play/PoolCacheSize",128).toLongLong()*1024*1024;
+    if(budget<=0)
+    {
+        qDeleteAll(residentPools);
+        residentPools.clear();
+        return;
+    }
+    PoolSnapshot *snapshot=new PoolSnapshot;
+    snapshot->poolID=poolID;
+    snapshot->sources.swap(sourcesTable);
+    snapshot->danmuList.swap(danmuPool);
+    snapshot->blockRevision=GlobalObjects::blocker->getRevision();
+    //the pool was in sync with the database after its own writes
+    snapshot->dbRevision=poolDBRevision(poolID);
+    snapshot->density=density;
+    snapshot->memoryUsage=0;
+    for(const QSharedPointer<DanmuComment> &danmu:snapshot->danmuList)
+        snapshot->memoryUsage+=danmuOverhead+(danmu->text.size()+danmu->sender.size())*sizeof(QChar);
+    residentPools.prepend(snapshot);
+    qint64 totalUsage=0;
+    for(auto iter=residentPools.begin();iter!=residentPools.end();)
+    {
+        totalUsage+=(*iter)->memoryUsage;
+        if(iter-residentPools.begin()>=maxResidentPools || totalUsage>budget)
+        {
+            totalUsage-=(*iter)->memoryUsage;
+            delete *iter;
+            iter=residentPools.erase(iter);
+        }
+        else
+            ++iter;
+    }
+#ifdef QT_DEBUG
+    qDebug()<<"pool:keep resident:"<<poolID<<", pools:"<<residentPools.count()<<", memory:"<<totalUsage/1024<<"KB";
+#endif
+}
+
+PoolSnapshot *DanmuPool::takeResident(const QString &pid)
+{
+    for(int i=0;i<residentPools.count();++i)
+    {
+        if(residentPools.at(i)->poolID!=pid)continue;
+        PoolSnapshot *snapshot=residentPools.takeAt(i);
+        //sources or comments were changed by someone else since
+        if(snapshot->dbRevision==poolDBRevision(pid))
+            return snapshot;
+        delete snapshot;
+        break;
+    }
+    return nullptr;
 }
 
 void DanmuPool::cleanUp()
 {
+    revision++;
+    keepResident();
 	sourcesTable.clear();
-	beginResetModel();
 	danmuPool.clear();
-	endResetModel();
+    emit danmuReset();
     poolID=QString();
 	reset();
-    setStatisInfo();
+    density.clear();
+    emit statisInfoChange();
 }
 
 void DanmuPool::testBlockRule(BlockRule *rule)
 {
+    revision++;
     for(QSharedPointer<DanmuComment> &danmu:danmuPool)
     {
         if(danmu->blockBy==-1)
         {
             if(rule->blockTest(danmu.data()))
+            {
                 danmu->blockBy=rule->id;
+                density.remove(danmu->time);
+            }
         }
         else if(danmu->blockBy==rule->id)
         {
             if(!rule->blockTest(danmu.data()))
+            {
                 danmu->blockBy=-1;
+                density.add(danmu->time);
+            }
         }
     }
+    emit blockStateChanged();
+    emit statisInfoChange();
     GlobalObjects::danmuRender->removeBlocked();
 }
 
-void DanmuPool::deleteDanmu(QSharedPointer<DanmuComment> &danmu)
+void DanmuPool::deleteDanmu(const QSet<qint64> &ids)
 {
-    if(!poolID.isEmpty())
+    if(ids.isEmpty())return;
+    revision++;
+    QList<qint64> savedIds;
+    for(qint64 id:ids)
     {
-        QSqlQuery query(QSqlDatabase::database("MT"));
-        query.exec(QString("delete from danmu where PoolID='%1' and Date=%2 and User='%3' and Text='%4' and Source=%5")
-                    .arg(poolID).arg(danmu->date).arg(danmu->sender).arg(danmu->text).arg(danmu->source));
-    }
-    sourcesTable[danmu->source].count--;
-	int row = danmuPool.indexOf(danmu);
-	beginRemoveRows(QModelIndex(), row, row);
-	danmuPool.removeOne(danmu);
-    endRemoveRows();
-    setStatisInfo();
+        if(id>0)savedIds.append(id);
+    }
+    if(!poolID.isEmpty() && !savedIds.isEmpty())
+    {
+        markDBChanged(poolID);
+        QSqlDatabase db=QSqlDatabase::database("MT");
+        db.transaction();
+        QSqlQuery query(db);
+        for(int i=0;i<savedIds.count();i+=deleteBatchSize)
+        {
+            int count=qMin(deleteBatchSize,savedIds.count()-i);
+            QStringList placeholders;
+            for(int j=0;j<count;++j)
+                placeholders.append("?");
+            query.prepare(QString("delete from danmu where PoolID=? and rowid in (%1)").arg(placeholders.join(',')));
+            query.bindValue(0,poolID);
+            for(int j=0;j<count;++j)
+                query.bindValue(j+1,savedIds.at(i+j));
+            query.exec();
+        }
+        db.commit();
+    }
+    QList<QPair<int,int> > ranges;
+    for(int i=0;i<danmuPool.count();++i)
+    {
+        const QSharedPointer<DanmuComment> &danmu=danmuPool.at(i);
+        if(!ids.contains(danmu->id))continue;
+        auto sourceIter=sourcesTable.find(danmu->source);
+        if(sourceIter!=sourcesTable.end())sourceIter->count--;
+        if(danmu->blockBy==-1)density.remove(danmu->time);
+        if(!ranges.isEmpty() && ranges.last().second==i-1)
+            ranges.last().second=i;
+        else
+            ranges.append(QPair<int,int>(i,i));
+    }
+    if(ranges.isEmpty())return;
+    if(ranges.count()>maxRemoveRanges)
+    {
+        danmuPool.erase(std::remove_if(danmuPool.begin(),danmuPool.end(),[&ids](const QSharedPointer<DanmuComment> &danmu){
+            return ids.contains(danmu->id);
+        }),danmuPool.end());
+        emit danmuReset();
+    }
+    else
+    {
+        //from the back, so the rows of earlier ranges stay valid
+        for(auto iter=ranges.crbegin();iter!=ranges.crend();++iter)
+        {
+            danmuPool.erase(danmuPool.begin()+(*iter).first,danmuPool.begin()+(*iter).second+1);
+            emit danmuRemoved((*iter).first,(*iter).second);
+        }
+    }
+    currentPosition = std::lower_bound(danmuPool.begin(), danmuPool.end(), currentTime, DanmuComparer) - danmuPool.begin();
+    emit statisInfoChange();
 }
 
-QSet<QString> DanmuPool::getDanmuHash(int sourceId)
+QSet<quint64> DanmuPool::getDanmuHash(int sourceId)
 {
-    QSet<QString> hashSet;
+    QSet<quint64> hashSet;
     for(QSharedPointer<DanmuComment> &danmu:danmuPool)
     {
         if(danmu->source==sourceId)
+            hashSet.insert(danmu->contentHash());
+    }
+    return hashSet;
+}
+
+void DanmuPool::dropKnownDanmu(QList<DanmuComment *> &danmuList, QSet<quint64> &hashSet)
+{
+    for(auto iter=danmuList.begin();iter!=danmuList.end();)
+    {
+        quint64 hash=(*iter)->contentHash();
+        if(hashSet.contains(hash))
         {
-            QByteArray hashData(QString("%0%1%2%3").arg(danmu->text).arg(danmu->originTime).arg(danmu->sender).arg(danmu->color).toUtf8());
-            QString danmuHash(QString(QCryptographicHash::hash(hashData,QCryptographicHash::Md5).toHex()));
-            hashSet.insert(danmuHash);
+            delete *iter;
+            iter=danmuList.erase(iter);
+        }
+        else
+        {
+            hashSet.insert(hash);
+            ++iter;
         }
     }
+}
+
+QSet<quint64> DanmuPool::loadDanmuHash(const QString &pid, int sourceId, const QString &connection)
+{
+    QSet<quint64> hashSet;
+    if(pid.isEmpty())return hashSet;
+    QSqlDatabase db=QSqlDatabase::database(connection);
+    QSqlQuery query(db);
+    query.prepare("select rowid,Hash,Time,User,Color,Text from danmu where PoolID=? and Source=?");
+    query.bindValue(0,pid);
+    query.bindValue(1,sourceId);
+    query.exec();
+    QList<QPair<qint64,quint64> > missingHash;
+    while(query.next())
+    {
+        if(query.value(1).isNull())
+        {
+            //rows saved before danmu.Hash existed
+            quint64 hash=DanmuComment::contentHash(query.value(5).toString(),query.value(2).toInt(),
+                                                   query.value(3).toString(),query.value(4).toInt());
+            missingHash.append(QPair<qint64,quint64>(query.value(0).toLongLong(),hash));
+            hashSet.insert(hash);
+        }
+        else
+            hashSet.insert(query.value(1).toULongLong());
+    }
+    if(!missingHash.isEmpty())
+    {
+        db.transaction();
+        query.prepare("update danmu set Hash=? where rowid=?");
+        for(auto &item:missingHash)
+        {
+            query.bindValue(0,(qint64)item.second);
+            query.bindValue(1,item.first);
+            query.exec();
+        }
+        db.commit();
+    }
     return hashSet;
 }
 
@@ -306,15 +559,25 @@ void DanmuPool::exportDanmu(int sourceId, const QString &fileName)
     danmuFile.close();
 }
 
-void DanmuPool::saveDanmu(const DanmuSourceInfo *sourceInfo, const QList<DanmuComment *> *danmuList)
+void DanmuPool::saveDanmu(const DanmuSourceInfo *sourceInfo, const QList<DanmuComment *> *danmuList, bool newSource)
 {
     if(poolID.isEmpty())return;
+    markDBChanged(poolID);
     QSqlDatabase db=QSqlDatabase::database("MT");
     db.transaction();
-    if(sourceInfo)
+    if(sourceInfo && !newSource)
+    {
+        QSqlQuery query(QSqlDatabase::database("MT"));
+        query.prepare("update source set LastDate=? where PoolID=? and ID=?");
+        query.bindValue(0,sourceInfo->lastDate);
+        query.bindValue(1,poolID);
+        query.bindValue(2,sourceInfo->id);
+        query.exec();
+    }
+    else if(sourceInfo)
     {
         QSqlQuery query(QSqlDatabase::database("MT"));
-        query.prepare("insert into source(PoolID,ID,Name,Delay,URL,TimeLine) values(?,?,?,?,?,?)");
+        query.prepare("insert into source(PoolID,ID,Name,Delay,URL,TimeLine,LastDate) values(?,?,?,?,?,?,?)");
         query.bindValue(0,poolID);
         query.bindValue(1,sourceInfo->id);
         query.bindValue(2,sourceInfo->name);
@@ -329,63 +592,62 @@ void DanmuPool::saveDanmu(const DanmuSourceInfo *sourceInfo, const QList<DanmuCo
         }
         ts.flush();
         query.bindValue(5,timelineInfo);
+        query.bindValue(6,sourceInfo->lastDate);
 
         query.exec();
     }
     if(danmuList)
     {
-
-        QSqlQuery query(QSqlDatabase::database("MT"));
-        query.prepare("insert into danmu(PoolID,Time,Date,Color,Mode,Size,Source,User,Text) values(?,?,?,?,?,?,?,?,?)");
-        for(DanmuComment *danmu:*danmuList)
-        {
-            query.bindValue(0,poolID);
-            query.bindValue(1,danmu->originTime);
-            query.bindValue(2,danmu->date);
-            query.bindValue(3,danmu->color);
-            query.bindValue(4,(int)danmu->type);
-            query.bindValue(5,(int)danmu->fontSizeLevel);
-            query.bindValue(6,danmu->source);
-            query.bindValue(7,danmu->sender);
-            query.bindValue(8,danmu->text);
-            query.exec();
-        }
+        insertDanmu(db,poolID,*danmuList);
     }
     db.commit();
 }
 
-void DanmuPool::setStatisInfo()
+void DanmuPool::insertDanmu(QSqlDatabase &db, const QString &pid, const QList<DanmuComment *> &danmuList)
 {
-    statisInfo.countOfMinute.clear();
-    statisInfo.maxCountOfMinute=0;
-    int curMinuteCount=0;
-    int startTime=0;
-    for(auto iter=danmuPool.cbegin();iter!=danmuPool.cend();++iter)
+    QSqlQuery query(db);
+    query.prepare("insert into danmu(PoolID,Time,Date,Color,Mode,Size,Source,User,Text,Hash) values(?,?,?,?,?,?,?,?,?,?)");
+    for(DanmuComment *danmu:danmuList)
     {
-        if(iter==danmuPool.cbegin())
-        {
-            startTime=(*iter)->time;
-        }
-        if((*iter)->time-startTime<1000)
-            curMinuteCount++;
-        else
-        {
-            statisInfo.countOfMinute.append(QPair<int,int>(startTime/1000,curMinuteCount));
-            if(curMinuteCount>statisInfo.maxCountOfMinute)
-                statisInfo.maxCountOfMinute=curMinuteCount;
-            curMinuteCount=1;
-            startTime=(*iter)->time;
-        }
+        query.bindValue(0,pid);
+        query.bindValue(1,danmu->originTime);
+        query.bindValue(2,danmu->date);
+        query.bindValue(3,danmu->color);
+        query.bindValue(4,(int)danmu->type);
+        query.bindValue(5,(int)danmu->fontSizeLevel);
+        query.bindValue(6,danmu->source);
+        query.bindValue(7,danmu->sender);
+        query.bindValue(8,danmu->text);
+        query.bindValue(9,(qint64)danmu->contentHash());
+        if(query.exec())danmu->id=query.lastInsertId().toLongLong();
     }
-	statisInfo.countOfMinute.append(QPair<int, int>(startTime / 1000, curMinuteCount));
-	if (curMinuteCount>statisInfo.maxCountOfMinute)
-		statisInfo.maxCountOfMinute = curMinuteCount;
-    emit statisInfoChange();
+}
 
+void DanmuPool::saveSourceDanmu(const QString &pid, int sourceId, QList<DanmuComment *> &danmuList, const QString &connection)
+{
+    markDBChanged(pid);
+    qint64 lastDate=0;
+    for(DanmuComment *danmu:danmuList)
+    {
+        danmu->source=sourceId;
+        if(danmu->date>lastDate)lastDate=danmu->date;
+    }
+    QSqlDatabase db=QSqlDatabase::database(connection);
+    db.transaction();
+    insertDanmu(db,pid,danmuList);
+    QSqlQuery query(db);
+    query.prepare("update source set LastDate=? where PoolID=? and ID=? and LastDate<?");
+    query.bindValue(0,lastDate);
+    query.bindValue(1,pid);
+    query.bindValue(2,sourceId);
+    query.bindValue(3,lastDate);
+    query.exec();
+    db.commit();
 }
 
 void DanmuPool::setDelay(DanmuSourceInfo *sourceInfo,int newDelay)
 {
+    revision++;
     if(sourceInfo->delay==newDelay)return;
     for(auto iter=danmuPool.begin();iter!=danmuPool.end();++iter)
     {
@@ -399,24 +661,27 @@ void DanmuPool::setDelay(DanmuSourceInfo *sourceInfo,int newDelay)
                 else break;
             }
             int newTime = cur->originTime + delay;
-            cur->time=newTime>0?newTime:cur->originTime;
+            newTime=newTime>0?newTime:cur->originTime;
+            if(cur->blockBy==-1)density.move(cur->time,newTime);
+            cur->time=newTime;
 		}
     }
     sourceInfo->delay=newDelay;
-    beginResetModel();
     std::sort(danmuPool.begin(),danmuPool.end(),DanmuSPCompare);
-    endResetModel();
+    emit danmuReset();
     currentPosition = std::lower_bound(danmuPool.begin(), danmuPool.end(), currentTime, DanmuComparer) - danmuPool.begin();
     if(!poolID.isEmpty())
     {
+        markDBChanged(poolID);
         QSqlQuery query(QSqlDatabase::database("MT"));
         query.exec(QString("update source set Delay= %1 where PoolID='%2' and ID=%3").arg(newDelay).arg(poolID).arg(sourceInfo->id));
     }
-    setStatisInfo();
+    emit statisInfoChange();
 }
 
 void DanmuPool::refreshTimeLineDelayInfo(DanmuSourceInfo *sourceInfo)
 {
+    revision++;
     for(auto iter=danmuPool.begin();iter!=danmuPool.end();++iter)
     {
         QSharedPointer<DanmuComment> cur = *iter;
@@ -429,15 +694,17 @@ void DanmuPool::refreshTimeLineDelayInfo(DanmuSourceInfo *sourceInfo)
                 else break;
             }
             int newTime = cur->originTime + delay + sourceInfo->delay;
-            cur->time=newTime>0?newTime:cur->originTime;
+            newTime=newTime>0?newTime:cur->originTime;
+            if(cur->blockBy==-1)density.move(cur->time,newTime);
+            cur->time=newTime;
         }
     }
-    beginResetModel();
     std::sort(danmuPool.begin(),danmuPool.end(),DanmuSPCompare);
-    endResetModel();
+    emit danmuReset();
     currentPosition = std::lower_bound(danmuPool.begin(), danmuPool.end(), currentTime, DanmuComparer) - danmuPool.begin();
     if(!poolID.isEmpty())
     {
+        markDBChanged(poolID);
         QSqlQuery query(QSqlDatabase::database("MT"));
         query.prepare("update source set TimeLine= ? where PoolID=? and ID=?");
         QString timelineInfo;
@@ -452,7 +719,7 @@ void DanmuPool::refreshTimeLineDelayInfo(DanmuSourceInfo *sourceInfo)
         query.bindValue(2,sourceInfo->id);
         query.exec();
     }
-    setStatisInfo();
+    emit statisInfoChange();
 }
 
 void DanmuPool::refreshCurrentPoolID()
@@ -514,64 +781,11 @@ void DanmuPool::mediaTimeJumped(int newTime)
     qDebug()<<"pool:media time jumped,newTime:"<<newTime<<",currentTime:"<<currentTime<<",currentPos"<<currentPosition;
 #endif
     currentTime=newTime;
-    currentPosition=std::lower_bound(danmuPool.begin(),danmuPool.end(),newTime,DanmuComparer)-danmuPool.begin();
+    //with a layout plan, comments still on screen at newTime are restored at their planned place
+    int lookback=GlobalObjects::danmuRender->planLookback();
+    currentPosition=std::lower_bound(danmuPool.begin(),danmuPool.end(),newTime-lookback,DanmuComparer)-danmuPool.begin();
     GlobalObjects::danmuRender->cleanup();
 #ifdef QT_DEBUG
     qDebug()<<"pool:media time jumped,currentPos"<<currentPosition;
 #endif
 }
-
-QVariant DanmuPool::data(const QModelIndex &index, int role) const
-{
-    if(!index.isValid()) return QVariant();
-    auto comment=danmuPool[index.row()];
-    int col=index.column();
-    switch (role)
-    {
-    case Qt::DisplayRole:
-    {
-        if(col==0)
-        {
-            int sec_total=comment->time/1000;
-            int min=sec_total/60;
-            int sec=sec_total-min*60;
-            return QString("%1:%2").arg(min,2,10,QChar('0')).arg(sec,2,10,QChar('0'));
-        }
-        else if(col==1)
-        {
-            return comment->text;
-        }
-        break;
-    }
-    case Qt::ForegroundRole:
-    {
-        if(comment->blockBy!=-1)
-            return QBrush(QColor(150,150,150));
-        return QBrush(QColor(comment->color>>16,(comment->color>>8)&0xff,comment->color&0xff,200));
-    }
-    case Qt::ToolTipRole:
-    {
-        static QString types[3]={tr("Roll"),tr("Top"),tr("Bottom")};
-        return tr("User: %1\nTime: %2\nText: %3\nType: %4%5").arg(comment->sender).
-                arg(QDateTime::fromSecsSinceEpoch(comment->date).toString("yyyy-MM-dd hh:mm:ss"))
-                .arg(comment->text).arg(types[comment->type])
-                .arg(comment->blockBy==-1?"":tr("\nBlock By Rule:%1").arg(comment->blockBy));
-    }
-	case Qt::FontRole:
-		if (comment->blockBy != -1 && col==1)
-			return QFont("Microsoft YaHei UI", 11, -1, true);
-    default:
-        return QVariant();
-    }
-	return QVariant();
-}
-
-QVariant DanmuPool::headerData(int section, Qt::Orientation orientation, int role) const
-{
-    static QString headers[]={tr("Time"),tr("Content")};
-    if (role == Qt::DisplayRole&&orientation == Qt::Horizontal)
-    {
-        if(section<2)return headers[section];
-    }
-    return QVariant();
-}
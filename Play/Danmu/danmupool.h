@@ -1,52 +1,95 @@
 #ifndef DANMUPOOL_H
 #define DANMUPOOL_H
 
-#include <QAbstractItemModel>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QMutex>
 #include "common.h"
+#include "danmudensity.h"
 struct StatisInfo
 {
     QList<QPair<int,int> > countOfMinute;
     int maxCountOfMinute;
 };
+struct PoolSnapshot
+{
+    QString poolID;
+    QHash<int,DanmuSourceInfo> sources;
+    QList<QSharedPointer<DanmuComment> > danmuList;
+    int blockRevision; //-1: not checked against block rules
+    int dbRevision; //see DanmuPool::poolDBRevision
+    DanmuDensity density; //kept for resident pools only
+    qint64 memoryUsage;
+};
 struct SimpleDanmuInfo
 {
     int time;
     int originTime;
     QString text;
 };
-class DanmuPool : public QAbstractItemModel
+class DanmuPool : public QObject
 {
     Q_OBJECT
 public:
     explicit DanmuPool(QObject *parent = nullptr);
-    ~DanmuPool(){qDeleteAll(prepareListPool);}
+    ~DanmuPool(){qDeleteAll(prepareListPool);qDeleteAll(residentPools);if(prefetchedSnapshot)delete prefetchedSnapshot;}
 
     inline QString getPoolID() const { return poolID; }
     inline QSharedPointer<DanmuComment> &getDanmu(int row){return danmuPool[row];}
-    inline QModelIndex getCurrentIndex(){return (currentPosition >= 0 && currentPosition < danmuPool.count())?createIndex(currentPosition, 0):QModelIndex();}
+    inline const QList<QSharedPointer<DanmuComment> > &getDanmuList() const {return danmuPool;}
+    inline int getCurrentPosition() const {return (currentPosition >= 0 && currentPosition < danmuPool.count())?currentPosition:-1;}
     inline QHash<int,DanmuSourceInfo> &getSources(){return sourcesTable;}
     inline void recyclePrepareList(PrepareList *list){list->clear();prepareListPool.append(list);}
     inline bool isEmpty() const{return danmuPool.isEmpty();}
     inline int totalCount() const {return danmuPool.count();}
-    inline const StatisInfo &getStatisInfo(){return statisInfo;}
+    inline const DanmuDensity &getDensity() const {return density;}
+    //unblocked comments in [t1,t2] ms
+    inline int rangeCount(int t1,int t2) const {return density.rangeCount(t1,t2);}
     inline void reset(){currentTime=0;currentPosition=0;}
+    inline int getCurrentTime() const {return currentTime;}
+    //bumped whenever comments, sources, delays or block states change
+    inline int getRevision() const {return revision;}
+    inline void markChanged(){revision++;}
 
-    void addDanmu(DanmuSourceInfo &sourceInfo,QList<DanmuComment *> &danmuList);
-    void deleteDanmu(QSharedPointer<DanmuComment> &danmu);
+    void addDanmu(DanmuSourceInfo &sourceInfo,QList<DanmuComment *> &danmuList,bool saveToDB=true);
+    //removes the comments with these ids from the pool and the database in one pass
+    void deleteDanmu(const QSet<qint64> &ids);
     void deleteSource(int sourceIndex);
     void loadDanmuFromDB();	
-    QSet<QString> getDanmuHash(int sourceId);
+    //sorted comments of a pool with delays applied, safe to build on any thread with its own connection
+    static PoolSnapshot *loadSnapshot(const QString &pid,const QString &connection);
+    //used by the next loadDanmuFromDB if nothing was written to its pool since it was built
+    void setPrefetchedSnapshot(PoolSnapshot *snapshot);
+    //call it before writing comments or sources of a pool, an empty pid stands for all pools
+    static void markDBChanged(const QString &pid=QString());
+    static int poolDBRevision(const QString &pid);
+    QSet<quint64> getDanmuHash(int sourceId);
+    //reads the persisted per-source dedup index, call it on the work thread("WT" connection)
+    static QSet<quint64> loadDanmuHash(const QString &pid,int sourceId,const QString &connection="WT");
+    //deletes comments whose hash is in hashSet, the kept ones are added to it
+    static void dropKnownDanmu(QList<DanmuComment *> &danmuList,QSet<quint64> &hashSet);
+    //appends comments to a saved source in one transaction
+    static void saveSourceDanmu(const QString &pid,int sourceId,QList<DanmuComment *> &danmuList,const QString &connection);
     QList<SimpleDanmuInfo> getSimpleDanmuInfo(int sourceId);
 private:
     QList<QSharedPointer<DanmuComment> > danmuPool;
     QHash<int,DanmuSourceInfo> sourcesTable;
     QList<PrepareList *> prepareListPool;
-    StatisInfo statisInfo;
+    DanmuDensity density;
     int currentPosition;
     int currentTime;
+    int revision;
     QString poolID;
-    void saveDanmu(const DanmuSourceInfo *sourceInfo,const QList<DanmuComment *> *danmuList);
-    void setStatisInfo();
+    PoolSnapshot *prefetchedSnapshot;
+    //pools played recently, most recent first, switching back to them skips the database
+    QList<PoolSnapshot *> residentPools;
+    static QMutex revisionLock;
+    static QHash<QString,int> poolRevisions;
+    static int allPoolsRevision;
+    void keepResident();
+    PoolSnapshot *takeResident(const QString &pid);
+    void saveDanmu(const DanmuSourceInfo *sourceInfo,const QList<DanmuComment *> *danmuList,bool newSource=true);
+    static void insertDanmu(QSqlDatabase &db,const QString &pid,const QList<DanmuComment *> &danmuList);
 public:
     void setDelay(DanmuSourceInfo *sourceInfo,int newDelay);
     void refreshTimeLineDelayInfo(DanmuSourceInfo *sourceInfo);
@@ -58,18 +101,15 @@ public:
 
 signals:
     void statisInfoChange();
+    //the list was replaced or reordered
+    void danmuReset();
+    //rows [first,last] were removed, ranges of one deletion come from the back
+    void danmuRemoved(int first,int last);
+    void blockStateChanged();
 public slots:
     void mediaTimeElapsed(int newTime);
     void mediaTimeJumped(int newTime);
 
-    // QAbstractItemModel interface
-public:
-    inline virtual QModelIndex index(int row, int column, const QModelIndex &parent) const {return parent.isValid()?QModelIndex():createIndex(row,column);}
-    inline virtual QModelIndex parent(const QModelIndex &) const {return QModelIndex();}
-    inline virtual int rowCount(const QModelIndex &parent) const{return parent.isValid()?0:danmuPool.count();}
-    inline virtual int columnCount(const QModelIndex &parent) const {return parent.isValid()?0:2;}
-    virtual QVariant data(const QModelIndex &index, int role) const;
-    virtual QVariant headerData(int section, Qt::Orientation orientation, int role) const;
 };
 
 #endif // DANMUPOOL_H
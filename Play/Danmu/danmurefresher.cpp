@@ -0,0 +1,261 @@
+#include "danmurefresher.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QThread>
+#include "globalobjects.h"
+#include "danmupool.h"
+#include "providermanager.h"
+#include "Provider/providerbase.h"
+namespace
+{
+    struct ProviderLimit
+    {
+        const char *providerId;
+        int maxWorkers;
+        int minInterval; //ms between the start of two sources
+    };
+    const ProviderLimit providerLimits[]=
+    {
+        {"Bilibili",2,500},
+        {"Iqiyi",2,500},
+        {"Acfun",1,1000},
+        {"Dandan",1,1000}
+    };
+    const ProviderLimit defaultLimit={"",1,1500};
+    const ProviderLimit &getLimit(const QString &providerId)
+    {
+        for(const ProviderLimit &limit:providerLimits)
+        {
+            if(providerId==limit.providerId) return limit;
+        }
+        return defaultLimit;
+    }
+}
+
+void RefreshWorker::run()
+{
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE",connection);
+        database.setDatabaseName(QCoreApplication::applicationDirPath()+"\\kikoplay.db");
+        database.open();
+        QSqlQuery query(database);
+        query.exec("PRAGMA foreign_keys = ON;");
+    }
+    ProviderBase *provider=GlobalObjects::providerManager->createProvider(queue->providerId);
+    if(provider)
+    {
+        runTasks(provider);
+        delete provider;
+    }
+    QSqlDatabase::removeDatabase(connection);
+    emit finished();
+}
+
+void RefreshWorker::runTasks(ProviderBase *provider)
+{
+    while(!refresher->isCanceled())
+    {
+        RefreshTask task;
+        qint64 wait;
+        {
+            QMutexLocker locker(&queue->lock);
+            if(queue->tasks.isEmpty()) break;
+            task=queue->tasks.takeFirst();
+            qint64 now=queue->clock.elapsed();
+            qint64 start=qMax(now,queue->nextStart);
+            queue->nextStart=start+queue->minInterval;
+            wait=start-now;
+        }
+        for(;wait>0 && !refresher->isCanceled();wait-=100)
+            QThread::msleep(qMin<qint64>(wait,100));
+        //an unfinished task stays pending and is picked up again by resume
+        if(refresher->isCanceled()) break;
+        QList<DanmuComment *> danmuList;
+        QString errInfo=updateSource(provider,task,connection,danmuList);
+        DanmuRefresher *refresher=this->refresher;
+        QMetaObject::invokeMethod(refresher,[refresher,task,danmuList,errInfo](){
+            refresher->taskDone(task,danmuList,errInfo);
+        },Qt::QueuedConnection);
+    }
+}
+
+QString RefreshWorker::updateSource(ProviderBase *provider, const RefreshTask &task, const QString &connection, QList<DanmuComment *> &danmuList)
+{
+    QString errInfo=provider->updateBySourceURL(task.url,task.lastDate,danmuList);
+    if(!errInfo.isEmpty())
+    {
+        qDeleteAll(danmuList);
+        danmuList.clear();
+    }
+    else if(!danmuList.isEmpty())
+    {
+        QSet<quint64> hashSet(DanmuPool::loadDanmuHash(task.poolID,task.sourceId,connection));
+        DanmuPool::dropKnownDanmu(danmuList,hashSet);
+        if(!danmuList.isEmpty())
+            DanmuPool::saveSourceDanmu(task.poolID,task.sourceId,danmuList,connection);
+    }
+    return errInfo;
+}
+
+DanmuRefresher::DanmuRefresher(QObject *parent) : QObject(parent),canceled(0),
+    total(0),done(0),failed(0),newDanmu(0),runningWorkers(0)
+{
+    pendingTasks=GlobalObjects::appSetting->value("DanmuRefresh/Pending").toStringList().toSet();
+}
+
+DanmuRefresher::~DanmuRefresher()
+{
+    if(!isRunning()) return;
+    canceled=1;
+    for(QThread *thread:threads)
+    {
+        thread->wait();
+        delete thread;
+    }
+    qDeleteAll(queues);
+}
+
+void DanmuRefresher::refresh(const QStringList &poolIDs)
+{
+    if(isRunning()) return;
+    QSet<QString> poolSet(poolIDs.toSet());
+    QList<RefreshTask> taskList;
+    QSqlQuery query(QSqlDatabase::database("MT"));
+    query.exec("select PoolID,ID,URL,LastDate from source");
+    while(query.next())
+    {
+        QString poolID(query.value(0).toString());
+        if(!poolSet.contains(poolID)) continue;
+        taskList.append({poolID,query.value(1).toInt(),query.value(2).toString(),query.value(3).toLongLong()});
+    }
+    start(taskList);
+}
+
+void DanmuRefresher::resume()
+{
+    if(isRunning() || pendingTasks.isEmpty()) return;
+    QList<RefreshTask> taskList;
+    QSqlQuery query(QSqlDatabase::database("MT"));
+    query.exec("select PoolID,ID,URL,LastDate from source");
+    while(query.next())
+    {
+        QString poolID(query.value(0).toString());
+        int sourceId=query.value(1).toInt();
+        if(!pendingTasks.contains(taskKey(poolID,sourceId))) continue;
+        taskList.append({poolID,sourceId,query.value(2).toString(),query.value(3).toLongLong()});
+    }
+    start(taskList);
+}
+
+void DanmuRefresher::stop()
+{
+    canceled=1;
+}
+
+void DanmuRefresher::start(QList<RefreshTask> &taskList)
+{
+    canceled=0;
+    total=0;
+    done=failed=newDanmu=0;
+    pendingTasks.clear();
+    QHash<QString,RefreshQueue *> queueHash;
+    for(RefreshTask &task:taskList)
+    {
+        QString providerId(GlobalObjects::providerManager->getProviderId(task.url));
+        if(providerId.isEmpty()) continue;
+        RefreshQueue *queue=queueHash.value(providerId,nullptr);
+        if(!queue)
+        {
+            queue=new RefreshQueue;
+            queue->providerId=providerId;
+            queue->nextStart=0;
+            queue->clock.start();
+            queueHash.insert(providerId,queue);
+            queues.append(queue);
+        }
+        queue->tasks.append(task);
+        pendingTasks.insert(taskKey(task.poolID,task.sourceId));
+        total++;
+    }
+    savePending();
+    if(queues.isEmpty()) return;
+    QSettings *setting=GlobalObjects::appSetting;
+    setting->beginGroup("DanmuRefresh");
+    int connectionNo=0;
+    for(RefreshQueue *queue:queues)
+    {
+        const ProviderLimit &limit=getLimit(queue->providerId);
+        queue->minInterval=setting->value(queue->providerId+"/Interval",limit.minInterval).toInt();
+        int workers=qBound(1,setting->value(queue->providerId+"/Workers",limit.maxWorkers).toInt(),queue->tasks.count());
+        for(int i=0;i<workers;++i)
+        {
+            QThread *thread=new QThread();
+            thread->setObjectName(QString("refresh%1-%2").arg(queue->providerId).arg(i));
+            RefreshWorker *worker=new RefreshWorker(this,queue,QString("RF%1").arg(connectionNo++));
+            worker->moveToThread(thread);
+            QObject::connect(thread,&QThread::started,worker,&RefreshWorker::run);
+            QObject::connect(worker,&RefreshWorker::finished,thread,&QThread::quit);
+            QObject::connect(thread,&QThread::finished,worker,&QObject::deleteLater);
+            QObject::connect(thread,&QThread::finished,this,&DanmuRefresher::workerFinished);
+            threads.append(thread);
+        }
+    }
+    setting->endGroup();
+    runningWorkers=threads.count();
+    for(QThread *thread:threads)
+        thread->start(QThread::LowPriority);
+#ifdef QT_DEBUG
+    qDebug()<<"refresh: sources:"<<total<<", providers:"<<queues.count()<<", workers:"<<runningWorkers;
+#endif
+    emit progress(done,total,newDanmu,failed);
+}
+
+void DanmuRefresher::taskDone(const RefreshTask &task, QList<DanmuComment *> danmuList, const QString &errInfo)
+{
+    done++;
+    if(errInfo.isEmpty())
+        pendingTasks.remove(taskKey(task.poolID,task.sourceId));
+    else
+        failed++;
+    newDanmu+=danmuList.count();
+    DanmuPool *danmuPool=GlobalObjects::danmuPool;
+    if(!danmuList.isEmpty() && task.poolID==danmuPool->getPoolID() && danmuPool->getSources().contains(task.sourceId))
+    {
+        //already saved by the worker, the pool may have been loaded before or after that
+        QSet<quint64> hashSet(danmuPool->getDanmuHash(task.sourceId));
+        DanmuPool::dropKnownDanmu(danmuList,hashSet);
+        if(!danmuList.isEmpty())
+        {
+            DanmuSourceInfo si;
+            si.count=danmuList.count();
+            si.url=task.url;
+            danmuPool->addDanmu(si,danmuList,false);
+        }
+    }
+    else
+    {
+        qDeleteAll(danmuList);
+    }
+    if(done%20==0) savePending();
+    emit progress(done,total,newDanmu,failed);
+}
+
+void DanmuRefresher::workerFinished()
+{
+    if(--runningWorkers>0) return;
+    for(QThread *thread:threads)
+        thread->deleteLater();
+    threads.clear();
+    qDeleteAll(queues);
+    queues.clear();
+    savePending();
+#ifdef QT_DEBUG
+    qDebug()<<"refresh: done:"<<done<<"/"<<total<<", new:"<<newDanmu<<", failed:"<<failed;
+#endif
+    emit finished(isCanceled());
+}
+
+void DanmuRefresher::savePending()
+{
+    GlobalObjects::appSetting->setValue("DanmuRefresh/Pending",QStringList(pendingTasks.toList()));
+}
@@ -0,0 +1,77 @@
+#ifndef DANMUREFRESHER_H
+#define DANMUREFRESHER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QElapsedTimer>
+#include "common.h"
+class ProviderBase;
+struct RefreshTask
+{
+    QString poolID;
+    int sourceId;
+    QString url;
+    qint64 lastDate;
+};
+struct RefreshQueue
+{
+    QString providerId;
+    int minInterval;
+    QMutex lock;
+    QList<RefreshTask> tasks;
+    QElapsedTimer clock;
+    qint64 nextStart;
+};
+class DanmuRefresher;
+class RefreshWorker : public QObject
+{
+    Q_OBJECT
+public:
+    RefreshWorker(DanmuRefresher *refresher,RefreshQueue *queue,const QString &connection):
+        QObject(nullptr),refresher(refresher),queue(queue),connection(connection){}
+    //download, drop known comments and save the rest, new comments are left in danmuList
+    static QString updateSource(ProviderBase *provider,const RefreshTask &task,const QString &connection,QList<DanmuComment *> &danmuList);
+public slots:
+    void run();
+signals:
+    void finished();
+private:
+    DanmuRefresher *refresher;
+    RefreshQueue *queue;
+    QString connection;
+    void runTasks(ProviderBase *provider);
+};
+class DanmuRefresher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DanmuRefresher(QObject *parent = nullptr);
+    ~DanmuRefresher();
+
+    inline bool isRunning() const {return !threads.isEmpty();}
+    inline bool hasPending() const {return !pendingTasks.isEmpty();}
+    inline bool isCanceled() const {return canceled.load()!=0;}
+
+    void refresh(const QStringList &poolIDs);
+    void resume();
+    void stop();
+signals:
+    void progress(int done,int total,int newDanmu,int failed);
+    void finished(bool canceled);
+private:
+    friend class RefreshWorker;
+    QList<QThread *> threads;
+    QList<RefreshQueue *> queues;
+    QSet<QString> pendingTasks;
+    QAtomicInt canceled;
+    int total,done,failed,newDanmu;
+    int runningWorkers;
+
+    void start(QList<RefreshTask> &taskList);
+    void taskDone(const RefreshTask &task,QList<DanmuComment *> danmuList,const QString &errInfo);
+    void workerFinished();
+    void savePending();
+    static inline QString taskKey(const QString &poolID,int sourceId){return QString("%1:%2").arg(poolID).arg(sourceId);}
+};
+
+#endif // DANMUREFRESHER_H
@@ -4,6 +4,7 @@
 #include "Layouts/bottomlayout.h"
 #include <QPair>
 #include <QRandomGenerator>
+#include <algorithm>
 #include "globalobjects.h"
 #include "Play/Danmu/danmupool.h"
 #include "Play/Playlist/playlist.h"
@@ -11,6 +12,31 @@ namespace
 {
     QOpenGLContext *danmuTextureContext=nullptr;
     QSurface *surface=nullptr;
+    const int minAdmitLimit=20;
+    const qint64 densityWindow=5000;
+    const int maxPlanCache=4;
+    const char *vShaderDanmu =
+            "attribute mediump vec4 a_VtxCoord;\n"
+            "attribute mediump vec2 a_TexCoord;\n"
+            "varying mediump vec2 v_vTexCoord;\n"
+            "void main(void)\n"
+            "{\n"
+            "    gl_Position = a_VtxCoord;\n"
+            "    v_vTexCoord = a_TexCoord;\n"
+            "}\n";
+
+    const char *fShaderDanmu =
+            "#ifdef GL_ES\n"
+            "precision lowp float;\n"
+            "#endif\n"
+            "varying mediump vec2 v_vTexCoord;\n"
+            "uniform sampler2D u_SamplerD;\n"
+            "uniform float alpha;\n"
+            "void main(void)\n"
+            "{\n"
+            "    gl_FragColor.rgba = texture2D(u_SamplerD, v_vTexCoord).bgra;\n"
+            "    gl_FragColor.a *= alpha;\n"
+            "}\n";
 }
 DanmuRender::DanmuRender()
 {
@@ -31,7 +57,6 @@ DanmuRender::DanmuRender()
     danmuStyle.fontFamily="Microsoft YaHei";
     danmuStyle.randomSize=false;
 	danmuStyle.bold = false;
-    QObject::connect(GlobalObjects::mpvplayer,&MPVPlayer::resized,this,&DanmuRender::refreshDMRect);
 
     cacheWorker=new CacheWorker(&danmuStyle);
     cacheWorker->moveToThread(&cacheThread);
@@ -46,17 +71,51 @@ DanmuRender::DanmuRender()
     cacheThread.setObjectName(QStringLiteral("cacheThread"));
     cacheThread.start(QThread::NormalPriority);
 
-    QObject::connect(GlobalObjects::mpvplayer,&MPVPlayer::initContext,[this](){
-        QOpenGLContext *sharectx = GlobalObjects::mpvplayer->context();
-        surface = sharectx->surface();
-
-        danmuTextureContext = new QOpenGLContext();
-        danmuTextureContext->setFormat(sharectx->format());
-        danmuTextureContext->setShareContext(sharectx);
-        danmuTextureContext->create();
-        danmuTextureContext->moveToThread(&cacheThread);
+    rollSpeed=200;
+    qRegisterMetaType<LayoutPlan *>("LayoutPlan*");
+    planner=new LayoutPlanner();
+    planner->moveToThread(&planThread);
+    QObject::connect(&planThread, &QThread::finished, planner, &QObject::deleteLater);
+    QObject::connect(this,&DanmuRender::planLayout,planner,&LayoutPlanner::beginPlan);
+    QObject::connect(planner,&LayoutPlanner::planDone,this,[this](LayoutPlan *plan){
+        if(pendingPlanKey==plan->key) pendingPlanKey.clear();
+        //plans of an older revision of the same pool will never be used again
+        for(auto iter=planCache.begin();iter!=planCache.end();)
+        {
+            if(iter.value()->poolID==plan->poolID && iter.value()->revision!=plan->revision)
+            {
+                planCacheOrder.removeOne(iter.key());
+                iter=planCache.erase(iter);
+            }
+            else
+                ++iter;
+        }
+        planCacheOrder.removeOne(plan->key);
+        planCache.remove(plan->key);
+        //least recently used first, currentPlan stays valid even if it is dropped
+        while(planCache.size()>=maxPlanCache)
+            planCache.remove(planCacheOrder.takeLast());
+        //only positions are needed from now on
+        plan->danmuList=QVector<PlannedDanmu>();
+        planCache.insert(plan->key,QSharedPointer<LayoutPlan>(plan));
+        planCacheOrder.prepend(plan->key);
     });
+    planThread.setObjectName(QStringLiteral("planThread"));
+    planThread.start(QThread::LowPriority);
+
     currentDrList=nullptr;
+    densityControl.admitLimit=minAdmitLimit;
+    densityControl.frameCostAvg=0;
+    densityControl.frameIntervalAvg=1000.f/60;
+    densityControl.cacheLatencyAvg=0;
+    densityControl.inFlightCount=0;
+    densityControl.pendingMoveCost=0;
+    densityControl.lastAdjustTime=0;
+    densityControl.clock.start();
+    resetShedStatis();
+#ifdef DANMU_STATIS
+    resetRenderStatis();
+#endif
 }
 
 DanmuRender::~DanmuRender()
@@ -66,23 +125,35 @@ DanmuRender::~DanmuRender()
     delete layout_table[2];
     cacheThread.quit();
     cacheThread.wait();
+    planThread.quit();
+    planThread.wait();
     qDeleteAll(drListPool);
     DanmuObject::DeleteObjPool();
 }
 
 void DanmuRender::drawDanmu()
 {
+    QElapsedTimer costTimer;
+    costTimer.start();
     //painter.setOpacity(danmuOpacity);
     if(!hideLayout[DanmuComment::Rolling])layout_table[DanmuComment::Rolling]->drawLayout();
     if(!hideLayout[DanmuComment::Top])layout_table[DanmuComment::Top]->drawLayout();
     if(!hideLayout[DanmuComment::Bottom])layout_table[DanmuComment::Bottom]->drawLayout();
+    //frame cost = move + draw, in us
+    qint64 cost=(densityControl.pendingMoveCost+costTimer.nsecsElapsed())/1000;
+    densityControl.pendingMoveCost=0;
+    updateDensityControl(cost);
 }
 
 void DanmuRender::moveDanmu(float interval)
 {
+    QElapsedTimer costTimer;
+    costTimer.start();
     layout_table[DanmuComment::Rolling]->moveLayout(interval);
     layout_table[DanmuComment::Top]->moveLayout(interval);
     layout_table[DanmuComment::Bottom]->moveLayout(interval);
+    densityControl.pendingMoveCost+=costTimer.nsecsElapsed();
+    densityControl.frameIntervalAvg=densityControl.frameIntervalAvg*0.9f+interval*0.1f;
 }
 
 void DanmuRender::cleanup(DanmuComment::DanmuType cleanType)
@@ -106,6 +177,15 @@ QSharedPointer<DanmuComment> DanmuRender::danmuAt(QPointF point)
     return layout_table[DanmuComment::Bottom]->danmuAt(point);
 }
 
+QList<QSharedPointer<DanmuComment> > DanmuRender::danmuIn(const QRectF &rect)
+{
+    QList<QSharedPointer<DanmuComment> > danmuList;
+    layout_table[DanmuComment::Top]->danmuIn(rect,danmuList);
+    layout_table[DanmuComment::Rolling]->danmuIn(rect,danmuList);
+    layout_table[DanmuComment::Bottom]->danmuIn(rect,danmuList);
+    return danmuList;
+}
+
 void DanmuRender::removeBlocked()
 {
     layout_table[DanmuComment::Rolling]->removeBlocked();
@@ -115,9 +195,29 @@ void DanmuRender::removeBlocked()
 
 void DanmuRender::drawDanmuTexture(const DanmuObject *danmuObj)
 {
-    static QRectF rect;
-    rect.setRect(danmuObj->x,danmuObj->y,danmuObj->drawInfo->width,danmuObj->drawInfo->height);
-    GlobalObjects::mpvplayer->drawTexture(danmuObj->drawInfo->texture,danmuOpacity,rect);
+    static GLfloat vtx[8];
+    static GLfloat tex[8]={0,0,1,0,0,1,1,1};
+    GLfloat h = 2.f / surfaceSize.width(), v = 2.f / surfaceSize.height();
+    GLfloat l = danmuObj->x*h - 1, r = (danmuObj->x+danmuObj->drawInfo->width)*h - 1,
+            t = 1 - danmuObj->y*v, b = 1 - (danmuObj->y+danmuObj->drawInfo->height)*v;
+    vtx[0] = l; vtx[1] = t;
+    vtx[2] = r; vtx[3] = t;
+    vtx[4] = l; vtx[5] = b;
+    vtx[6] = r; vtx[7] = b;
+
+    danmuShader.bind();
+    danmuShader.setUniformValue("alpha", danmuOpacity);
+    danmuShader.setAttributeArray(0, vtx, 2);
+    danmuShader.setAttributeArray(1, tex, 2);
+    danmuShader.enableAttributeArray(0);
+    danmuShader.enableAttributeArray(1);
+
+    QOpenGLFunctions *glFuns=QOpenGLContext::currentContext()->functions();
+    glFuns->glEnable(GL_BLEND);
+    glFuns->glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glFuns->glActiveTexture(GL_TEXTURE0);
+    glFuns->glBindTexture(GL_TEXTURE_2D, danmuObj->drawInfo->texture);
+    glFuns->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 }
 
 void DanmuRender::refDesc(DanmuDrawInfo *drawInfo)
@@ -144,9 +244,243 @@ void DanmuRender::refDesc(DanmuDrawInfo *drawInfo)
     }
 }
 
+void DanmuRender::initContext(QOpenGLContext *shareContext)
+{
+    surface = shareContext->surface();
+
+    danmuTextureContext = new QOpenGLContext();
+    danmuTextureContext->setFormat(shareContext->format());
+    danmuTextureContext->setShareContext(shareContext);
+    danmuTextureContext->create();
+    danmuTextureContext->moveToThread(&cacheThread);
+
+    danmuShader.addShaderFromSourceCode(QOpenGLShader::Vertex, vShaderDanmu);
+    danmuShader.addShaderFromSourceCode(QOpenGLShader::Fragment, fShaderDanmu);
+    danmuShader.link();
+    danmuShader.bind();
+    danmuShader.bindAttributeLocation("a_VtxCoord", 0);
+    danmuShader.bindAttributeLocation("a_TexCoord", 1);
+    danmuShader.setUniformValue("u_SamplerD", 0);
+}
+
+void DanmuRender::setSurfaceSize(const QSize &size)
+{
+    surfaceSize=size;
+    refreshDMRect();
+}
+
+void DanmuRender::resetShedStatis()
+{
+    shedStatis.total=0;
+    shedStatis.duplicate=0;
+    shedStatis.sender=0;
+    shedStatis.even=0;
+    emit shedStatisChanged();
+}
+
+#ifdef DANMU_STATIS
+QJsonObject DanmuRender::getRenderStatis()
+{
+    QJsonObject cacheObj;
+    cacheObj.insert("hit",cacheWorker->cacheHit.load());
+    cacheObj.insert("miss",cacheWorker->cacheMiss.load());
+    cacheObj.insert("clean",cacheWorker->cacheClean.load());
+    cacheObj.insert("items",cacheWorker->cacheSize.load());
+
+    QJsonObject dropObj;
+    dropObj.insert("maxCount",shedStatis.total);
+    dropObj.insert("duplicate",shedStatis.duplicate);
+    dropObj.insert("sender",shedStatis.sender);
+    dropObj.insert("even",shedStatis.even);
+    dropObj.insert("rolling",layout_table[DanmuComment::Rolling]->danmuLostCount());
+    dropObj.insert("top",layout_table[DanmuComment::Top]->danmuLostCount());
+    dropObj.insert("bottom",layout_table[DanmuComment::Bottom]->danmuLostCount());
+
+    QJsonObject statisObj;
+    statisObj.insert("added",renderStatis.addCount);
+    statisObj.insert("onScreen",onScreenCount());
+    statisObj.insert("admitLimit",maxCount==-1?-1:int(densityControl.admitLimit));
+    statisObj.insert("cacheLatency(ms)",densityControl.cacheLatencyAvg);
+    statisObj.insert("cache",cacheObj);
+    statisObj.insert("dropped",dropObj);
+    return statisObj;
+}
+
+void DanmuRender::resetRenderStatis()
+{
+    renderStatis.addCount=0;
+    resetShedStatis();
+    layout_table[DanmuComment::Rolling]->resetLostCount();
+    layout_table[DanmuComment::Top]->resetLostCount();
+    layout_table[DanmuComment::Bottom]->resetLostCount();
+    cacheWorker->cacheHit.store(0);
+    cacheWorker->cacheMiss.store(0);
+    cacheWorker->cacheClean.store(0);
+}
+#endif
+
+void DanmuRender::updateDensityControl(qint64 frameCost)
+{
+    DensityControlInfo &dc=densityControl;
+    dc.frameCostAvg=dc.frameCostAvg*0.9f+frameCost*0.1f;
+    if(maxCount==-1)return;
+    qint64 now=dc.clock.elapsed();
+    //move+draw takes more than half of the frame interval, or the cache thread falls behind
+    bool underPressure=dc.frameCostAvg/1000>dc.frameIntervalAvg*0.5f || dc.cacheLatencyAvg>200;
+    if(underPressure)
+    {
+        if(now-dc.lastAdjustTime>250)
+        {
+            dc.admitLimit=qMax<float>(minAdmitLimit,dc.admitLimit*0.8f);
+            dc.lastAdjustTime=now;
+        }
+    }
+    else
+    {
+        dc.admitLimit=qMin<float>(maxCount,dc.admitLimit+0.2f);
+    }
+}
+
+int DanmuRender::onScreenCount()
+{
+    return layout_table[DanmuComment::Rolling]->danmuCount()+
+           layout_table[DanmuComment::Top]->danmuCount()+
+           layout_table[DanmuComment::Bottom]->danmuCount();
+}
+
+void DanmuRender::thinDanmu(PrepareList *prepareList, int admitCount)
+{
+    DensityControlInfo &dc=densityControl;
+    qint64 now=dc.clock.elapsed();
+    int shedCount=prepareList->size()-admitCount;
+    QVector<bool> shed(prepareList->size(),false);
+    //1. duplicate text, in this bundle or shown recently
+    QSet<QString> bundleText;
+    for(int i=0;i<prepareList->size() && shedCount>0;++i)
+    {
+        const QString &text=prepareList->at(i).first->text;
+        if(bundleText.contains(text) || now-dc.recentText.value(text,-densityWindow)<densityWindow)
+        {
+            shed[i]=true;
+            shedCount--;
+            shedStatis.duplicate++;
+        }
+        else
+        {
+            bundleText.insert(text);
+        }
+    }
+    //2. senders who posted a lot recently
+    if(shedCount>0)
+    {
+        QVector<QPair<int,int> > senderRank;
+        for(int i=0;i<prepareList->size();++i)
+        {
+            const QString &sender=prepareList->at(i).first->sender;
+            if(shed[i] || sender.isEmpty())continue;
+            const QPair<qint64,int> senderInfo(dc.recentSender.value(sender));
+            if(now-senderInfo.first<densityWindow && senderInfo.second>1)
+                senderRank.append(QPair<int,int>(senderInfo.second,i));
+        }
+        std::stable_sort(senderRank.begin(),senderRank.end(),[](const QPair<int,int> &r1,const QPair<int,int> &r2){
+            return r1.first>r2.first;
+        });
+        for(auto iter=senderRank.cbegin();iter!=senderRank.cend() && shedCount>0;++iter)
+        {
+            shed[(*iter).second]=true;
+            shedCount--;
+            shedStatis.sender++;
+        }
+    }
+    //3. spread the rest evenly in time
+    if(shedCount>0)
+    {
+        QVector<int> rest;
+        for(int i=0;i<prepareList->size();++i)
+            if(!shed[i])rest.append(i);
+        int n=rest.size(),keep=n-shedCount;
+        for(int j=0;j<n;++j)
+        {
+            if((j*keep)/n==((j+1)*keep)/n)
+            {
+                shed[rest[j]]=true;
+                shedStatis.even++;
+            }
+        }
+    }
+    PrepareList admitted;
+    for(int i=0;i<prepareList->size();++i)
+        if(!shed[i])admitted.append(prepareList->at(i));
+    shedStatis.total+=prepareList->size()-admitted.size();
+    prepareList->swap(admitted);
+    emit shedStatisChanged();
+}
+
+QString DanmuRender::layoutPlanKey()
+{
+    //surface size is bucketed so that small resizes keep the plan
+    const int bucket=16;
+    QString style(QString("%1,%2,%3,%4,%5,%6").arg(danmuStyle.fontFamily).arg(fontSizeTable[0]).arg(int(danmuStyle.bold))
+            .arg(danmuStyle.strokeWidth).arg(rollSpeed).arg(int(dense)));
+    return QString("%1/%2/%3,%4,%5/%6").arg(GlobalObjects::danmuPool->getPoolID()).arg(GlobalObjects::danmuPool->getRevision())
+            .arg(int(surfaceRect.width())/bucket).arg(int(surfaceRect.top())/bucket).arg(int(surfaceRect.bottom())/bucket)
+            .arg(qHash(style),0,16);
+}
+
+void DanmuRender::refreshLayoutPlan()
+{
+    DanmuPool *pool=GlobalObjects::danmuPool;
+    //random font size makes the layout undeterminable
+    if(danmuStyle.randomSize || pool->isEmpty() || surfaceRect.isEmpty())
+    {
+        currentPlan.clear();
+        return;
+    }
+    QString key(layoutPlanKey());
+    if(!currentPlan.isNull() && currentPlan->key==key) return;
+    currentPlan=planCache.value(key);
+    if(!currentPlan.isNull())
+    {
+        planCacheOrder.move(planCacheOrder.indexOf(key),0);
+        return;
+    }
+    if(pendingPlanKey==key) return;
+    LayoutPlan *plan=new LayoutPlan;
+    plan->key=key;
+    plan->poolID=pool->getPoolID();
+    plan->revision=pool->getRevision();
+    plan->style.fontFamily=danmuStyle.fontFamily;
+    for(int i=0;i<3;++i)
+        plan->style.fontSizeTable[i]=fontSizeTable[i];
+    plan->style.bold=danmuStyle.bold;
+    plan->style.strokeWidth=danmuStyle.strokeWidth;
+    plan->style.rollSpeed=rollSpeed;
+    plan->style.lifeTime=5000;
+    plan->style.dense=dense;
+    plan->style.surfaceRect=surfaceRect;
+    plan->lookback=0;
+    QHash<int,DanmuSourceInfo> &sources=pool->getSources();
+    plan->danmuList.reserve(pool->totalCount());
+    for(int i=0;i<pool->totalCount();++i)
+    {
+        const QSharedPointer<DanmuComment> &danmu=pool->getDanmu(i);
+        if(danmu->time<0 || danmu->blockBy!=-1) continue;
+        auto sourceIter=sources.constFind(danmu->source);
+        if(sourceIter==sources.constEnd() || !sourceIter.value().show) continue;
+        PlannedDanmu planned;
+        planned.key=danmu.data();
+        planned.time=danmu->time;
+        planned.type=danmu->type;
+        planned.fontSizeLevel=danmu->fontSizeLevel;
+        planned.text=danmu->text;
+        plan->danmuList.append(planned);
+    }
+    pendingPlanKey=key;
+    emit planLayout(plan);
+}
+
 void DanmuRender::refreshDMRect()
 {
-    const QSize surfaceSize(GlobalObjects::mpvplayer->size());
     this->surfaceRect.setRect(0,0,surfaceSize.width(),surfaceSize.height());
     if(bottomSubtitleProtect)
     {
@@ -197,6 +531,7 @@ void DanmuRender::setFontFamily(QString &family)
 
 void DanmuRender::setSpeed(float speed)
 {
+    rollSpeed=speed;
     static_cast<RollLayout *>(layout_table[0])->setSpeed(speed);
 }
 
@@ -213,36 +548,88 @@ void DanmuRender::setRandomSize(bool randomSize)
 void DanmuRender::setMaxDanmuCount(int count)
 {
     maxCount=count;
+    densityControl.admitLimit=count==-1?minAdmitLimit:count;
 }
 
 void DanmuRender::prepareDanmu(PrepareList *prepareList)
 {
+    refreshLayoutPlan();
+    DensityControlInfo &dc=densityControl;
     if(maxCount!=-1)
     {
-        if(layout_table[DanmuComment::Rolling]->danmuCount()+
-           layout_table[DanmuComment::Top]->danmuCount()+
-           layout_table[DanmuComment::Bottom]->danmuCount()>maxCount)
+        int admitCount=int(dc.admitLimit)-onScreenCount()-dc.inFlightCount;
+        if(admitCount<prepareList->size())
+            thinDanmu(prepareList,qMax(admitCount,0));
+        if(prepareList->isEmpty())
         {
             GlobalObjects::danmuPool->recyclePrepareList(prepareList);
             return;
         }
     }
+    qint64 now=dc.clock.elapsed();
+    if(dc.recentText.size()>4096)
+    {
+        for(auto iter=dc.recentText.begin();iter!=dc.recentText.end();)
+            iter=now-iter.value()<densityWindow?iter+1:dc.recentText.erase(iter);
+        for(auto iter=dc.recentSender.begin();iter!=dc.recentSender.end();)
+            iter=now-iter.value().first<densityWindow?iter+1:dc.recentSender.erase(iter);
+    }
+    for(auto &danmuInfo:*prepareList)
+    {
+        dc.recentText.insert(danmuInfo.first->text,now);
+        if(danmuInfo.first->sender.isEmpty())continue;
+        QPair<qint64,int> &senderInfo=dc.recentSender[danmuInfo.first->sender];
+        if(now-senderInfo.first>=densityWindow)senderInfo.second=0;
+        senderInfo.first=now;
+        senderInfo.second++;
+    }
+    dc.cacheQueue.enqueue(QPair<qint64,int>(now,prepareList->size()));
+    dc.inFlightCount+=prepareList->size();
     emit cacheDanmu(prepareList);
 }
 
 void DanmuRender::addDanmu(PrepareList *newDanmu)
 {
-    if(GlobalObjects::playlist->getCurrentItem()!=nullptr)
+    DensityControlInfo &dc=densityControl;
+    if(!dc.cacheQueue.isEmpty())
     {
+        QPair<qint64,int> cacheItem(dc.cacheQueue.dequeue());
+        dc.cacheLatencyAvg=dc.cacheLatencyAvg*0.8f+(dc.clock.elapsed()-cacheItem.first)*0.2f;
+        dc.inFlightCount-=cacheItem.second;
+    }
+    //the render benchmark drives the render without a playlist
+    if(!GlobalObjects::playlist || GlobalObjects::playlist->getCurrentItem()!=nullptr)
+    {
+        int currentTime=GlobalObjects::danmuPool->getCurrentTime();
         for(auto &danmuInfo:*newDanmu)
         {
+            if(!currentPlan.isNull())
+            {
+                auto iter=currentPlan->position.constFind(danmuInfo.first.data());
+                if(iter!=currentPlan->position.constEnd())
+                {
+                    if(iter.value()<0)
+                        refDesc(danmuInfo.second);
+                    else
+                        layout_table[danmuInfo.first->type]->addPlannedDanmu(danmuInfo.first,danmuInfo.second,iter.value(),
+                                                                             qMax(0,currentTime-danmuInfo.first->time));
+                    continue;
+                }
+            }
             layout_table[danmuInfo.first->type]->addDanmu(danmuInfo.first,danmuInfo.second);
         }
+#ifdef DANMU_STATIS
+        renderStatis.addCount+=newDanmu->size();
+#endif
     }
     GlobalObjects::danmuPool->recyclePrepareList(newDanmu);
 }
 
-CacheWorker::CacheWorker(const DanmuStyle *style):danmuStyle(style)
+CacheWorker::CacheWorker(const DanmuStyle *style):
+#ifdef DANMU_STATIS
+    cacheHit(0),cacheMiss(0),cacheClean(0),cacheSize(0),
+#endif
+    danmuStyle(style)
 {
     danmuFont.setFamily(danmuStyle->fontFamily);
     danmuStrokePen.setWidthF(danmuStyle->strokeWidth);
@@ -322,6 +709,10 @@ void CacheWorker::cleanCache()
         }
     }
     danmuTextureContext->doneCurrent();
+#ifdef DANMU_STATIS
+    cacheClean.ref();
+    cacheSize.store(danmuCache.size());
+#endif
 #ifdef QT_DEBUG
     qDebug()<<"clean done:"<<timer.elapsed()<<"ms, left item:"<<danmuCache.size();
 #endif
@@ -360,7 +751,16 @@ void CacheWorker::beginCache(PrepareList *danmus)
          {
              drawInfo=createDanmuCache(dm.first.data());
              danmuCache.insert(hash_str,drawInfo);
+#ifdef DANMU_STATIS
+             cacheMiss.ref();
+#endif
+         }
+#ifdef DANMU_STATIS
+         else
+         {
+             cacheHit.ref();
          }
+#endif
          drawInfo->useCount++;
          dm.second=drawInfo;
 #ifdef QT_DEBUG
@@ -375,6 +775,9 @@ void CacheWorker::beginCache(PrepareList *danmus)
         static int orderTable[]={0,2,1};
         return orderTable[item1.first->type]>orderTable[item2.first->type];
     });*/
+#ifdef DANMU_STATIS
+    cacheSize.store(danmuCache.size());
+#endif
 #ifdef QT_DEBUG
     etime=timer.elapsed();
     qDebug()<<"cache end, time: "<<etime<<"ms";
@@ -5,7 +5,7 @@
 #include <QList>
 #include "common.h"
 #include "Layouts/danmulayout.h"
-#include "Play/Video/mpvplayer.h"
+#include "layoutplanner.h"
 struct DanmuStyle
 {
     int *fontSizeTable;
@@ -14,11 +14,43 @@ struct DanmuStyle
     QString fontFamily;
     bool randomSize;
 };
+//danmu dropped by the density control, shown in the statistics bar
+struct ShedStatisInfo
+{
+    qint64 total;
+    qint64 duplicate;
+    qint64 sender;
+    qint64 even;
+};
+#ifdef DANMU_STATIS
+//counters for the render benchmark, not built into the player
+struct RenderStatisInfo
+{
+    qint64 addCount;
+};
+#endif
+struct DensityControlInfo
+{
+    float admitLimit;
+    float frameCostAvg;
+    float frameIntervalAvg;
+    float cacheLatencyAvg;
+    int inFlightCount;
+    QQueue<QPair<qint64,int> > cacheQueue;
+    QHash<QString,qint64> recentText;
+    QHash<QString,QPair<qint64,int> > recentSender;
+    qint64 pendingMoveCost;
+    qint64 lastAdjustTime;
+    QElapsedTimer clock;
+};
 class CacheWorker : public QObject
 {
     Q_OBJECT
 public:
     explicit CacheWorker(const DanmuStyle *style);
+#ifdef DANMU_STATIS
+    QAtomicInt cacheHit,cacheMiss,cacheClean,cacheSize;
+#endif
 private:
     const int max_cache=300;
     QHash<QString,DanmuDrawInfo *> danmuCache;
@@ -50,9 +82,21 @@ public:
     QRectF surfaceRect;
     bool dense;
     QSharedPointer<DanmuComment> danmuAt(QPointF point);
+    QList<QSharedPointer<DanmuComment> > danmuIn(const QRectF &rect);
     void removeBlocked();
     void drawDanmuTexture(const DanmuObject *danmuObj);
     void refDesc(DanmuDrawInfo *drawInfo);
+    inline int planLookback() const {return currentPlan.isNull()?0:currentPlan->lookback;}
+    //textures are created on a context shared with shareContext, call it with shareContext current
+    void initContext(QOpenGLContext *shareContext);
+    //size of the target the danmu are drawn on
+    void setSurfaceSize(const QSize &size);
+    inline const ShedStatisInfo &getShedStatis() const {return shedStatis;}
+    void resetShedStatis();
+#ifdef DANMU_STATIS
+    QJsonObject getRenderStatis();
+    void resetRenderStatis();
+#endif
 private:
     DanmuLayout *layout_table[3];
     bool hideLayout[3];
@@ -66,7 +110,26 @@ private:
     CacheWorker *cacheWorker;
     QList<QList<DanmuDrawInfo *> *> drListPool;
     QList<DanmuDrawInfo *>  *currentDrList;
+    QOpenGLShaderProgram danmuShader;
+    QSize surfaceSize;
+    ShedStatisInfo shedStatis;
+#ifdef DANMU_STATIS
+    RenderStatisInfo renderStatis;
+#endif
+    DensityControlInfo densityControl;
+    float rollSpeed;
+    QThread planThread;
+    LayoutPlanner *planner;
+    QHash<QString,QSharedPointer<LayoutPlan> > planCache;
+    QStringList planCacheOrder; //keys of planCache, most recently used first
+    QSharedPointer<LayoutPlan> currentPlan;
+    QString pendingPlanKey;
+    QString layoutPlanKey();
+    void refreshLayoutPlan();
     void refreshDMRect();
+    void updateDensityControl(qint64 frameCost);
+    int onScreenCount();
+    void thinDanmu(PrepareList *prepareList, int admitCount);
 public:
     void setBottomSubtitleProtect(bool bottomOn);
     void setTopSubtitleProtect(bool topOn);
@@ -80,7 +143,9 @@ public:
     void setMaxDanmuCount(int count);
 signals:
     void cacheDanmu(PrepareList *newDanmu);
+    void planLayout(LayoutPlan *plan);
     void danmuStyleChanged();
+    void shedStatisChanged();
     void refCountChanged(QList<DanmuDrawInfo *> *descList);
 public slots:
     void prepareDanmu(PrepareList *prepareList);
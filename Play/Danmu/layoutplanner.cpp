@@ -0,0 +1,201 @@
+#include "layoutplanner.h"
+
+void LayoutPlanner::beginPlan(LayoutPlan *plan)
+{
+#ifdef QT_DEBUG
+    QElapsedTimer timer;
+    timer.start();
+#endif
+    const LayoutPlanStyle &style=plan->style;
+    const QRectF &rect=style.surfaceRect;
+    const float span=rect.height();
+    QFont danmuFont(style.fontFamily);
+    danmuFont.setBold(style.bold);
+    QList<QFontMetrics> metrics;
+    for(int i=0;i<3;++i)
+    {
+        danmuFont.setPointSize(style.fontSizeTable[i]);
+        metrics.append(QFontMetrics(danmuFont));
+    }
+    int strokeWidth=style.strokeWidth;
+    rollList.clear();
+    topList.clear();
+    bottomList.clear();
+    plan->position.clear();
+    plan->position.reserve(plan->danmuList.size());
+    plan->lookback=style.lifeTime;
+    for(const PlannedDanmu &danmu:plan->danmuList)
+    {
+        if(danmu.text.isEmpty())
+        {
+            plan->position.insert(danmu.key,-1);
+            continue;
+        }
+        const QFontMetrics &fm=metrics[danmu.fontSizeLevel];
+        QSize size=fm.size(0,danmu.text)+QSize(strokeWidth*2+qAbs(fm.leftBearing(danmu.text.front())),strokeWidth);
+        Occupant obj;
+        obj.height=size.height();
+        obj.width=size.width();
+        obj.spawn=danmu.time;
+        float d=-1,y=-1;
+        switch (danmu.type)
+        {
+        case DanmuComment::Rolling:
+        {
+            obj.speed=(obj.width/5+style.rollSpeed)/1000;
+            obj.expire=obj.spawn+(rect.width()+obj.width)/obj.speed;
+            plan->lookback=qMax(plan->lookback,obj.expire-obj.spawn);
+            removeExpired(rollList,danmu.time);
+            d=placeRolling(obj,span,rect.width(),style.dense);
+            if(d>=0)y=rect.top()+d;
+            break;
+        }
+        case DanmuComment::Top:
+            obj.expire=obj.spawn+style.lifeTime;
+            removeExpired(topList,danmu.time);
+            d=placeStatic(topList,obj,span,style.dense);
+            if(d>=0)y=rect.top()+d;
+            break;
+        case DanmuComment::Bottom:
+            obj.expire=obj.spawn+style.lifeTime;
+            removeExpired(bottomList,danmu.time);
+            d=placeStatic(bottomList,obj,span,style.dense);
+            if(d>=0)y=rect.bottom()-d-obj.height;
+            break;
+        default:
+            break;
+        }
+        plan->position.insert(danmu.key,y);
+    }
+    rollList.clear();
+    topList.clear();
+    bottomList.clear();
+#ifdef QT_DEBUG
+    qDebug()<<"layout plan:"<<plan->key<<", items:"<<plan->danmuList.size()<<", time:"<<timer.elapsed()<<"ms";
+#endif
+    emit planDone(plan);
+}
+
+float LayoutPlanner::placeRolling(const Occupant &obj, float span, float surfaceWidth, bool dense)
+{
+    //same strategy as RollLayout: rollList holds the last comment of each row, sorted by y
+    int t=obj.spawn;
+    float currentD(0.f),maxCollidedSpace(0.f),maxSpace(0.f),dsD1(0.f),dsD2(0.f),cD(0.f);
+    int msPos1(-1),msPos2(0);
+    Occupant newObj(obj);
+    for(int i=0;i<rollList.size();++i)
+    {
+        const Occupant &cur=rollList.at(i);
+        if(cur.d-currentD>=obj.height)
+        {
+            newObj.d=currentD;
+            rollList.insert(i,newObj);
+            return currentD;
+        }
+        //cur is collided with obj when it is still in the way, or obj will catch up with it
+        float x1w=surfaceWidth-cur.speed*(t-cur.spawn)+cur.width;
+        bool collided=x1w>surfaceWidth;
+        float collidedSpace(0.f);
+        if(!collided && obj.speed>cur.speed)
+        {
+            float t1=x1w/cur.speed,t2=(surfaceWidth-x1w)/(obj.speed-cur.speed);
+            collidedSpace=t2*cur.speed;
+            collided=t2<t1;
+        }
+        if(!collided)
+        {
+            newObj.d=currentD;
+            rollList[i]=newObj;
+            return currentD;
+        }
+        if(collidedSpace>surfaceWidth/2 && collidedSpace>maxCollidedSpace)
+        {
+            maxCollidedSpace=collidedSpace;
+            msPos1=i;
+            dsD1=currentD;
+        }
+        float tmp(cur.d-cD);
+        if(tmp>maxSpace)
+        {
+            maxSpace=tmp;
+            dsD2=cD+tmp/2;
+            msPos2=i;
+        }
+        cD=cur.d;
+        currentD=cD+cur.height;
+        if(currentD+obj.height>=span)
+            break;
+    }
+    if(currentD+obj.height<span)
+    {
+        newObj.d=currentD;
+        rollList.append(newObj);
+        return currentD;
+    }
+    if(dense)
+    {
+        if(msPos1!=-1)
+        {
+            newObj.d=dsD1;
+            rollList[msPos1]=newObj;
+            return dsD1;
+        }
+        newObj.d=dsD2;
+        rollList.insert(msPos2,newObj);
+        return dsD2;
+    }
+    return -1;
+}
+
+float LayoutPlanner::placeStatic(QList<Occupant> &list, const Occupant &obj, float span, bool dense)
+{
+    //d is the distance from the edge the comments stack from
+    float currentD(0.f),maxSpace(0.f),dsD(0.f),cD(0.f);
+    int msPos(0);
+    Occupant newObj(obj);
+    for(int i=0;i<list.size();++i)
+    {
+        const Occupant &cur=list.at(i);
+        if(cur.d-currentD>=obj.height)
+        {
+            newObj.d=currentD;
+            list.insert(i,newObj);
+            return currentD;
+        }
+        float tmp(cur.d-cD);
+        if(tmp>maxSpace)
+        {
+            maxSpace=tmp;
+            dsD=cD+tmp/2;
+            msPos=i;
+        }
+        cD=cur.d;
+        currentD=cD+cur.height;
+        if(currentD+obj.height>=span)
+            break;
+    }
+    if(currentD+obj.height<span)
+    {
+        newObj.d=currentD;
+        list.append(newObj);
+        return currentD;
+    }
+    if(dense)
+    {
+        newObj.d=dsD;
+        list.insert(msPos,newObj);
+        return dsD;
+    }
+    return -1;
+}
+
+void LayoutPlanner::removeExpired(QList<Occupant> &list, int time)
+{
+    for(auto iter=list.begin();iter!=list.end();)
+    {
+        if((*iter).expire<=time)
+            iter=list.erase(iter);
+        else
+            ++iter;
+    }
+}
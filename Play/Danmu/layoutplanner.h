@@ -0,0 +1,63 @@
+#ifndef LAYOUTPLANNER_H
+#define LAYOUTPLANNER_H
+#include <QtCore>
+#include <QtGui>
+#include "common.h"
+struct LayoutPlanStyle
+{
+    QString fontFamily;
+    int fontSizeTable[3];
+    bool bold;
+    float strokeWidth;
+    float rollSpeed;
+    float lifeTime;
+    bool dense;
+    QRectF surfaceRect;
+};
+//copied on the GUI thread, the pool may change the comments while the planner runs
+struct PlannedDanmu
+{
+    const DanmuComment *key; //only used to fill LayoutPlan::position, never read through
+    int time;
+    DanmuComment::DanmuType type;
+    DanmuComment::FontSizeLevel fontSizeLevel;
+    QString text;
+};
+struct LayoutPlan
+{
+    QString key;
+    QString poolID;
+    int revision;
+    LayoutPlanStyle style;
+    QVector<PlannedDanmu> danmuList;
+    //y of each comment on the surface, <0: no room for it
+    QHash<const DanmuComment *,float> position;
+    //longest time a comment stays on screen, in ms
+    int lookback;
+};
+class LayoutPlanner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LayoutPlanner(QObject *parent=nullptr):QObject(parent){}
+private:
+    struct Occupant
+    {
+        float d;
+        float height;
+        float width;
+        float speed;
+        int spawn;
+        int expire;
+    };
+    QList<Occupant> rollList,topList,bottomList;
+    float placeRolling(const Occupant &obj,float span,float surfaceWidth,bool dense);
+    float placeStatic(QList<Occupant> &list,const Occupant &obj,float span,bool dense);
+    void removeExpired(QList<Occupant> &list,int time);
+signals:
+    void planDone(LayoutPlan *plan);
+public slots:
+    void beginPlan(LayoutPlan *plan);
+};
+
+#endif // LAYOUTPLANNER_H
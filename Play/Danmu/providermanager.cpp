@@ -8,6 +8,7 @@
 #include "Provider/bahamutprovider.h"
 #include "Provider/iqiyiprovider.h"
 #include "globalobjects.h"
+#include "danmupool.h"
 
 ProviderManager::ProviderManager(QObject *parent) : QObject(parent)
 {
@@ -57,21 +58,24 @@ DanmuAccessResult *ProviderManager::search(const QString &providerId, QString ke
         DanmuAccessResult *result=new DanmuAccessResult;
         result->error=true;
         result->errorInfo=tr("Provider invalid or Unsupport search");
+        result->fromCache=false;
         return result;
     }
-    QMetaObject::invokeMethod(provider, [provider,&keyword]() {
-		provider->search(keyword);
-	}, Qt::QueuedConnection);
     QEventLoop eventLoop;
     DanmuAccessResult *curSearchInfo=nullptr;
+    //connected before the search is queued, the provider thread may finish it right away
     QObject::connect(provider,&ProviderBase::searchDone, &eventLoop, [&eventLoop,&curSearchInfo](DanmuAccessResult *searchInfo){
         curSearchInfo=searchInfo;
         eventLoop.quit();
     });
+    QMetaObject::invokeMethod(provider, [provider,&keyword]() {
+		provider->search(keyword);
+	}, Qt::QueuedConnection);
     eventLoop.exec();
     if(!curSearchInfo)
     {
         DanmuAccessResult *result=new DanmuAccessResult;
+        result->fromCache=false;
         result->error=true;
         result->errorInfo=tr("Search Failed");
         return result;
@@ -89,7 +93,6 @@ DanmuAccessResult *ProviderManager::getEpInfo(const QString &providerId, DanmuSo
         result->errorInfo=tr("Provider invalid");
         return result;
     }
-    QMetaObject::invokeMethod(provider,"getEpInfo",Qt::QueuedConnection,Q_ARG(DanmuSourceItem *,item));
     QEventLoop eventLoop;
     DanmuAccessResult *curEpInfo=nullptr;
     QObject::connect(provider,&ProviderBase::epInfoDone, &eventLoop, [&eventLoop,&curEpInfo,item](DanmuAccessResult *epInfo,DanmuSourceItem *srcItem){
@@ -99,6 +102,7 @@ DanmuAccessResult *ProviderManager::getEpInfo(const QString &providerId, DanmuSo
 			eventLoop.quit();
 		}
     });
+    QMetaObject::invokeMethod(provider,"getEpInfo",Qt::QueuedConnection,Q_ARG(DanmuSourceItem *,item));
     eventLoop.exec();
     if(!curEpInfo)
     {
@@ -130,15 +134,15 @@ QString ProviderManager::downloadDanmu(QString &providerId, DanmuSourceItem *ite
     {
         return tr("Provider invalid");
     }
-    QMetaObject::invokeMethod(provider,[provider,item,&danmuList](){
-        provider->downloadDanmu(item,danmuList);
-    },Qt::QueuedConnection);
     QEventLoop eventLoop;
     QString errorInfo;
     QObject::connect(provider,&ProviderBase::downloadDone, &eventLoop, [&eventLoop,&errorInfo](QString errInfo){
         errorInfo=errInfo;
         eventLoop.quit();
     });
+    QMetaObject::invokeMethod(provider,[provider,item,&danmuList](){
+        provider->downloadDanmu(item,danmuList);
+    },Qt::QueuedConnection);
     eventLoop.exec();
     return errorInfo;
 }
@@ -152,3 +156,65 @@ QString ProviderManager::downloadBySourceURL(const QString &url, QList<DanmuComm
     }
     return tr("Unsupported Source");
 }
+
+QString ProviderManager::getProviderId(const QString &sourceURL)
+{
+    for(auto iter=providers.cbegin();iter!=providers.cend();++iter)
+    {
+        if(iter.value()->supportSourceURL(sourceURL))
+            return iter.key();
+    }
+    return QString();
+}
+
+ProviderBase *ProviderManager::createProvider(const QString &providerId)
+{
+    auto creator=providerCreators.value(providerId,nullptr);
+    return creator?creator():nullptr;
+}
+
+QString ProviderManager::updateSource(const QString &poolID, const DanmuSourceInfo &sourceInfo, QList<DanmuComment *> &danmuList)
+{
+    ProviderBase *provider=nullptr;
+    for(auto iter=providers.cbegin();iter!=providers.cend();++iter)
+    {
+        if(iter.value()->supportSourceURL(sourceInfo.url))
+        {
+            provider=iter.value();
+            break;
+        }
+    }
+    if(!provider) return tr("Unsupported Source");
+    QString url(sourceInfo.url);
+    qint64 lastDate=sourceInfo.lastDate;
+    int sourceId=sourceInfo.id;
+    //a pool without ID is not saved, its comments are only in memory
+    QSet<quint64> hashSet;
+    if(poolID.isEmpty())hashSet=GlobalObjects::danmuPool->getDanmuHash(sourceId);
+    QString errorInfo;
+    QEventLoop eventLoop;
+    //download and dedup both run on the work thread, the GUI only waits
+    QMetaObject::invokeMethod(provider,[&](){
+        errorInfo=provider->updateBySourceURL(url,lastDate,danmuList);
+        if(!errorInfo.isEmpty())
+        {
+            //a partial update would move LastDate past the pages that failed
+            qDeleteAll(danmuList);
+            danmuList.clear();
+        }
+        else if(!danmuList.isEmpty())
+        {
+#ifdef QT_DEBUG
+            int downloadCount=danmuList.count();
+#endif
+            if(!poolID.isEmpty())hashSet=DanmuPool::loadDanmuHash(poolID,sourceId);
+            DanmuPool::dropKnownDanmu(danmuList,hashSet);
+#ifdef QT_DEBUG
+            qDebug()<<"update source:"<<url<<", since:"<<lastDate<<", download:"<<downloadCount<<", new:"<<danmuList.count();
+#endif
+        }
+        QMetaObject::invokeMethod(&eventLoop,"quit",Qt::QueuedConnection);
+    },Qt::QueuedConnection);
+    eventLoop.exec();
+    return errorInfo;
+}
@@ -2,6 +2,7 @@
 #define PROVIDERMANAGER_H
 
 #include <QObject>
+#include <functional>
 #include "common.h"
 #include "Provider/info.h"
 class ProviderBase;
@@ -18,9 +19,15 @@ public:
     DanmuAccessResult *getURLInfo(QString &url);
     QString downloadDanmu(QString &providerId,DanmuSourceItem *item,QList<DanmuComment *> &danmuList);
     QString downloadBySourceURL(const QString &url,QList<DanmuComment *> &danmuList);
+    //only returns comments that are not in the source yet
+    QString updateSource(const QString &poolID,const DanmuSourceInfo &sourceInfo,QList<DanmuComment *> &danmuList);
+    QString getProviderId(const QString &sourceURL);
+    //a private instance owned by the caller, for workers that run on their own thread
+    ProviderBase *createProvider(const QString &providerId);
 private:
     QMap<QString,ProviderBase *> providers;
     QList<ProviderBase *> orderedProviders;
+    QMap<QString,std::function<ProviderBase *()> > providerCreators;
 
     template<typename T>
     void registerProvider()
@@ -29,6 +36,7 @@ private:
         provider->moveToThread(GlobalObjects::workThread);
         providers.insert(provider->id(),provider);
         orderedProviders.append(provider);
+        providerCreators.insert(provider->id(),[](){return new T();});
     }
 };
 
@@ -0,0 +1,153 @@
+#include "folderscanner.h"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QDirIterator>
+#include <QCollator>
+struct FolderScanContext
+{
+    int scanId;
+    QSet<QString> suffixes;
+    QAtomicInt canceled;
+    QAtomicInt pendingJobs;
+    QAtomicInt folders,files;
+};
+namespace
+{
+    const int maxScanThreads=4;
+    const int flushInterval=100;
+}
+class FolderScanJob : public QRunnable
+{
+public:
+    FolderScanJob(FolderScanner *scanner,QSharedPointer<FolderScanContext> context,const QString &dir,const QStringList &relPath):
+        scanner(scanner),context(context),dir(dir),relPath(relPath){}
+    void run() override
+    {
+        if(!context->canceled.load())
+            scanFolder();
+        if(!context->pendingJobs.deref())
+        {
+            FolderScanner *scanner=this->scanner;
+            int scanId=context->scanId;
+            QMetaObject::invokeMethod(scanner,[scanner,scanId](){
+                scanner->scanDone(scanId);
+            },Qt::QueuedConnection);
+        }
+    }
+private:
+    FolderScanner *scanner;
+    QSharedPointer<FolderScanContext> context;
+    QString dir;
+    QStringList relPath;
+
+    void scanFolder()
+    {
+        ScanBatch batch;
+        batch.relPath=relPath;
+        QDirIterator iter(dir,QDir::Files|QDir::Dirs|QDir::NoDotAndDotDot);
+        while(iter.hasNext() && !context->canceled.load())
+        {
+            iter.next();
+            QFileInfo fileInfo(iter.fileInfo());
+            if(fileInfo.isDir())
+            {
+                //sibling folders are scanned in parallel
+                context->pendingJobs.ref();
+                QStringList subPath(relPath);
+                subPath.append(iter.fileName());
+                scanner->pool->start(new FolderScanJob(scanner,context,fileInfo.absoluteFilePath(),subPath));
+            }
+            else
+            {
+                const QString fileName(iter.fileName());
+                int suffixPos=fileName.lastIndexOf('.');
+                if(suffixPos==-1)continue;
+                if(context->suffixes.contains(fileName.mid(suffixPos+1).toLower()))
+                    batch.files.append(iter.filePath());
+            }
+        }
+        context->folders.ref();
+        if(batch.files.isEmpty())return;
+        context->files.fetchAndAddRelaxed(batch.files.count());
+        QCollator comparer;
+        comparer.setNumericMode(true);
+        std::sort(batch.files.begin(),batch.files.end(),[&comparer](const QString &f1,const QString &f2){
+            return comparer.compare(f1,f2)<0;
+        });
+        FolderScanner *scanner=this->scanner;
+        int scanId=context->scanId;
+        QMetaObject::invokeMethod(scanner,[scanner,scanId,batch](){
+            scanner->batchReady(scanId,batch);
+        },Qt::QueuedConnection);
+    }
+};
+
+FolderScanner::FolderScanner(QObject *parent) : QObject(parent),nextScanId(0)
+{
+    pool=new QThreadPool(this);
+    pool->setMaxThreadCount(maxScanThreads);
+    flushTimer.setInterval(flushInterval);
+    QObject::connect(&flushTimer,&QTimer::timeout,this,&FolderScanner::flush);
+}
+
+FolderScanner::~FolderScanner()
+{
+    cancelAll();
+    pool->waitForDone();
+}
+
+int FolderScanner::scan(const QString &folder, const QSet<QString> &suffixes)
+{
+    QSharedPointer<FolderScanContext> context(new FolderScanContext);
+    context->scanId=++nextScanId;
+    context->suffixes=suffixes;
+    context->pendingJobs=1;
+    scans.insert(context->scanId,context);
+    pool->start(new FolderScanJob(this,context,folder,QStringList()));
+    if(!flushTimer.isActive())flushTimer.start();
+    return context->scanId;
+}
+
+void FolderScanner::cancel(int scanId)
+{
+    QSharedPointer<FolderScanContext> context(scans.value(scanId));
+    if(context) context->canceled=1;
+}
+
+void FolderScanner::cancelAll()
+{
+    for(auto &context:scans)
+        context->canceled=1;
+}
+
+void FolderScanner::batchReady(int scanId, const ScanBatch &batch)
+{
+    QSharedPointer<FolderScanContext> context(scans.value(scanId));
+    if(!context || context->canceled.load())return;
+    pendingBatches[scanId].append(batch);
+}
+
+void FolderScanner::scanDone(int scanId)
+{
+    QSharedPointer<FolderScanContext> context(scans.value(scanId));
+    if(!context)return;
+    flush();
+    scans.remove(scanId);
+    pendingBatches.remove(scanId);
+    if(scans.isEmpty())flushTimer.stop();
+    emit finished(scanId,context->canceled.load()!=0);
+}
+
+void FolderScanner::flush()
+{
+    //receivers may start or cancel scans
+    for(int scanId:scans.keys())
+    {
+        QSharedPointer<FolderScanContext> context(scans.value(scanId));
+        if(!context || context->canceled.load())continue;
+        QList<ScanBatch> batches(pendingBatches.take(scanId));
+        if(!batches.isEmpty())
+            emit filesFound(scanId,batches);
+        emit progress(scanId,context->folders.load(),context->files.load());
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef FOLDERSCANNER_H
+#define FOLDERSCANNER_H
+
+#include <QObject>
+#include <QSet>
+#include <QHash>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QTimer>
+class QThreadPool;
+struct FolderScanContext;
+struct ScanBatch
+{
+    QStringList relPath; //folder names from the scan root, empty for the root itself
+    QStringList files;
+};
+class FolderScanner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FolderScanner(QObject *parent = nullptr);
+    ~FolderScanner();
+    //suffixes are lowercase without '.', returns the scan id
+    int scan(const QString &folder,const QSet<QString> &suffixes);
+    void cancel(int scanId);
+    void cancelAll();
+    inline bool isScanning() const {return !scans.isEmpty();}
+signals:
+    void filesFound(int scanId,const QList<ScanBatch> &batches);
+    void progress(int scanId,int folders,int files);
+    void finished(int scanId,bool canceled);
+private:
+    friend class FolderScanJob;
+    QThreadPool *pool;
+    QTimer flushTimer;
+    int nextScanId;
+    QHash<int,QSharedPointer<FolderScanContext> > scans;
+    QHash<int,QList<ScanBatch> > pendingBatches;
+
+    void batchReady(int scanId,const ScanBatch &batch);
+    void scanDone(int scanId);
+    void flush();
+};
+
+#endif // FOLDERSCANNER_H
@@ -0,0 +1,240 @@
+#include "matchpipeline.h"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QStorageInfo>
+#include <QSqlDatabase>
+#include "Play/Danmu/Provider/matchprovider.h"
+namespace
+{
+    //parallel reads on one spinning disk are slower than sequential ones
+    const int maxHashThreads=4;
+    const int maxInFlight=4;
+    const int commitBatch=32;
+    const int commitInterval=500;
+}
+class HashJob : public QRunnable
+{
+public:
+    HashJob(MatchPipeline *pipeline,const QList<QPair<int,QString> > &files):pipeline(pipeline),files(files){}
+    void run() override
+    {
+        //one query for the stored hashes of this volume instead of one per file
+        QStringList paths;
+        for(const auto &file:files)
+            paths.append(file.second);
+        MatchProvider::prefetchHashes(paths);
+        for(const auto &file:files)
+        {
+            if(pipeline->isCanceled()) break;
+            QElapsedTimer timer;
+            timer.start();
+            QString hash(MatchProvider::fileHash(file.second));
+            qint64 cost=timer.elapsed();
+            MatchPipeline *pipeline=this->pipeline;
+            int seq=file.first;
+            QMetaObject::invokeMethod(pipeline,[pipeline,seq,hash,cost](){
+                pipeline->fileHashed(seq,hash,cost);
+            },Qt::QueuedConnection);
+        }
+    }
+private:
+    MatchPipeline *pipeline;
+    QList<QPair<int,QString> > files;
+};
+
+MatchPipeline::MatchPipeline(const QStringList &files, QObject *parent) : QObject(parent),files(files),
+    nextCommit(0),hashedCount(0),matchedCount(0),inFlight(0),canceled(0),isFinished(false),
+    hashTime(0),networkTime(0),commitTime(0)
+{
+    results.fill(nullptr,files.count());
+    done.fill(false,files.count());
+    fromNetwork.fill(false,files.count());
+    hashes.resize(files.count());
+    hashPool=new QThreadPool(this);
+    hashPool->setMaxThreadCount(maxHashThreads);
+    commitTimer.setInterval(commitInterval);
+    QObject::connect(&commitTimer,&QTimer::timeout,this,&MatchPipeline::commit);
+}
+
+MatchPipeline::~MatchPipeline()
+{
+    canceled=1;
+    for(QPointer<Network::AsyncRequest> &request:requests)
+    {
+        if(request) request->abort();
+    }
+    hashPool->waitForDone();
+    qDeleteAll(results);
+}
+
+void MatchPipeline::start()
+{
+    totalTimer.start();
+    if(files.isEmpty())
+    {
+        QMetaObject::invokeMethod(this,[this](){finish(false);},Qt::QueuedConnection);
+        return;
+    }
+    //one sequential reader per volume
+    QHash<QString,QString> volumeCache;
+    QMap<QString,QList<QPair<int,QString> > > volumeFiles;
+    for(int i=0;i<files.count();++i)
+    {
+        QString dir(QFileInfo(files.at(i)).absolutePath());
+        auto iter=volumeCache.constFind(dir);
+        if(iter==volumeCache.constEnd())
+            iter=volumeCache.insert(dir,QStorageInfo(dir).rootPath());
+        volumeFiles[iter.value()].append(qMakePair(i,files.at(i)));
+    }
+    for(auto iter=volumeFiles.cbegin();iter!=volumeFiles.cend();++iter)
+        hashPool->start(new HashJob(this,iter.value()));
+    commitTimer.start();
+#ifdef QT_DEBUG
+    qDebug()<<"match pipeline: files:"<<files.count()<<", volumes:"<<volumeFiles.count();
+#endif
+}
+
+void MatchPipeline::cancel()
+{
+    if(isFinished) return;
+    canceled=1;
+    networkQueue.clear();
+    for(QPointer<Network::AsyncRequest> &request:requests)
+    {
+        if(request) request->abort();
+    }
+    requests.clear();
+    commit();
+    finish(true);
+}
+
+void MatchPipeline::fileHashed(int seq, const QString &hash, qint64 cost)
+{
+    if(isCanceled()) return;
+    hashedCount++;
+    hashTime+=cost;
+    if(hash.isEmpty())
+    {
+        resultReady(seq,nullptr);
+        return;
+    }
+    MatchInfo *localMatchInfo=MatchWorker::retrieveInMatchTable(hash,"MT");
+    if(localMatchInfo)
+    {
+        resultReady(seq,localMatchInfo);
+        return;
+    }
+    hashes[seq]=hash;
+    networkQueue.enqueue(seq);
+    pumpNetwork();
+}
+
+void MatchPipeline::pumpNetwork()
+{
+    while(!isCanceled() && inFlight<maxInFlight && !networkQueue.isEmpty())
+    {
+        int seq=networkQueue.dequeue();
+        QString hash(hashes.at(seq));
+        QJsonObject json;
+        json.insert("fileName", QFileInfo(files.at(seq)).baseName());
+        json.insert("fileHash", hash);
+        QByteArray data(QJsonDocument(json).toJson(QJsonDocument::Compact));
+        QElapsedTimer requestTimer;
+        requestTimer.start();
+        inFlight++;
+        QPointer<MatchPipeline> guard(this);
+        Network::AsyncRequest *request=Network::httpPostAsync("https://api.acplay.net/api/v2/match",data,
+                                                             QStringList()<<"Content-Type"<<"application/json"<<"Accept"<<"application/json",
+                                                             [guard,seq,hash,requestTimer](const Network::Reply &reply){
+            if(!guard || guard->isCanceled()) return;
+            MatchPipeline *pipeline=guard.data();
+            pipeline->inFlight--;
+            pipeline->networkTime+=requestTimer.elapsed();
+            MatchInfo *matchInfo=new MatchInfo;
+            matchInfo->fileHash=hash;
+            matchInfo->success=false;
+            if(reply.hasError)
+            {
+                matchInfo->error=true;
+                matchInfo->errorInfo=reply.errorInfo;
+            }
+            else
+            {
+                try
+                {
+                    MatchWorker::parseMatchReply(Network::toJson(reply.content),matchInfo);
+                }
+                catch(Network::NetworkError &error)
+                {
+                    matchInfo->error=true;
+                    matchInfo->errorInfo=error.errorInfo;
+                }
+            }
+            pipeline->fromNetwork[seq]=true;
+            pipeline->resultReady(seq,matchInfo);
+            pipeline->pumpNetwork();
+        });
+        requests.append(request);
+    }
+    for(auto iter=requests.begin();iter!=requests.end();)
+    {
+        if(*iter) ++iter;
+        else iter=requests.erase(iter);
+    }
+}
+
+void MatchPipeline::resultReady(int seq, MatchInfo *matchInfo)
+{
+    results[seq]=matchInfo;
+    done[seq]=true;
+    matchedCount++;
+    int end=nextCommit;
+    while(end<files.count() && done.at(end)) ++end;
+    if(end-nextCommit>=commitBatch || end==files.count())
+        commit();
+}
+
+void MatchPipeline::commit()
+{
+    int end=nextCommit;
+    while(end<files.count() && done.at(end)) ++end;
+    if(end>nextCommit)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        QSqlDatabase db=QSqlDatabase::database("MT");
+        db.transaction();
+        QList<Result> batch;
+        for(int i=nextCommit;i<end;++i)
+        {
+            MatchInfo *matchInfo=results.at(i);
+            if(matchInfo && fromNetwork.at(i) && !matchInfo->error && matchInfo->success && matchInfo->matches.count()>0)
+            {
+                matchInfo->poolID=MatchProvider::addToBangumiTable(matchInfo->matches.first().animeTitle,matchInfo->matches.first().title);
+                MatchProvider::addToMatchTable(matchInfo->fileHash,matchInfo->poolID,true);
+            }
+            batch.append({files.at(i),matchInfo});
+            results[i]=nullptr;
+        }
+        db.commit();
+        nextCommit=end;
+        commitTime+=timer.elapsed();
+        emit committed(batch);
+    }
+    if(!isFinished)
+        emit progress(hashedCount,matchedCount,files.count());
+    if(nextCommit==files.count())
+        finish(false);
+}
+
+void MatchPipeline::finish(bool canceled)
+{
+    if(isFinished) return;
+    isFinished=true;
+    commitTimer.stop();
+#ifdef QT_DEBUG
+    qDebug()<<"match pipeline:"<<(canceled?"canceled":"done")<<", committed:"<<nextCommit<<"/"<<files.count()
+           <<", hash:"<<hashTime<<"ms, network:"<<networkTime<<"ms, commit:"<<commitTime<<"ms, total:"<<totalTimer.elapsed()<<"ms";
+#endif
+    emit finished(canceled);
+}
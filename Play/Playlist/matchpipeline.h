@@ -0,0 +1,59 @@
+#ifndef MATCHPIPELINE_H
+#define MATCHPIPELINE_H
+
+#include <QObject>
+#include <QVector>
+#include <QQueue>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QStringList>
+#include "Common/network.h"
+struct MatchInfo;
+class QThreadPool;
+//Files are hashed by one reader per disk, hashes not in the match table go to dandan with a bounded
+//number of requests in flight, results are committed to the DB and reported in the order of files
+class MatchPipeline : public QObject
+{
+    Q_OBJECT
+public:
+    struct Result
+    {
+        QString path;
+        MatchInfo *matchInfo; //nullptr if the file can't be read, owned by the receiver
+    };
+    explicit MatchPipeline(const QStringList &files,QObject *parent = nullptr);
+    ~MatchPipeline();
+
+    void start();
+    void cancel();
+    inline bool isCanceled() const {return canceled.load()!=0;}
+signals:
+    void committed(const QList<MatchPipeline::Result> &results);
+    void progress(int hashed,int matched,int total);
+    void finished(bool canceled);
+private:
+    friend class HashJob;
+    QStringList files;
+    QVector<MatchInfo *> results;
+    QVector<bool> done,fromNetwork;
+    QVector<QString> hashes;
+    int nextCommit,hashedCount,matchedCount;
+    QQueue<int> networkQueue;
+    QList<QPointer<Network::AsyncRequest> > requests;
+    int inFlight;
+    QThreadPool *hashPool;
+    QAtomicInt canceled;
+    QTimer commitTimer;
+    bool isFinished;
+    qint64 hashTime,networkTime,commitTime;
+    QElapsedTimer totalTimer;
+
+    void fileHashed(int seq,const QString &hash,qint64 cost);
+    void pumpNetwork();
+    void resultReady(int seq,MatchInfo *matchInfo);
+    void commit();
+    void finish(bool canceled);
+};
+
+#endif // MATCHPIPELINE_H
@@ -12,14 +12,23 @@
 #include <QCollator>
 #include <QSqlQuery>
 #include <QSqlRecord>
+#include <QTimer>
+#include <QEventLoop>
+#include <QElapsedTimer>
 
 #include "globalobjects.h"
 #include "Play/Danmu/Provider/matchprovider.h"
+#include "prefetcher.h"
+#include "folderscanner.h"
+#include "playliststore.h"
+#include "matchpipeline.h"
 #include "Play/Video/mpvplayer.h"
 #include "MediaLibrary/animelibrary.h"
 
 namespace
 {
+    const int saveInterval=30000;
+    const int maxJournalRecords=2000;
     static QCollator comparer;
     struct
     {
@@ -36,20 +45,56 @@ namespace
         }
     } titleCompareDescending;
 }
-PlayList* PlayListItem::playlist=nullptr;
-
 PlayList::PlayList(QObject *parent) : QAbstractItemModel(parent),currentItem(nullptr),playListChanged(false),
-    loopMode(NO_Loop_All),needRefresh(true)
+    loopMode(NO_Loop_All),needRefresh(true),matchPipeline(nullptr)
 {
     comparer.setNumericMode(true);
-    PlayListItem::playlist=this;
+    PlayListItem::beforeDelete=[this](PlayListItem *item){
+        checkCurrentItem(item);
+        if(item->children)checkScanningItem(item);
+    };
+    store=new PlayListStore(this);
+    QObject::connect(store,&PlayListStore::filesMissing,this,[this](const QStringList &paths){
+        for(const QString &path:paths)
+        {
+            PlayListItem *item=fileItems.value(path,nullptr);
+            if(!item)continue;
+            item->fileMissing=true;
+            QModelIndex nIndex(createIndex(item->row(),0,item));
+            emit dataChanged(nIndex,nIndex);
+        }
+    });
 	loadRecentlist();
     loadPlaylist();
+    QTimer *saveTimer=new QTimer(this);
+    QObject::connect(saveTimer,&QTimer::timeout,this,[this](){savePlaylist();});
+    saveTimer->start(saveInterval);
+    prefetcher=new Prefetcher(this);
+    QObject::connect(prefetcher,&Prefetcher::matchFound,this,[this](const QString &path,const QString &poolID,
+                     const QString &animeTitle,const QString &title){
+        PlayListItem *item=fileItems.value(path,nullptr);
+        if(!item || !item->poolID.isEmpty())return;
+        item->animeTitle=animeTitle;
+        item->title=title;
+        item->poolID=poolID;
+        searchIndex.update(item);
+        journalItem(item,JournalRecord::Match);
+        needRefresh = true;
+        QModelIndex nIndex(createIndex(item->row(),0,item));
+        emit dataChanged(nIndex,nIndex);
+    });
+    scanner=new FolderScanner(this);
+    QObject::connect(scanner,&FolderScanner::filesFound,this,&PlayList::addScannedFiles);
+    QObject::connect(scanner,&FolderScanner::progress,this,[this](int,int folders,int files){
+        emit message(tr("Scanning: %1 folder(s), %2 item(s) found").arg(folders).arg(files),ListPopMessageFlag::LPM_PROCESS);
+    });
+    QObject::connect(scanner,&FolderScanner::finished,this,&PlayList::finishScan);
 }
 
 PlayList::~PlayList()
 {
-    savePlaylist();
+    scanner->cancelAll();
+    savePlaylist(true);
     saveRecentlist();
 }
 
@@ -61,7 +106,7 @@ int PlayList::addItems(QStringList &items, QModelIndex parent)
         insertPosition = parentItem->children->size();
 	else
 	{
-        insertPosition = parentItem->parent->children->indexOf(parentItem) + 1;
+        insertPosition = parentItem->row() + 1;
 		parentItem = parentItem->parent;
 		parent = this->parent(parent);
 	}
@@ -85,6 +130,7 @@ int PlayList::addItems(QStringList &items, QModelIndex parent)
         newItem->title = title;
 		newItem->path = item;
         fileItems.insert(newItem->path,newItem);
+        searchIndex.update(newItem);
 	}
 	endInsertRows();
     playListChanged=true;
@@ -94,7 +140,7 @@ int PlayList::addItems(QStringList &items, QModelIndex parent)
 
 }
 
-int PlayList::addFolder(QString folderStr, QModelIndex parent)
+void PlayList::addFolder(QString folderStr, QModelIndex parent)
 {
     int insertPosition(0);
 	PlayListItem *parentItem = parent.isValid() ? static_cast<PlayListItem*>(parent.internalPointer()) : &root;
@@ -102,63 +148,124 @@ int PlayList::addFolder(QString folderStr, QModelIndex parent)
         insertPosition = parentItem->children->size();
 	else
 	{
-        insertPosition = parentItem->parent->children->indexOf(parentItem) + 1;
+        insertPosition = parentItem->row() + 1;
 		parentItem = parentItem->parent;
 		parent = this->parent(parent);
 	}
-	
-    PlayListItem folderRootCollection;
-    int itemCount=0;
-    addSubFolder(folderStr, &folderRootCollection,itemCount);
-    if (folderRootCollection.children->count())
-	{
-        beginInsertRows(parent, insertPosition, insertPosition);
-        folderRootCollection.children->first()->moveTo(parentItem, insertPosition);
-		endInsertRows();
-        playListChanged=true;
-	}
-    folderRootCollection.children->clear();
-    emit message(tr("Add %1 item(s)").arg(itemCount),ListPopMessageFlag::LPM_HIDE|ListPopMessageFlag::LPM_OK);
-    return itemCount;
+    QDir folder(folderStr);
+    QSet<QString> suffixes;
+    for(const QString &format:GlobalObjects::mpvplayer->videoFileFormats)
+        suffixes.insert(format.mid(format.indexOf('.')+1).toLower());
+    //items are added to this collection while the scanner walks the folder
+    beginInsertRows(parent, insertPosition, insertPosition);
+    PlayListItem *folderCollection = new PlayListItem(parentItem, false, insertPosition);
+    folderCollection->title = folder.dirName();
+    searchIndex.update(folderCollection);
+    endInsertRows();
+    playListChanged=true;
+    FolderScan folderScan;
+    folderScan.root=folderCollection;
+    folderScan.collections.insert(QString(),folderCollection);
+    folderScan.itemCount=0;
+    folderScans.insert(scanner->scan(folder.absolutePath(),suffixes),folderScan);
+    emit message(tr("Scanning %1").arg(folderCollection->title),ListPopMessageFlag::LPM_PROCESS);
+    if(folderScans.count()==1) emit scanStateChanged(true);
 }
-bool PlayList::addSubFolder(QString folderStr, PlayListItem *parent,int &itemCount)
+
+void PlayList::stopScanning()
 {
-	QDir folder(folderStr);
-	bool containsVideoFile = false;
-	PlayListItem *folderCollection = new PlayListItem();
-	folderCollection->title = folder.dirName();
-	for (QFileInfo fileInfo : folder.entryInfoList())
-	{
-		QString fileName = fileInfo.fileName();
-		if (fileInfo.isFile())
-		{
-            if (GlobalObjects::mpvplayer->videoFileFormats.contains("*."+fileInfo.suffix().toLower()))
-			{
-                if(!fileItems.contains(fileInfo.filePath()))
-                {
-                    PlayListItem *newItem = new PlayListItem(folderCollection, true);
-                    int suffixPos = fileName.lastIndexOf('.'), pathPos = fileName.lastIndexOf('/') + 1;
-					QString title = fileName.mid(pathPos, suffixPos - pathPos);
-                    newItem->title = title;
-                    newItem->path = fileInfo.filePath();
-                    containsVideoFile = true;
-                    itemCount++;
-                    fileItems.insert(newItem->path,newItem);
-                }
-			}
-		}
-		else
-		{
-			if (fileName == "." || fileName == "..")continue;
-            bool ret = addSubFolder(fileInfo.absoluteFilePath(), folderCollection,itemCount);
-			if (ret) containsVideoFile = true;
-		}
-	}
-	if (containsVideoFile)
-		folderCollection->moveTo(parent);
-	else
-		delete folderCollection;
-    return containsVideoFile;
+    scanner->cancelAll();
+}
+
+bool PlayList::isScanning() const
+{
+    return !folderScans.isEmpty();
+}
+
+QModelIndexList PlayList::search(const QString &text, Qt::CaseSensitivity cs) const
+{
+    QModelIndexList indexes;
+    for(const PlayListItem *item:searchIndex.search(text,cs))
+    {
+        const PlayListItem *cur=item;
+        while(cur->parent && cur->parent->children->value(cur->row())==cur)
+            cur=cur->parent;
+        if(cur!=&root) continue;
+        indexes.append(createIndex(item->row(),0,const_cast<PlayListItem *>(item)));
+    }
+    return indexes;
+}
+
+PlayListItem *PlayList::getScanCollection(FolderScan &folderScan, const QStringList &relPath)
+{
+    QString key(relPath.join('/'));
+    PlayListItem *collection=folderScan.collections.value(key,nullptr);
+    if(collection) return collection;
+    PlayListItem *parentCollection=getScanCollection(folderScan,relPath.mid(0,relPath.count()-1));
+    const QString &title=relPath.last();
+    //sub folders stay sorted in front of the files
+    QList<PlayListItem *> &siblings=*parentCollection->children;
+    int insertPosition=0;
+    while(insertPosition<siblings.count() && siblings.at(insertPosition)->children &&
+          comparer.compare(siblings.at(insertPosition)->title,title)<0)
+        insertPosition++;
+    beginInsertRows(createIndex(parentCollection->row(),0,parentCollection),insertPosition,insertPosition);
+    collection=new PlayListItem(parentCollection,false,insertPosition);
+    collection->title=title;
+    searchIndex.update(collection);
+    endInsertRows();
+    folderScan.collections.insert(key,collection);
+    return collection;
+}
+
+void PlayList::addScannedFiles(int scanId, const QList<ScanBatch> &batches)
+{
+    auto scanIter=folderScans.find(scanId);
+    if(scanIter==folderScans.end() || !scanIter->root) return;
+    for(const ScanBatch &batch:batches)
+    {
+        QStringList files;
+        for(const QString &file:batch.files)
+        {
+            if(!fileItems.contains(file))
+                files.append(file);
+        }
+        if(files.isEmpty()) continue;
+        PlayListItem *collection=getScanCollection(*scanIter,batch.relPath);
+        int insertPosition=collection->children->count();
+        beginInsertRows(createIndex(collection->row(),0,collection),
+                        insertPosition,insertPosition+files.count()-1);
+        for(const QString &file:files)
+        {
+            int suffixPos = file.lastIndexOf('.'), pathPos = file.lastIndexOf('/') + 1;
+            PlayListItem *newItem = new PlayListItem(collection, true);
+            newItem->title = file.mid(pathPos, suffixPos - pathPos);
+            newItem->path = file;
+            fileItems.insert(newItem->path,newItem);
+            searchIndex.update(newItem);
+        }
+        endInsertRows();
+        scanIter->itemCount+=files.count();
+    }
+    playListChanged=true;
+    needRefresh = true;
+}
+
+void PlayList::finishScan(int scanId)
+{
+    if(!folderScans.contains(scanId)) return;
+    FolderScan folderScan(folderScans.take(scanId));
+    PlayListItem *folderCollection=folderScan.root;
+    if(folderCollection && folderCollection->children->isEmpty())
+    {
+        int row=folderCollection->row();
+        beginRemoveRows(createIndex(row,0,folderCollection).parent(), row, row);
+        folderCollection->parent->children->removeAt(row);
+        endRemoveRows();
+        delete folderCollection;
+    }
+    emit message(tr("Add %1 item(s)").arg(folderScan.itemCount),ListPopMessageFlag::LPM_HIDE|ListPopMessageFlag::LPM_OK);
+    if(folderScans.isEmpty()) emit scanStateChanged(false);
 }
 
 void PlayList::deleteItems(const QModelIndexList &deleteIndexes)
@@ -175,7 +282,7 @@ void PlayList::deleteItems(const QModelIndexList &deleteIndexes)
     std::sort(items.begin(),items.end(),[](const PlayListItem *item1,const PlayListItem *item2){return item1->level>item2->level;});
     for(PlayListItem *curItem:items)
     {
-        int cr_row = curItem->parent->children->indexOf(curItem);
+        int cr_row = curItem->row();
         const QModelIndex &itemIndex = createIndex(cr_row, 0, curItem);
         beginRemoveRows(itemIndex.parent(), cr_row, cr_row);
         curItem->parent->children->removeAt(cr_row);
@@ -250,13 +357,14 @@ QModelIndex PlayList::addCollection(QModelIndex parent, QString title)
 	}
 	else
 	{
-        insertPosition = parentItem->parent->children->indexOf(parentItem) + 1;
+        insertPosition = parentItem->row() + 1;
 		parentItem = parentItem->parent;
 		parent = this->parent(parent);
 	}
     beginInsertRows(parent, insertPosition, insertPosition);
     newCollection = new PlayListItem(parentItem,false,insertPosition);
 	newCollection->title = title;
+    searchIndex.update(newCollection);
 	endInsertRows();
     playListChanged=true;
     needRefresh = true;
@@ -281,7 +389,7 @@ void PlayList::cutItems(const QModelIndexList &cutIndexes)
     std::sort(itemsClipboard.begin(),itemsClipboard.end(),[](const PlayListItem *item1,const PlayListItem *item2){return item1->level>item2->level;});
     for(PlayListItem *curItem:itemsClipboard)
     {
-        int cr_row = curItem->parent->children->indexOf(curItem);
+        int cr_row = curItem->row();
         const QModelIndex &itemIndex = createIndex(cr_row, 0, curItem);
         beginRemoveRows(itemIndex.parent(), cr_row, cr_row);
         curItem->parent->children->removeAt(cr_row);
@@ -299,7 +407,7 @@ void PlayList::pasteItems(QModelIndex parent)
         insertPosition = parentItem->children->size();
     else
     {
-        insertPosition = parentItem->parent->children->indexOf(parentItem) + 1;
+        insertPosition = parentItem->row() + 1;
         parentItem = parentItem->parent;
         parent = this->parent(parent);
     }
@@ -320,7 +428,7 @@ void PlayList::moveUpDown(QModelIndex index, bool up)
     if(!index.isValid())return;
     PlayListItem *item= static_cast<PlayListItem*>(index.internalPointer());
     PlayListItem *parent=item->parent;
-    int row=parent->children->indexOf(item);
+    int row=item->row();
     int endPos=up?0:parent->children->count()-1;
     if(row==endPos)return;
     QModelIndex parentIndex=this->parent(index);
@@ -360,7 +468,7 @@ QModelIndex PlayList::parent(const QModelIndex &child) const
 
     if (parentItem == &root)
         return QModelIndex();
-    int row=parentItem->parent->children->indexOf(parentItem);
+    int row=parentItem->row();
     return createIndex(row, 0, parentItem);
 }
 
@@ -403,7 +511,9 @@ QVariant PlayList::data(const QModelIndex &index, int role) const
             else
                 tipContent<<QString("%1").arg(item->title);
             tipContent<<item->path;
-            if(item->playTimeState==0)
+            if(item->fileMissing)
+                tipContent<<tr("File Missing");
+            else if(item->playTimeState==0)
                 tipContent<<tr("Unplayed");
             else if(item->playTimeState==2)
                 tipContent<<tr("Finished");
@@ -421,7 +531,9 @@ QVariant PlayList::data(const QModelIndex &index, int role) const
             return QBrush(QColor(255,255,0));
         else
         {
-            if(item->playTimeState==0)
+            if(item->fileMissing)
+                return QBrush(QColor(200,90,90));
+            else if(item->playTimeState==0)
                 return QBrush(QColor(220,220,220));
             else if(item->playTimeState==1)
                 return QBrush(QColor(160,200,200));
@@ -500,15 +612,15 @@ bool PlayList::dropMimeData(const QMimeData *data, Qt::DropAction action, int ro
     const QModelIndex *pParentIndex=&parent;
     if (!parentItem->children)
     {
-        beginRow=parentItem->parent->children->indexOf(parentItem);
+        beginRow=parentItem->row();
         parentItem=parentItem->parent;
-        pParentIndex=&createIndex(parentItem->parent->children->indexOf(parentItem), 0, parentItem);
+        pParentIndex=&createIndex(parentItem->row(), 0, parentItem);
     }
     for (int cr = 0; cr < rows; ++cr)
 	{
 		PlayListItem *curItem = newItems[cr];
         PlayListItem *curParent=curItem->parent;
-        int cr_row = curParent->children->indexOf(curItem);
+        int cr_row = curItem->row();
 		const QModelIndex &itemIndex = createIndex(cr_row, 0, curItem);
 		beginRemoveRows(itemIndex.parent(), cr_row, cr_row);
         curParent->children->removeAt(cr_row);
@@ -519,7 +631,7 @@ bool PlayList::dropMimeData(const QMimeData *data, Qt::DropAction action, int ro
 		}
 		if (parentItem->parent == curParent)
 		{
-			int parentRow = curParent->children->indexOf(parentItem);
+			int parentRow = parentItem->row();
 			pParentIndex = &createIndex(parentRow, 0, parentItem);
 		}
         beginInsertRows(*pParentIndex, beginRow, beginRow);
@@ -541,8 +653,12 @@ bool PlayList::setData(const QModelIndex &index, const QVariant &value, int)
     if(!val.isEmpty())
     {
         item->title=val;
+        searchIndex.update(item);
         emit dataChanged(index,index);
-        playListChanged=true;
+        if(item->children)
+            playListChanged=true;
+        else
+            journalItem(item,JournalRecord::Title);
         needRefresh = true;
         return true;
     }
@@ -563,7 +679,7 @@ const PlayListItem *PlayList::setCurrentItem(const QModelIndex &index,bool playC
             while (cur!=current)
             {
                 if(!cur->children)break;
-                int row=cur->parent->children->indexOf(cur);
+                int row=cur->row();
                 if(row==cur->parent->children->count()-1)
                     cur=cur->parent;
                 else
@@ -579,7 +695,13 @@ const PlayListItem *PlayList::setCurrentItem(const QModelIndex &index,bool playC
     if(cur->children || cur==currentItem)
         return nullptr;
     QFileInfo fileInfo(cur->path);
-    if(!fileInfo.exists())
+    if(fileInfo.exists()==cur->fileMissing)
+    {
+        cur->fileMissing=!cur->fileMissing;
+        QModelIndex nIndex = createIndex(cur->row(), 0, cur);
+        emit dataChanged(nIndex, nIndex);
+    }
+    if(cur->fileMissing)
     {
         emit message(tr("File Not Exist"),LPM_INFO|LPM_HIDE);
         return nullptr;
@@ -589,7 +711,7 @@ const PlayListItem *PlayList::setCurrentItem(const QModelIndex &index,bool playC
 	currentItem = cur;
 	if (tmp)
 	{
-		QModelIndex nIndex = createIndex(tmp->parent->children->indexOf(tmp), 0, tmp);
+		QModelIndex nIndex = createIndex(tmp->row(), 0, tmp);
 		emit dataChanged(nIndex, nIndex);
 	}
     updateRecentlist(currentItem);
@@ -607,10 +729,10 @@ const PlayListItem *PlayList::setCurrentItem(const QString &path)
         currentItem = curItem;
         if (tmp)
         {
-            QModelIndex nIndex = createIndex(tmp->parent->children->indexOf(tmp), 0, tmp);
+            QModelIndex nIndex = createIndex(tmp->row(), 0, tmp);
             emit dataChanged(nIndex, nIndex);
         }
-        QModelIndex cIndex = createIndex(curItem->parent->children->indexOf(curItem), 0, curItem);
+        QModelIndex cIndex = createIndex(curItem->row(), 0, curItem);
         emit dataChanged(cIndex, cIndex);
         updateRecentlist(currentItem);
         updateLibraryInfo(curItem);
@@ -622,7 +744,7 @@ void PlayList::cleanCurrentItem()
 {
 	if (currentItem)
 	{
-		QModelIndex cIndex = createIndex(currentItem->parent->children->indexOf(currentItem), 0, currentItem);
+		QModelIndex cIndex = createIndex(currentItem->row(), 0, currentItem);
 		currentItem = nullptr;
 		emit dataChanged(cIndex, cIndex);
 	}
@@ -641,7 +763,7 @@ PlayListItem *PlayList::getPrevOrNextItem(PlayList::LoopMode loopMode,bool prev)
         do{
             while (cur!=&root)
             {
-                int row=cur->parent->children->indexOf(cur);
+                int row=cur->row();
                 int pos=prev?0:cur->parent->children->count()-1;
                 if(row==pos)
                     cur=cur->parent;
@@ -705,7 +827,8 @@ void PlayList::updateItemInfo(PlayListItem *item)
             item->animeTitle=matchInfo->matches.first().animeTitle;
             item->title=matchInfo->matches.first().title;
             item->poolID=matchInfo->poolID;
-            playListChanged=true;
+            searchIndex.update(item);
+            journalItem(item,JournalRecord::Match);
             needRefresh = true;
         }
     }
@@ -804,10 +927,10 @@ const PlayListItem *PlayList::playPrevOrNext(bool prev)
         updateItemInfo(item);
         if (tmp)
         {
-            QModelIndex nIndex(createIndex(tmp->parent->children->indexOf(tmp), 0, tmp));
+            QModelIndex nIndex(createIndex(tmp->row(), 0, tmp));
             emit dataChanged(nIndex, nIndex);
         }
-        QModelIndex nIndex(createIndex(currentItem->parent->children->indexOf(currentItem),0,currentItem));
+        QModelIndex nIndex(createIndex(currentItem->row(),0,currentItem));
         emit dataChanged(nIndex,nIndex);
         updateRecentlist(currentItem);
         updateLibraryInfo(item);
@@ -816,9 +939,26 @@ const PlayListItem *PlayList::playPrevOrNext(bool prev)
     return nullptr;
 }
 
+void PlayList::prefetchNext()
+{
+    PlayListItem *item(nullptr);
+    //a random pick is not known in advance
+    if(loopMode==Loop_One || loopMode==NO_Loop_One)
+        item=getPrevOrNextItem(NO_Loop_All,false);
+    else if(loopMode!=Random)
+        item=getPrevOrNextItem(loopMode,false);
+    if(!item || item==currentItem)
+    {
+        prefetcher->cancel();
+        return;
+    }
+    prefetcher->prefetch(item->path,item->poolID);
+}
+
 void PlayList::checkCurrentItem(PlayListItem *itemDeleted)
 {
     if(!itemDeleted->path.isEmpty())fileItems.remove(itemDeleted->path);
+    searchIndex.remove(itemDeleted);
     if(itemDeleted==currentItem)
     {
         currentItem=nullptr;
@@ -826,6 +966,25 @@ void PlayList::checkCurrentItem(PlayListItem *itemDeleted)
     }
 }
 
+void PlayList::checkScanningItem(PlayListItem *itemDeleted)
+{
+    for(auto iter=folderScans.begin();iter!=folderScans.end();++iter)
+    {
+        if(iter->root==itemDeleted)
+        {
+            scanner->cancel(iter.key());
+            iter->root=nullptr;
+            iter->collections.clear();
+            continue;
+        }
+        for(auto cIter=iter->collections.begin();cIter!=iter->collections.end();)
+        {
+            if(cIter.value()==itemDeleted) cIter=iter->collections.erase(cIter);
+            else ++cIter;
+        }
+    }
+}
+
 void PlayList::matchItems(const QModelIndexList &matchIndexes)
 {
     QList<PlayListItem *> items;
@@ -837,7 +996,7 @@ void PlayList::matchItems(const QModelIndexList &matchIndexes)
             items.append(item);
         }
     }
-    emit message(tr("Match Start"),ListPopMessageFlag::LPM_PROCESS);
+    QStringList files;
     while(!items.empty())
     {
         PlayListItem *currentItem=items.front();
@@ -847,11 +1006,24 @@ void PlayList::matchItems(const QModelIndexList &matchIndexes)
             for(PlayListItem *child:*currentItem->children)
                 items.push_back(child);
         }
-        else if(currentItem->poolID.isEmpty())
+        else if(currentItem->poolID.isEmpty() && !currentItem->fileMissing)
+        {
+            files.append(currentItem->path);
+        }
+    }
+    emit message(tr("Match Start"),ListPopMessageFlag::LPM_PROCESS);
+    MatchPipeline pipeline(files);
+    QObject::connect(&pipeline,&MatchPipeline::committed,this,[this](const QList<MatchPipeline::Result> &results){
+        for(const MatchPipeline::Result &result:results)
         {
-			if (!QFile::exists(currentItem->path))continue;
-            MatchInfo *matchInfo=MatchProvider::MatchFromDandan(currentItem->path);
-            if(!matchInfo) break;
+            MatchInfo *matchInfo=result.matchInfo;
+            //items may be removed while matching
+            PlayListItem *currentItem=fileItems.value(result.path,nullptr);
+            if(!matchInfo || !currentItem)
+            {
+                delete matchInfo;
+                continue;
+            }
             if(matchInfo->error)
             {
                 emit message(tr("Failed: %1").arg(matchInfo->errorInfo),ListPopMessageFlag::LPM_PROCESS);
@@ -862,17 +1034,17 @@ void PlayList::matchItems(const QModelIndexList &matchIndexes)
                 if(matchInfo->success && matchList.count()>0)
                 {
                     MatchInfo::DetailInfo &bestMatch=matchList.first();
-                    emit message(tr("Success: %1").arg(currentItem->title),ListPopMessageFlag::LPM_PROCESS);
                     currentItem->animeTitle=bestMatch.animeTitle;
                     currentItem->title=bestMatch.title;
                     currentItem->poolID=matchInfo->poolID;
-					playListChanged = true;
-					QModelIndex nIndex = createIndex(currentItem->parent->children->indexOf(currentItem), 0, currentItem);
-					emit dataChanged(nIndex, nIndex);
-					if (currentItem == this->currentItem)
-					{
-						emit currentMatchChanged();
-					}
+                    searchIndex.update(currentItem);
+                    journalItem(currentItem,JournalRecord::Match);
+                    QModelIndex nIndex = createIndex(currentItem->row(), 0, currentItem);
+                    emit dataChanged(nIndex, nIndex);
+                    if (currentItem == this->currentItem)
+                    {
+                        emit currentMatchChanged();
+                    }
                     GlobalObjects::library->addToLibrary(currentItem->animeTitle,currentItem->title,currentItem->path);
                 }
                 else
@@ -882,11 +1054,25 @@ void PlayList::matchItems(const QModelIndexList &matchIndexes)
             }
             delete matchInfo;
         }
-    }
-    emit message(tr("Match Done"),ListPopMessageFlag::LPM_HIDE|ListPopMessageFlag::LPM_OK);
+    });
+    QObject::connect(&pipeline,&MatchPipeline::progress,this,[this](int hashed,int matched,int total){
+        emit message(tr("Matching: %1/%2, Hashed: %3").arg(matched).arg(total).arg(hashed),ListPopMessageFlag::LPM_PROCESS);
+    });
+    QEventLoop eventLoop;
+    QObject::connect(&pipeline,&MatchPipeline::finished,&eventLoop,&QEventLoop::quit);
+    matchPipeline=&pipeline;
+    pipeline.start();
+    eventLoop.exec();
+    matchPipeline=nullptr;
+    emit message(pipeline.isCanceled()?tr("Match Canceled"):tr("Match Done"),ListPopMessageFlag::LPM_HIDE|ListPopMessageFlag::LPM_OK);
     savePlaylist();
 }
 
+void PlayList::stopMatching()
+{
+    if(matchPipeline) matchPipeline->cancel();
+}
+
 void PlayList::matchCurrentItem(MatchInfo *matchInfo)
 {
     if(!currentItem)return;
@@ -894,9 +1080,10 @@ void PlayList::matchCurrentItem(MatchInfo *matchInfo)
     currentItem->animeTitle=bestMatch.animeTitle;
     currentItem->title=bestMatch.title;
     currentItem->poolID=MatchProvider::updateMatchInfo(currentItem->path,matchInfo);
-    playListChanged = true;
+    searchIndex.update(currentItem);
+    journalItem(currentItem,JournalRecord::Match);
     emit message(tr("Success: %1").arg(currentItem->title),ListPopMessageFlag::LPM_HIDE|ListPopMessageFlag::LPM_OK);
-    QModelIndex nIndex = createIndex(currentItem->parent->children->indexOf(currentItem), 0, currentItem);
+    QModelIndex nIndex = createIndex(currentItem->row(), 0, currentItem);
     emit dataChanged(nIndex, nIndex);
     emit currentMatchChanged();
     GlobalObjects::library->addToLibrary(currentItem->animeTitle,currentItem->title,currentItem->path);
@@ -911,7 +1098,8 @@ void PlayList::matchIndex(QModelIndex &index, MatchInfo *matchInfo)
     item->animeTitle=bestMatch.animeTitle;
     item->title=bestMatch.title;
     item->poolID=MatchProvider::updateMatchInfo(item->path,matchInfo);
-    playListChanged = true;
+    searchIndex.update(item);
+    journalItem(item,JournalRecord::Match);
     needRefresh = true;
     emit message(tr("Success: %1").arg(item->title),ListPopMessageFlag::LPM_HIDE|ListPopMessageFlag::LPM_OK);
     emit dataChanged(index, index);
@@ -939,7 +1127,7 @@ void PlayList::setCurrentPlayTime(int playTime)
         }
         else
             currentItem->playTimeState=1;//playing
-        playListChanged=true;
+        journalItem(currentItem,JournalRecord::PlayTime);
         needRefresh=true;
     }
 }
@@ -960,24 +1148,25 @@ QModelIndex PlayList::mergeItems(const QModelIndexList &mergeIndexes)
             {
                 minLevel=item->level;
                 mergeParent=item->parent;
-                insertPosition=mergeParent->children->indexOf(item);
+                insertPosition=item->row();
             }
         }
     }
     QModelIndex parentIndex;
     if (mergeParent != &root)
     {
-        int row=mergeParent->parent->children->indexOf(mergeParent);
+        int row=mergeParent->row();
         parentIndex= createIndex(row, 0, mergeParent);
     }
     beginInsertRows(parentIndex, insertPosition, insertPosition);
     PlayListItem *newParent=new PlayListItem(mergeParent,false,insertPosition);
     newParent->title = setCollectionTitle(items);
+    searchIndex.update(newParent);
     endInsertRows();
 
     for(PlayListItem *curItem:items)
     {
-        int cr_row = curItem->parent->children->indexOf(curItem);
+        int cr_row = curItem->row();
         const QModelIndex &itemIndex = createIndex(cr_row, 0, curItem);
         beginRemoveRows(itemIndex.parent(), cr_row, cr_row);
         curItem->parent->children->removeAt(cr_row);
@@ -985,7 +1174,7 @@ QModelIndex PlayList::mergeItems(const QModelIndexList &mergeIndexes)
 
         endRemoveRows();
     }
-	QModelIndex collectionIndex= createIndex(newParent->parent->children->indexOf(newParent), 0, newParent);
+	QModelIndex collectionIndex= createIndex(newParent->row(), 0, newParent);
 	beginInsertRows(collectionIndex, 0, items.count()-1);
     for(PlayListItem *curItem:items)
     {
@@ -1044,9 +1233,9 @@ void PlayList::updatePlayTime(const QString &path, int time, int state)
     {
         item->playTime=time;
         item->playTimeState=state;
-        QModelIndex cIndex = createIndex(item->parent->children->indexOf(item), 0, item);
+        QModelIndex cIndex = createIndex(item->row(), 0, item);
         emit dataChanged(cIndex, cIndex);
-        playListChanged=true;
+        journalItem(item,JournalRecord::PlayTime);
         needRefresh=true;
         updateLibraryInfo(item);
         updateRecentlist(item);
@@ -1071,6 +1260,7 @@ void PlayList::loadPlaylist()
             {
                 PlayListItem *collection=new PlayListItem(parents.last(),false);
                 collection->title=reader.attributes().value("title").toString();
+                searchIndex.update(collection);
                 parents.push_back(collection);
             }
             else if(name=="item")
@@ -1081,28 +1271,15 @@ void PlayList::loadPlaylist()
                 int playTime=reader.attributes().value("playTime").toInt();
                 int playTimeState=reader.attributes().value("playTimeState").toInt();
                 QString path = reader.readElementText().trimmed();
-                QFileInfo fileInfo(path);
-                if(fileInfo.exists())
-                {
-                    PlayListItem *item=new PlayListItem(parents.last(),true);
-                    item->title=title;
-                    item->path= path;
-                    item->playTime=playTime;
-                    item->poolID = poolID;
-                    item->playTimeState=playTimeState;
-                    fileItems.insert(item->path,item);
-                    if(!animeTitle.isEmpty())item->animeTitle=animeTitle;
-                    for(auto &pair :recentList)
-                    {
-                        if(pair.first==item->path)
-                        {
-                            pair.second=item->animeTitle.isEmpty()?item->title:QString("%1 %2").arg(item->animeTitle).arg(item->title);
-                            break;
-                        }
-                    }
-                }
-                else
-                    playListChanged=true;
+                PlayListItem *item=new PlayListItem(parents.last(),true);
+                item->title=title;
+                item->path= path;
+                item->playTime=playTime;
+                item->poolID = poolID;
+                item->playTimeState=playTimeState;
+                fileItems.insert(item->path,item);
+                if(!animeTitle.isEmpty())item->animeTitle=animeTitle;
+                searchIndex.update(item);
             }
         }
         if(reader.isEndElement())
@@ -1115,6 +1292,34 @@ void PlayList::loadPlaylist()
         }
         reader.readNext();
     }
+    playlistFile.close();
+    for(const JournalRecord &record:store->readJournal())
+    {
+        PlayListItem *item=fileItems.value(record.path,nullptr);
+        if(!item)continue;
+        switch (record.type)
+        {
+        case JournalRecord::PlayTime:
+            item->playTime=record.playTime;
+            item->playTimeState=record.playTimeState;
+            break;
+        case JournalRecord::Match:
+            item->title=record.title;
+            item->animeTitle=record.animeTitle;
+            item->poolID=record.poolID;
+            break;
+        case JournalRecord::Title:
+            item->title=record.title;
+            break;
+        }
+        searchIndex.update(item);
+    }
+    for(auto &pair :recentList)
+    {
+        PlayListItem *item=fileItems.value(pair.first,nullptr);
+        if(item)
+            pair.second=item->animeTitle.isEmpty()?item->title:QString("%1 %2").arg(item->animeTitle).arg(item->title);
+    }
     for(auto iter= recentList.begin();iter!=recentList.end();)
     {
         if((*iter).second.isEmpty())
@@ -1122,7 +1327,8 @@ void PlayList::loadPlaylist()
         else
             iter++;
     }
-    playlistFile.close();
+    //items stay in the list, missing files are only marked once the check is done
+    store->checkFiles(fileItems.keys());
 }
 
 void PlayList::loadRecentlist()
@@ -1166,21 +1372,29 @@ void PlayList::saveRecentlist()
     recentlistFile.close();
 }
 
-void PlayList::savePlaylist()
+void PlayList::savePlaylist(bool wait)
 {
-    if(!playListChanged)return;
-    QFile playlistFile(QCoreApplication::applicationDirPath()+"\\playlist.xml");
-    bool ret=playlistFile.open(QIODevice::WriteOnly|QIODevice::Text);
-    if(!ret) return;
-    QXmlStreamWriter writer(&playlistFile);
-    writer.setAutoFormatting(true);
-    writer.writeStartDocument();
-    saveItem(writer,&root);
-    writer.writeEndDocument();
-    playlistFile.close();
+    if(!playListChanged && store->journalRecords()<maxJournalRecords)return;
+    if(!wait && store->isCompacting())return;
+    QVector<PlayListNode> snapshot;
+    snapshotItem(snapshot,&root,0);
+    store->compact(snapshot,wait);
     playListChanged=false;
 }
 
+void PlayList::journalItem(PlayListItem *item, int type)
+{
+    JournalRecord record;
+    record.type=type;
+    record.path=item->path;
+    record.title=item->title;
+    record.animeTitle=item->animeTitle;
+    record.poolID=item->poolID;
+    record.playTime=item->playTime;
+    record.playTimeState=item->playTimeState;
+    store->append(record);
+}
+
 void PlayList::updateRecentlist(PlayListItem *item)
 {
     if(!item)return;
@@ -1197,87 +1411,62 @@ void PlayList::updateRecentlist(PlayListItem *item)
     emit recentItemsUpdated();
 }
 
-void PlayList::saveItem(QXmlStreamWriter &writer, PlayListItem *item)
-{
-    if(item==&root)
-    {
-        writer.writeStartElement("playlist");
-
-    }
-    else if(item->children)
-    {
-        writer.writeStartElement("collection");
-        writer.writeAttribute("title",item->title);
-    }
-    for(PlayListItem *child:*item->children)
-    {
-        if(child->children)
-            saveItem(writer,child);
-        else
-        {
-            writer.writeStartElement("item");
-            writer.writeAttribute("title", child->title);
-            if(!child->animeTitle.isEmpty())
-                writer.writeAttribute("animeTitle",child->animeTitle);
-            if(!child->poolID.isEmpty())
-                writer.writeAttribute("poolID",child->poolID);
-            writer.writeAttribute("playTime",QString::number(child->playTime));
-            writer.writeAttribute("playTimeState",QString::number(child->playTimeState));
-            writer.writeCharacters(child->path);
-            writer.writeEndElement();
-        }
-    }
-    writer.writeEndElement();
-}
-
-PlayListItem::PlayListItem(PlayListItem *parent, bool leaf, int insertPosition):children(nullptr),level(0),playTimeState(0),playTime(0)
+void PlayList::snapshotItem(QVector<PlayListNode> &snapshot, PlayListItem *item, int level)
 {
-    this->parent=parent;
-    if(!leaf)
+    if(item!=&root)
     {
-        children=new QList<PlayListItem *>();
+        PlayListNode node;
+        node.level=level;
+        node.isCollection=item->children!=nullptr;
+        node.title=item->title;
+        node.animeTitle=item->animeTitle;
+        node.poolID=item->poolID;
+        node.path=item->path;
+        node.playTime=item->playTime;
+        node.playTimeState=item->playTimeState;
+        snapshot.append(node);
     }
-    if(parent)
+    if(item->children)
     {
-        if (insertPosition == -1)
-            parent->children->append(this);
-        else
-            parent->children->insert(insertPosition, this);
-        level=parent->level+1;
+        for(PlayListItem *child:*item->children)
+            snapshotItem(snapshot,child,level+1);
     }
 }
 
-PlayListItem::~PlayListItem()
+QModelIndexList PlayListFilterProxyModel::setSearchResults(const QModelIndexList &results)
 {
-    playlist->checkCurrentItem(this);
-    if(children)
+    QModelIndexList collections;
+    QSet<const void *> collectionItems;
+    acceptedItems.clear();
+    for(const QModelIndex &index:results)
     {
-        qDeleteAll(children->begin(),children->end());
-        delete children;
+        acceptedItems.insert(index.internalPointer());
+        for(QModelIndex parent(index.parent());parent.isValid();parent=parent.parent())
+        {
+            if(collectionItems.contains(parent.internalPointer())) break;
+            collectionItems.insert(parent.internalPointer());
+            acceptedItems.insert(parent.internalPointer());
+            collections.append(parent);
+        }
     }
+    useSearchResults=true;
+    //ancestors are in the set already, rows under a rejected collection need not be visited
+    setRecursiveFilteringEnabled(false);
+    invalidateFilter();
+    return collections;
 }
 
-void PlayListItem::setLevel(int newLevel)
+void PlayListFilterProxyModel::clearSearchResults()
 {
-    level=newLevel;
-    if(children)
-    {
-        for(PlayListItem *child:*children)
-            child->setLevel(newLevel+1);
-    }
+    if(!useSearchResults) return;
+    useSearchResults=false;
+    acceptedItems.clear();
+    setRecursiveFilteringEnabled(true);
 }
 
-void PlayListItem::moveTo(PlayListItem *newParent, int insertPosition)
+bool PlayListFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
 {
-    if (parent)
-        parent->children->removeAll(this);
-    if (newParent)
-    {
-        if (insertPosition == -1)
-            newParent->children->append(this);
-        else
-            newParent->children->insert(insertPosition, this);
-        setLevel(newParent->level + 1);
-    }
-    parent = newParent;
+    if(!useSearchResults)
+        return QSortFilterProxyModel::filterAcceptsRow(source_row,source_parent);
+    return acceptedItems.contains(sourceModel()->index(source_row,0,source_parent).internalPointer());
 }
@@ -7,29 +7,19 @@
 #include <QVariant>
 #include <QDataStream>
 #include <QSortFilterProxyModel>
-#include <qDebug>
+#include <QSet>
+#include <QDebug>
+#include "playlistitem.h"
+#include "playlistindex.h"
 
-class QXmlStreamWriter;
 class PlayList;
+class Prefetcher;
+class FolderScanner;
+class PlayListStore;
+class MatchPipeline;
+struct PlayListNode;
+struct ScanBatch;
 struct MatchInfo;
-class PlayListItem
-{
-public:
-    PlayListItem(PlayListItem *parent=nullptr,bool leaf=false,int insertPosition=-1);
-    ~PlayListItem();
-    void setLevel(int newLevel);
-    void moveTo(PlayListItem *newParent, int insertPosition = -1);
-    PlayListItem *parent;
-    QString title;
-    QString animeTitle;
-    QString path;
-    QString poolID;
-    int playTime;
-    int playTimeState;
-    QList<PlayListItem *> *children;
-    int level;
-    static PlayList *playlist;
-};
 class PlayList : public QAbstractItemModel
 {
     Q_OBJECT
@@ -46,12 +36,24 @@ public:
     };
     const int maxRecentItems=4;
     inline const PlayListItem *getCurrentItem() const{return currentItem;}
-    inline QModelIndex getCurrentIndex() const{return currentItem?createIndex(currentItem->parent->children->indexOf(currentItem),0,currentItem):QModelIndex();}
+    inline QModelIndex getCurrentIndex() const{return currentItem?createIndex(currentItem->row(),0,currentItem):QModelIndex();}
     inline const PlayListItem *getItem(const QModelIndex &index){return index.isValid()?static_cast<PlayListItem*>(index.internalPointer()):nullptr; }
     inline LoopMode getLoopMode() const{return loopMode;}
     inline bool canPaste() const {return itemsClipboard.count()>0;}
     QList<QPair<QString,QString> > &recent(){return recentList;}
+    bool isScanning() const;
+    //substring search over title, animeTitle and path, items cut to the clipboard are skipped
+    QModelIndexList search(const QString &text,Qt::CaseSensitivity cs) const;
 private:
+    struct FolderScan
+    {
+        PlayListItem *root;
+        QHash<QString,PlayListItem *> collections;
+        int itemCount;
+    };
+    //declared before root, items removed when root is destroyed still check them
+    QHash<int,FolderScan> folderScans;
+    PlayListIndex searchIndex;
     PlayListItem root;   
     QList<PlayListItem *> itemsClipboard;
     QList<QPair<QString,QString> > recentList;
@@ -59,14 +61,20 @@ private:
     PlayListItem *currentItem;
     bool playListChanged,needRefresh;
     LoopMode loopMode;
+    Prefetcher *prefetcher;
+    FolderScanner *scanner;
+    PlayListStore *store;
+    MatchPipeline *matchPipeline;
 signals:
     void currentInvaild();
     void currentMatchChanged();
     void message(QString msg,int flag);
     void recentItemsUpdated();
+    void scanStateChanged(bool scanning);
 public slots :
     int addItems(QStringList &items, QModelIndex parent);
-    int addFolder(QString folderStr, QModelIndex parent);
+    void addFolder(QString folderStr, QModelIndex parent);
+    void stopScanning();
     QModelIndex addCollection(QModelIndex parent,QString title);
 
     void deleteItems(const QModelIndexList &deleteIndexes);
@@ -83,9 +91,12 @@ public slots :
     const PlayListItem *setCurrentItem(const QString &path);
 	void cleanCurrentItem();
     const PlayListItem *playPrevOrNext(bool prev);
+    void prefetchNext();
     void setLoopMode(LoopMode newMode){this->loopMode=newMode;}
     void checkCurrentItem(PlayListItem *itemDeleted);
+    void checkScanningItem(PlayListItem *itemDeleted);
     void matchItems(const QModelIndexList &matchIndexes);
+    void stopMatching();
     void matchCurrentItem(MatchInfo *matchInfo);
     void matchIndex(QModelIndex &index,MatchInfo *matchInfo);
     void setCurrentPlayTime(int playTime);
@@ -112,10 +123,13 @@ private:
     void loadPlaylist();
     void loadRecentlist();
     void saveRecentlist();
-    void savePlaylist();
+    void savePlaylist(bool wait=false);
+    void journalItem(PlayListItem *item,int type);
     void updateRecentlist(PlayListItem *item);
-    void saveItem(QXmlStreamWriter &writer,PlayListItem *item);
-    bool addSubFolder(QString folderStr, PlayListItem *parent, int &itemCount);
+    void snapshotItem(QVector<PlayListNode> &snapshot,PlayListItem *item,int level);
+    void addScannedFiles(int scanId, const QList<ScanBatch> &batches);
+    void finishScan(int scanId);
+    PlayListItem *getScanCollection(FolderScan &folderScan, const QStringList &relPath);
     PlayListItem *getPrevOrNextItem(LoopMode loopMode,bool prev);
     void updateItemInfo(PlayListItem *item);
     QString setCollectionTitle(QList<PlayListItem *> &list);
@@ -123,4 +137,20 @@ private:
     void dumpItem(QJsonArray &array,PlayListItem *item, QHash<QString, QString> &mediaHash);
 
 };
+class PlayListFilterProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    explicit PlayListFilterProxyModel(QObject *parent = nullptr):QSortFilterProxyModel(parent),useSearchResults(false){}
+    //only the results and their ancestors pass the filter, returns the ancestor collections
+    QModelIndexList setSearchResults(const QModelIndexList &results);
+    void clearSearchResults();
+    inline bool hasSearchResults() const {return useSearchResults;}
+private:
+    bool useSearchResults;
+    QSet<const void *> acceptedItems;
+    // QSortFilterProxyModel interface
+protected:
+    virtual bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const;
+};
 #endif // PLAYLIST_H
@@ -0,0 +1,150 @@
+#include "playlistindex.h"
+#include "playlistitem.h"
+#include <algorithm>
+namespace
+{
+    //removed entries are only dropped once they outnumber the live ones
+    const int minRebuildCount=1024;
+    inline QString itemText(const PlayListItem *item)
+    {
+        return item->title+'\n'+item->animeTitle+'\n'+item->path;
+    }
+}
+
+PlayListIndex::PlayListIndex():removedCount(0)
+{
+
+}
+
+void PlayListIndex::update(const PlayListItem *item)
+{
+    QString text(itemText(item));
+    auto iter=itemIds.constFind(item);
+    if(iter!=itemIds.constEnd())
+    {
+        Entry &entry=entries[iter.value()];
+        if(entry.text==text) return;
+        entry.item=nullptr;
+        entry.text.clear();
+        entry.foldedText.clear();
+        removedCount++;
+    }
+    int id=entries.count();
+    entries.append({item,text,text.toCaseFolded()});
+    itemIds.insert(item,id);
+    addPostings(id);
+    if(removedCount>minRebuildCount && removedCount>itemIds.count()) rebuild();
+}
+
+void PlayListIndex::remove(const PlayListItem *item)
+{
+    auto iter=itemIds.find(item);
+    if(iter==itemIds.end()) return;
+    Entry &entry=entries[iter.value()];
+    entry.item=nullptr;
+    entry.text.clear();
+    entry.foldedText.clear();
+    itemIds.erase(iter);
+    removedCount++;
+    if(itemIds.isEmpty()) clear();
+    else if(removedCount>minRebuildCount && removedCount>itemIds.count()) rebuild();
+}
+
+void PlayListIndex::clear()
+{
+    entries.clear();
+    itemIds.clear();
+    postings.clear();
+    removedCount=0;
+}
+
+QList<const PlayListItem *> PlayListIndex::search(const QString &text, Qt::CaseSensitivity cs) const
+{
+    QList<const PlayListItem *> results;
+    if(text.isEmpty()) return results;
+    QString foldedText(text.toCaseFolded());
+    auto matches=[&](const Entry &entry){
+        return cs==Qt::CaseSensitive?entry.text.contains(text):entry.foldedText.contains(foldedText);
+    };
+    if(foldedText.length()<3)
+    {
+        for(const Entry &entry:entries)
+        {
+            if(entry.item && matches(entry))
+                results.append(entry.item);
+        }
+        return results;
+    }
+    QVector<const QVector<int> *> lists;
+    for(quint64 key:trigrams(foldedText))
+    {
+        auto iter=postings.constFind(key);
+        if(iter==postings.constEnd()) return results;
+        lists.append(&iter.value());
+    }
+    std::sort(lists.begin(),lists.end(),[](const QVector<int> *l1,const QVector<int> *l2){return l1->count()<l2->count();});
+    QVector<int> candidates(*lists.first());
+    for(int i=1;i<lists.count() && !candidates.isEmpty();++i)
+    {
+        const QVector<int> &list=*lists.at(i);
+        QVector<int> rest;
+        if(candidates.count()*16<list.count())
+        {
+            for(int id:candidates)
+                if(std::binary_search(list.cbegin(),list.cend(),id)) rest.append(id);
+        }
+        else
+        {
+            std::set_intersection(candidates.cbegin(),candidates.cend(),list.cbegin(),list.cend(),std::back_inserter(rest));
+        }
+        candidates.swap(rest);
+    }
+    //trigrams only narrow the candidates down, the text itself decides
+    for(int id:candidates)
+    {
+        const Entry &entry=entries.at(id);
+        if(entry.item && matches(entry))
+            results.append(entry.item);
+    }
+    return results;
+}
+
+void PlayListIndex::addPostings(int id)
+{
+    for(quint64 key:trigrams(entries.at(id).foldedText))
+        postings[key].append(id);
+}
+
+void PlayListIndex::rebuild()
+{
+    QVector<Entry> liveEntries;
+    liveEntries.reserve(itemIds.count());
+    for(const Entry &entry:entries)
+    {
+        if(entry.item) liveEntries.append(entry);
+    }
+    entries.swap(liveEntries);
+    itemIds.clear();
+    postings.clear();
+    removedCount=0;
+    for(int i=0;i<entries.count();++i)
+    {
+        itemIds.insert(entries.at(i).item,i);
+        addPostings(i);
+    }
+}
+
+QVector<quint64> PlayListIndex::trigrams(const QString &foldedText)
+{
+    QVector<quint64> keys;
+    const QChar *data=foldedText.constData();
+    for(int i=0;i+2<foldedText.length();++i)
+    {
+        //a query never spans two fields
+        if(data[i]=='\n' || data[i+1]=='\n' || data[i+2]=='\n') continue;
+        keys.append(quint64(data[i].unicode())<<32 | quint64(data[i+1].unicode())<<16 | data[i+2].unicode());
+    }
+    std::sort(keys.begin(),keys.end());
+    keys.erase(std::unique(keys.begin(),keys.end()),keys.end());
+    return keys;
+}
@@ -0,0 +1,37 @@
+#ifndef PLAYLISTINDEX_H
+#define PLAYLISTINDEX_H
+
+#include <QHash>
+#include <QVector>
+#include <QList>
+#include <QString>
+class PlayListItem;
+//trigram index over title, animeTitle and path of playlist items, PlayList updates it whenever these change
+class PlayListIndex
+{
+public:
+    PlayListIndex();
+    void update(const PlayListItem *item);
+    void remove(const PlayListItem *item);
+    void clear();
+    //items containing text, in the order they were indexed
+    QList<const PlayListItem *> search(const QString &text,Qt::CaseSensitivity cs) const;
+private:
+    struct Entry
+    {
+        const PlayListItem *item; //nullptr once removed, its id stays in the posting lists until rebuild
+        QString text;
+        QString foldedText;
+    };
+    QVector<Entry> entries;
+    QHash<const PlayListItem *,int> itemIds;
+    //ids in each list are ascending
+    QHash<quint64,QVector<int> > postings;
+    int removedCount;
+
+    void addPostings(int id);
+    void rebuild();
+    static QVector<quint64> trigrams(const QString &foldedText);
+};
+
+#endif // PLAYLISTINDEX_H
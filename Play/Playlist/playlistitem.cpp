@@ -0,0 +1,67 @@
+#include "playlistitem.h"
+
+std::function<void(PlayListItem *)> PlayListItem::beforeDelete;
+
+PlayListItem::PlayListItem(PlayListItem *parent, bool leaf, int insertPosition):children(nullptr),level(0),playTimeState(0),playTime(0),fileMissing(false),rowIndex(0)
+{
+    this->parent=parent;
+    if(!leaf)
+    {
+        children=new QList<PlayListItem *>();
+    }
+    if(parent)
+    {
+        if (insertPosition == -1)
+        {
+            rowIndex=parent->children->count();
+            parent->children->append(this);
+        }
+        else
+            parent->children->insert(insertPosition, this);
+        level=parent->level+1;
+    }
+}
+
+PlayListItem::~PlayListItem()
+{
+    if(beforeDelete)beforeDelete(this);
+    if(children)
+    {
+        qDeleteAll(children->begin(),children->end());
+        delete children;
+    }
+}
+
+void PlayListItem::updateChildRows() const
+{
+    for(int i=0;i<children->count();++i)
+        children->at(i)->rowIndex=i;
+}
+
+void PlayListItem::setLevel(int newLevel)
+{
+    level=newLevel;
+    if(children)
+    {
+        for(PlayListItem *child:*children)
+            child->setLevel(newLevel+1);
+    }
+}
+
+void PlayListItem::moveTo(PlayListItem *newParent, int insertPosition)
+{
+    if (parent)
+    {
+        int curRow=row();
+        if(curRow>=0)parent->children->removeAt(curRow);
+    }
+    if (newParent)
+    {
+        if (insertPosition == -1)
+            newParent->children->append(this);
+        else
+            newParent->children->insert(insertPosition, this);
+        setLevel(newParent->level + 1);
+    }
+    parent = newParent;
+}
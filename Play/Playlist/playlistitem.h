@@ -0,0 +1,41 @@
+#ifndef PLAYLISTITEM_H
+#define PLAYLISTITEM_H
+
+#include <QList>
+#include <QString>
+#include <functional>
+class PlayListItem
+{
+public:
+    PlayListItem(PlayListItem *parent=nullptr,bool leaf=false,int insertPosition=-1);
+    ~PlayListItem();
+    void setLevel(int newLevel);
+    void moveTo(PlayListItem *newParent, int insertPosition = -1);
+    //the cached row is checked against parent's list, all siblings are renumbered once it goes stale.
+    //-1 if the item is no longer in parent's list, e.g. cut to the clipboard, as indexOf would give
+    inline int row() const
+    {
+        if(!parent)return 0;
+        const QList<PlayListItem *> &siblings=*parent->children;
+        if(siblings.value(rowIndex)==this)return rowIndex;
+        parent->updateChildRows();
+        return siblings.value(rowIndex)==this?rowIndex:-1;
+    }
+    PlayListItem *parent;
+    QString title;
+    QString animeTitle;
+    QString path;
+    QString poolID;
+    int playTime;
+    int playTimeState;
+    bool fileMissing;
+    QList<PlayListItem *> *children;
+    int level;
+    //set by PlayList to drop what it keeps about an item before the item is deleted
+    static std::function<void(PlayListItem *)> beforeDelete;
+private:
+    mutable int rowIndex;
+    void updateChildRows() const;
+};
+
+#endif // PLAYLISTITEM_H
@@ -0,0 +1,190 @@
+#include "playliststore.h"
+#include <QThread>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QXmlStreamWriter>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QDebug>
+namespace
+{
+    inline QString playlistFileName(){return QCoreApplication::applicationDirPath()+"\\playlist.xml";}
+    inline QString journalFileName(){return QCoreApplication::applicationDirPath()+"\\playlist.journal";}
+    //journal moved aside by a compaction that has not been written yet
+    inline QString rotatedJournalFileName(){return QCoreApplication::applicationDirPath()+"\\playlist.journal.0";}
+}
+
+PlayListStore::PlayListStore(QObject *parent) : QObject(parent),recordCount(0),queuedCompactions(0)
+{
+    storeThread=new QThread();
+    storeThread->setObjectName(QStringLiteral("playlistStoreThread"));
+    storeThread->start(QThread::LowPriority);
+    worker=new QObject();
+    worker->moveToThread(storeThread);
+    journal.setFileName(journalFileName());
+}
+
+PlayListStore::~PlayListStore()
+{
+    QObject::connect(storeThread,&QThread::finished,worker,&QObject::deleteLater);
+    storeThread->quit();
+    storeThread->wait();
+    delete storeThread;
+    journal.close();
+}
+
+QList<JournalRecord> PlayListStore::readJournal()
+{
+    QList<JournalRecord> records;
+    readJournalFile(rotatedJournalFileName(),records);
+    readJournalFile(journalFileName(),records);
+    recordCount=records.count();
+    return records;
+}
+
+void PlayListStore::append(const JournalRecord &record)
+{
+    if(!journal.isOpen() && !journal.open(QIODevice::WriteOnly|QIODevice::Append)) return;
+    QDataStream stream(&journal);
+    stream<<record.type<<record.path;
+    switch (record.type)
+    {
+    case JournalRecord::PlayTime:
+        stream<<record.playTime<<record.playTimeState;
+        break;
+    case JournalRecord::Match:
+        stream<<record.title<<record.animeTitle<<record.poolID;
+        break;
+    case JournalRecord::Title:
+        stream<<record.title;
+        break;
+    }
+    journal.flush();
+    recordCount++;
+}
+
+void PlayListStore::compact(const QVector<PlayListNode> &snapshot, bool wait)
+{
+    {
+        QMutexLocker locker(&rotateLock);
+        queuedCompactions.ref();
+        rotateJournal();
+    }
+    recordCount=0;
+    QMetaObject::invokeMethod(worker,[this,snapshot](){
+#ifdef QT_DEBUG
+        QElapsedTimer timer;
+        timer.start();
+#endif
+        bool ret=writePlaylist(snapshot);
+        QMutexLocker locker(&rotateLock);
+        //a later compaction's snapshot covers the rotated journal as well
+        if(!queuedCompactions.deref() && ret)
+            QFile::remove(rotatedJournalFileName());
+#ifdef QT_DEBUG
+        qDebug()<<"playlist compaction:"<<snapshot.count()<<"nodes,"<<timer.elapsed()<<"ms";
+#endif
+    },wait?Qt::BlockingQueuedConnection:Qt::QueuedConnection);
+}
+
+void PlayListStore::checkFiles(const QStringList &paths)
+{
+    QMetaObject::invokeMethod(worker,[this,paths](){
+        QStringList missingFiles;
+        for(const QString &path:paths)
+        {
+            if(!QFileInfo::exists(path))
+                missingFiles.append(path);
+        }
+        if(!missingFiles.isEmpty())
+            emit filesMissing(missingFiles);
+    },Qt::QueuedConnection);
+}
+
+void PlayListStore::rotateJournal()
+{
+    journal.close();
+    if(!journal.exists()) return;
+    if(!QFile::exists(rotatedJournalFileName()))
+    {
+        journal.rename(rotatedJournalFileName());
+        journal.setFileName(journalFileName());
+        return;
+    }
+    QFile rotatedJournal(rotatedJournalFileName());
+    if(journal.open(QIODevice::ReadOnly) && rotatedJournal.open(QIODevice::WriteOnly|QIODevice::Append))
+        rotatedJournal.write(journal.readAll());
+    journal.close();
+    journal.remove();
+}
+
+bool PlayListStore::writePlaylist(const QVector<PlayListNode> &snapshot)
+{
+    QSaveFile playlistFile(playlistFileName());
+    bool ret=playlistFile.open(QIODevice::WriteOnly|QIODevice::Text);
+    if(!ret) return false;
+    QXmlStreamWriter writer(&playlistFile);
+    writer.setAutoFormatting(true);
+    writer.writeStartDocument();
+    writer.writeStartElement("playlist");
+    int openLevel=0;
+    for(const PlayListNode &node:snapshot)
+    {
+        for(;openLevel>=node.level;--openLevel)
+            writer.writeEndElement();
+        if(node.isCollection)
+        {
+            writer.writeStartElement("collection");
+            writer.writeAttribute("title",node.title);
+            openLevel=node.level;
+        }
+        else
+        {
+            writer.writeStartElement("item");
+            writer.writeAttribute("title", node.title);
+            if(!node.animeTitle.isEmpty())
+                writer.writeAttribute("animeTitle",node.animeTitle);
+            if(!node.poolID.isEmpty())
+                writer.writeAttribute("poolID",node.poolID);
+            writer.writeAttribute("playTime",QString::number(node.playTime));
+            writer.writeAttribute("playTimeState",QString::number(node.playTimeState));
+            writer.writeCharacters(node.path);
+            writer.writeEndElement();
+        }
+    }
+    for(;openLevel>0;--openLevel)
+        writer.writeEndElement();
+    writer.writeEndElement();
+    writer.writeEndDocument();
+    return playlistFile.commit();
+}
+
+void PlayListStore::readJournalFile(const QString &fileName, QList<JournalRecord> &records)
+{
+    QFile journalFile(fileName);
+    if(!journalFile.open(QIODevice::ReadOnly)) return;
+    QDataStream stream(&journalFile);
+    while(!stream.atEnd())
+    {
+        JournalRecord record;
+        stream>>record.type>>record.path;
+        switch (record.type)
+        {
+        case JournalRecord::PlayTime:
+            stream>>record.playTime>>record.playTimeState;
+            break;
+        case JournalRecord::Match:
+            stream>>record.title>>record.animeTitle>>record.poolID;
+            break;
+        case JournalRecord::Title:
+            stream>>record.title;
+            break;
+        default:
+            return;
+        }
+        //the last record may be cut off if KikoPlay exited while writing it
+        if(stream.status()!=QDataStream::Ok) return;
+        records.append(record);
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef PLAYLISTSTORE_H
+#define PLAYLISTSTORE_H
+
+#include <QObject>
+#include <QFile>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QVector>
+#include <QStringList>
+class QThread;
+struct PlayListNode
+{
+    int level;
+    bool isCollection;
+    QString title;
+    QString animeTitle;
+    QString poolID;
+    QString path;
+    int playTime;
+    int playTimeState;
+};
+struct JournalRecord
+{
+    enum RecordType
+    {
+        PlayTime=1,
+        Match,
+        Title
+    };
+    quint8 type;
+    QString path;
+    QString title;
+    QString animeTitle;
+    QString poolID;
+    int playTime;
+    int playTimeState;
+};
+//playlist.xml is only rewritten by compaction, changes of single items are appended to a journal in between
+class PlayListStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PlayListStore(QObject *parent = nullptr);
+    ~PlayListStore();
+
+    QList<JournalRecord> readJournal();
+    void append(const JournalRecord &record);
+    inline int journalRecords() const {return recordCount;}
+    inline bool isCompacting() const {return queuedCompactions.load()>0;}
+    //the journal is moved aside at once, the snapshot is written on the store thread
+    void compact(const QVector<PlayListNode> &snapshot,bool wait=false);
+    void checkFiles(const QStringList &paths);
+signals:
+    void filesMissing(const QStringList &paths);
+private:
+    QThread *storeThread;
+    QObject *worker;
+    QFile journal;
+    int recordCount;
+    QMutex rotateLock;
+    QAtomicInt queuedCompactions;
+
+    void rotateJournal();
+    static bool writePlaylist(const QVector<PlayListNode> &snapshot);
+    static void readJournalFile(const QString &fileName, QList<JournalRecord> &records);
+};
+
+#endif // PLAYLISTSTORE_H
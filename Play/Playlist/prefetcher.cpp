@@ -0,0 +1,122 @@
+#include "prefetcher.h"
+#include <QThread>
+#include <QTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSettings>
+#include "globalobjects.h"
+#include "Play/Danmu/danmupool.h"
+#include "Play/Danmu/blocker.h"
+#include "Play/Danmu/providermanager.h"
+#include "Play/Danmu/danmurefresher.h"
+#include "Play/Danmu/Provider/providerbase.h"
+#include "Play/Danmu/Provider/matchprovider.h"
+namespace
+{
+    const int prefetchDelay=10000;
+    void refreshPool(const QString &poolID)
+    {
+        QList<RefreshTask> taskList;
+        QSqlQuery query(QSqlDatabase::database("PF"));
+        query.prepare("select ID,URL,LastDate from source where PoolID=?");
+        query.bindValue(0,poolID);
+        query.exec();
+        while(query.next())
+            taskList.append({poolID,query.value(0).toInt(),query.value(1).toString(),query.value(2).toLongLong()});
+        for(const RefreshTask &task:taskList)
+        {
+            QString providerId(GlobalObjects::providerManager->getProviderId(task.url));
+            if(providerId.isEmpty())continue;
+            QScopedPointer<ProviderBase> provider(GlobalObjects::providerManager->createProvider(providerId));
+            QList<DanmuComment *> danmuList;
+            RefreshWorker::updateSource(provider.data(),task,"PF",danmuList);
+            qDeleteAll(danmuList);
+        }
+    }
+}
+
+Prefetcher::Prefetcher(QObject *parent) : QObject(parent),taskId(0)
+{
+    prefetchThread=new QThread();
+    prefetchThread->setObjectName(QStringLiteral("prefetchThread"));
+    prefetchThread->start(QThread::LowestPriority);
+    worker=new QObject();
+    worker->moveToThread(prefetchThread);
+    QMetaObject::invokeMethod(worker,[](){
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE","PF");
+        database.setDatabaseName(QCoreApplication::applicationDirPath()+"\\kikoplay.db");
+        database.open();
+        QSqlQuery query(QSqlDatabase::database("PF"));
+        query.exec("PRAGMA foreign_keys = ON;");
+    },Qt::QueuedConnection);
+    delayTimer=new QTimer(this);
+    delayTimer->setSingleShot(true);
+    QObject::connect(delayTimer,&QTimer::timeout,this,&Prefetcher::run);
+}
+
+Prefetcher::~Prefetcher()
+{
+    taskId.ref();
+    QObject::connect(prefetchThread,&QThread::finished,worker,&QObject::deleteLater);
+    prefetchThread->quit();
+    prefetchThread->wait();
+    delete prefetchThread;
+}
+
+void Prefetcher::prefetch(const QString &path, const QString &poolID)
+{
+    nextPath=path;
+    nextPoolID=poolID;
+    delayTimer->start(prefetchDelay);
+}
+
+void Prefetcher::cancel()
+{
+    delayTimer->stop();
+    taskId.ref();
+}
+
+void Prefetcher::run()
+{
+    int id=taskId.fetchAndAddOrdered(1)+1;
+    QString path(nextPath),poolID(nextPoolID);
+    bool refresh=GlobalObjects::appSetting->value("Play/PrefetchRefresh",false).toBool();
+    QList<BlockRule *> rules(GlobalObjects::blocker->cloneRules());
+    int blockRevision=GlobalObjects::blocker->getRevision();
+    QMetaObject::invokeMethod(worker,[this,id,path,poolID,refresh,rules,blockRevision](){
+#ifdef QT_DEBUG
+        QElapsedTimer timer;
+        timer.start();
+#endif
+        QString pid(poolID);
+        if(pid.isEmpty() && id==taskId.load())
+        {
+            //the hash is remembered, so playing the item won't read the file again
+            MatchProvider::prefetchHashes(QStringList()<<path);
+            MatchInfo *matchInfo=MatchProvider::MatchFromDB(path,"PF");
+            if(matchInfo)
+            {
+                pid=matchInfo->poolID;
+                emit matchFound(path,pid,matchInfo->matches.first().animeTitle,matchInfo->matches.first().title);
+                delete matchInfo;
+            }
+        }
+        if(!pid.isEmpty() && id==taskId.load())
+        {
+            if(refresh) refreshPool(pid);
+            PoolSnapshot *snapshot=DanmuPool::loadSnapshot(pid,"PF");
+            Blocker::applyRules(rules,snapshot->danmuList);
+            snapshot->blockRevision=blockRevision;
+#ifdef QT_DEBUG
+            qDebug()<<"prefetch:"<<path<<", danmu:"<<snapshot->danmuList.count()<<", time:"<<timer.elapsed()<<"ms";
+#endif
+            QMetaObject::invokeMethod(this,[this,id,snapshot](){
+                if(id==taskId.load())
+                    GlobalObjects::danmuPool->setPrefetchedSnapshot(snapshot);
+                else
+                    delete snapshot;
+            },Qt::QueuedConnection);
+        }
+        qDeleteAll(rules);
+    },Qt::QueuedConnection);
+}
@@ -0,0 +1,28 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <QObject>
+#include <QAtomicInt>
+class QThread;
+class QTimer;
+class Prefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Prefetcher(QObject *parent = nullptr);
+    ~Prefetcher();
+    //starts after a short delay so the current item's own loading goes first
+    void prefetch(const QString &path,const QString &poolID);
+    void cancel();
+signals:
+    void matchFound(const QString &path,const QString &poolID,const QString &animeTitle,const QString &title);
+private:
+    QThread *prefetchThread;
+    QObject *worker;
+    QTimer *delayTimer;
+    QString nextPath,nextPoolID;
+    QAtomicInt taskId;
+    void run();
+};
+
+#endif // PREFETCHER_H
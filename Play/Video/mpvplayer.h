@@ -44,7 +44,6 @@ public:
     QMap<QString,QMap<QString,QString> > getMediaInfo();
     inline int getTime() const{return mpv::qt::get_property(mpv,"playback-time").toDouble();}
     inline int getDuration() const{return currentDuration;}
-    void drawTexture(GLuint texture, float alpha, const QRectF &rect);
 signals:
     void durationChanged(int value);
     void positionChanged(int value);
@@ -94,7 +93,6 @@ private:
     PlayState state;
     QString currentFile;
     DanmuRender *danmuRender;
-    QOpenGLShaderProgram danmuShader;
     QTimer refreshTimer;
     QElapsedTimer elapsedTimer;
     bool danmuHide;
@@ -62,6 +62,10 @@ AddDanmu::AddDanmu(const PlayListItem *item,QWidget *parent) : CFramelessDialog(
     movieLabel->setScaledContents(true);
     downloadingIcon->start();
 
+    cacheLabel=new QLabel(tr("From Cache"),this);
+    cacheLabel->setToolTip(tr("Search result is loaded from the local cache"));
+    cacheLabel->hide();
+
     QHBoxLayout *pageButtonHLayout=new QHBoxLayout();
     pageButtonHLayout->setContentsMargins(0,0,0,0);
     pageButtonHLayout->setSpacing(0);
@@ -69,6 +73,7 @@ AddDanmu::AddDanmu(const PlayListItem *item,QWidget *parent) : CFramelessDialog(
     pageButtonHLayout->addWidget(urlDanmuPage);
     pageButtonHLayout->addWidget(selectedDanmuPage);   
     pageButtonHLayout->addStretch(1);
+    pageButtonHLayout->addWidget(cacheLabel);
     pageButtonHLayout->addWidget(movieLabel);
     danmuVLayout->addLayout(pageButtonHLayout);
 
@@ -113,6 +118,7 @@ void AddDanmu::search()
         searchResultWidget->setEnabled(false);
     QString tmpProviderId=sourceCombo->currentText();
     DanmuAccessResult *searchResult=GlobalObjects::providerManager->search(tmpProviderId,keyword);
+    cacheLabel->setVisible(!searchResult->error && searchResult->fromCache);
     if(searchResult->error)
         QMessageBox::information(this,"Error",searchResult->errorInfo);
     else
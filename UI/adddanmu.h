@@ -36,7 +36,7 @@ private:
     QListWidget *searchResultWidget;
     const QStringList sourceList=QString("Bilibili;Dandan;Tucao;5dm").split(';');
     QTreeWidget *selectedDanmuWidget;
-    QLabel *movieLabel;
+    QLabel *movieLabel,*cacheLabel;
     QString providerId;
 
     void search();
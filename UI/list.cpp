@@ -17,6 +17,7 @@
 #include "Play/Playlist/playlist.h"
 #include "Play/Danmu/blocker.h"
 #include "Play/Danmu/danmurender.h"
+#include "Play/Danmu/danmulistmodel.h"
 namespace
 {
     class TextColorDelegate: public QStyledItemDelegate
@@ -191,7 +192,9 @@ void ListWindow::initActions()
         act_addFolder->setEnabled(false);
         act_addItem->setEnabled(false);
         playlistView->setDragEnabled(false);
+        act_stopMatch->setVisible(true);
         GlobalObjects::playlist->matchItems(indexes);
+        act_stopMatch->setVisible(false);
         actionDisable=false;
         updatePlaylistActions();
         playlistView->setDragEnabled(true);
@@ -210,6 +213,10 @@ void ListWindow::initActions()
         }
     });
 
+    act_stopMatch=new QAction(tr("Stop Associating"),this);
+    act_stopMatch->setVisible(false);
+    QObject::connect(act_stopMatch,&QAction::triggered,GlobalObjects::playlist,&PlayList::stopMatching);
+
     act_addCollection=new QAction(tr("Add Collection"),this);
     QObject::connect(act_addCollection,&QAction::triggered,[this](){
         QSortFilterProxyModel *model = static_cast<QSortFilterProxyModel *>(playlistView->model());
@@ -251,6 +258,11 @@ void ListWindow::initActions()
         if(restorePlayState)GlobalObjects::mpvplayer->setState(MPVPlayer::Play);
     });
 
+    act_stopScan = new QAction(tr("Stop Adding Folder"),this);
+    act_stopScan->setVisible(false);
+    QObject::connect(act_stopScan,&QAction::triggered,GlobalObjects::playlist,&PlayList::stopScanning);
+    QObject::connect(GlobalObjects::playlist,&PlayList::scanStateChanged,act_stopScan,&QAction::setVisible);
+
     act_cut=new QAction(tr("Cut"),this);
     act_cut->setShortcut(QString("Ctrl+X"));
     QObject::connect(act_cut,&QAction::triggered,[this](){
@@ -482,7 +494,14 @@ void ListWindow::initActions()
     });
     act_deleteDanmu=new QAction(tr("Delete"),this);
     QObject::connect(act_deleteDanmu,&QAction::triggered,[this](){
-        GlobalObjects::danmuPool->deleteDanmu(getSelectedDanmu());
+        QSortFilterProxyModel *model = static_cast<QSortFilterProxyModel *>(danmulistView->model());
+        QSet<qint64> ids;
+        for(const QModelIndex &index:danmulistView->selectionModel()->selectedRows())
+        {
+            QSharedPointer<DanmuComment> danmu=danmuListModel->getDanmu(model->mapToSource(index).row());
+            if(danmu)ids.insert(danmu->id);
+        }
+        GlobalObjects::danmuPool->deleteDanmu(ids);
     });
     act_jumpToTime=new QAction(tr("Jump to"),this);
     QObject::connect(act_jumpToTime,&QAction::triggered,[this](){
@@ -505,11 +524,11 @@ QModelIndex ListWindow::getPSParentIndex()
     return model->mapToSource(parentIndex);
 }
 
-QSharedPointer<DanmuComment> &ListWindow::getSelectedDanmu()
+QSharedPointer<DanmuComment> ListWindow::getSelectedDanmu()
 {
     QModelIndexList &selection =danmulistView->selectionModel()->selectedRows();
     QSortFilterProxyModel *model = static_cast<QSortFilterProxyModel *>(danmulistView->model());
-    return GlobalObjects::danmuPool->getDanmu(model->mapToSource(selection.last()).row());
+    return danmuListModel->getDanmu(model->mapToSource(selection.last()).row());
 }
 
 void ListWindow::updatePlaylistActions()
@@ -577,15 +596,37 @@ QWidget *ListWindow::setupPlaylistPage()
     playlistView->setIndentation(12*logicalDpiX()/96);
     playlistView->setItemDelegate(new TextColorDelegate(this));
 
-    QSortFilterProxyModel *proxyModel=new QSortFilterProxyModel(this);
+    PlayListFilterProxyModel *proxyModel=new PlayListFilterProxyModel(this);
     proxyModel->setRecursiveFilteringEnabled(true);
     proxyModel->setSourceModel(GlobalObjects::playlist);
     playlistView->setModel(proxyModel);
 
+    //fixed strings are looked up in the playlist's index, the proxy only checks the result set
     QObject::connect(filter,&FilterBox::filterChanged,[proxyModel,filter,this](){
-        QRegExp regExp(filter->text(),filter->caseSensitivity(),filter->patternSyntax());
-        proxyModel->setFilterRegExp(regExp);
+        if(filter->patternSyntax()==QRegExp::FixedString && !filter->text().isEmpty())
+        {
+            QModelIndexList results(GlobalObjects::playlist->search(filter->text(),filter->caseSensitivity()));
+            for(const QModelIndex &collection:proxyModel->setSearchResults(results))
+                playlistView->expand(proxyModel->mapFromSource(collection));
+        }
+        else
+        {
+            proxyModel->clearSearchResults();
+            QRegExp regExp(filter->text(),filter->caseSensitivity(),filter->patternSyntax());
+            proxyModel->setFilterRegExp(regExp);
+        }
     });
+    QTimer *searchRefreshTimer=new QTimer(this);
+    searchRefreshTimer->setSingleShot(true);
+    QObject::connect(searchRefreshTimer,&QTimer::timeout,[proxyModel,filter](){
+        if(proxyModel->hasSearchResults())
+            proxyModel->setSearchResults(GlobalObjects::playlist->search(filter->text(),filter->caseSensitivity()));
+    });
+    auto refreshSearch=[proxyModel,searchRefreshTimer](){
+        if(proxyModel->hasSearchResults() && !searchRefreshTimer->isActive()) searchRefreshTimer->start(0);
+    };
+    QObject::connect(GlobalObjects::playlist,&PlayList::rowsInserted,this,refreshSearch);
+    QObject::connect(GlobalObjects::playlist,&PlayList::dataChanged,this,refreshSearch);
 
     QObject::connect(playlistView, &QTreeView::doubleClicked, [this](const QModelIndex &index) {
         playItem(index, false);
@@ -595,10 +636,12 @@ QWidget *ListWindow::setupPlaylistPage()
     QMenu *playlistContextMenu=new QMenu(playlistView);
     playlistContextMenu->addAction(act_play);
     playlistContextMenu->addAction(act_autoAssociate);
+    playlistContextMenu->addAction(act_stopMatch);
     QMenu *addSubMenu=new QMenu(tr("Add"),playlistContextMenu);
     addSubMenu->addAction(act_addCollection);
     addSubMenu->addAction(act_addItem);
     addSubMenu->addAction(act_addFolder);
+    addSubMenu->addAction(act_stopScan);
     playlistContextMenu->addMenu(addSubMenu);
     playlistContextMenu->addSeparator();
     QMenu *editSubMenu=new QMenu(tr("Edit"),playlistContextMenu);
@@ -637,6 +680,7 @@ QWidget *ListWindow::setupPlaylistPage()
     tb_add->addAction(act_addCollection);
     tb_add->addAction(act_addItem);
     tb_add->addAction(act_addFolder);
+    tb_add->addAction(act_stopScan);
     tb_add->setPopupMode(QToolButton::InstantPopup);
     tb_add->setToolTip(tr("Add"));
 
@@ -701,7 +745,8 @@ QWidget *ListWindow::setupDanmulistPage()
     danmulistView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     danmulistView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     danmulistView->setFont(normalFont);
-    danmulistView->setSelectionMode(QAbstractItemView::SelectionMode::SingleSelection);
+    danmulistView->setSelectionMode(QAbstractItemView::SelectionMode::ExtendedSelection);
+    danmulistView->setUniformRowHeights(true);
     danmulistView->setItemDelegate(new TextColorDelegate(this));
 
     danmulistView->setContextMenuPolicy(Qt::ActionsContextMenu);
@@ -721,7 +766,8 @@ QWidget *ListWindow::setupDanmulistPage()
     danmulistView->addAction(act_jumpToTime);
 
     QSortFilterProxyModel *proxyModel = new QSortFilterProxyModel(this);
-    proxyModel->setSourceModel(GlobalObjects::danmuPool);
+    danmuListModel=new DanmuListModel(GlobalObjects::danmuPool,this);
+    proxyModel->setSourceModel(danmuListModel);
     danmulistView->setModel(proxyModel);
 	QObject::connect(danmulistView->selectionModel(), &QItemSelectionModel::selectionChanged, this, &ListWindow::updateDanmuActions);
 
@@ -779,7 +825,7 @@ QWidget *ListWindow::setupDanmulistPage()
     locatePosition->setToolTip(tr("Position"));
 	QObject::connect(locatePosition, &QToolButton::clicked, [this]() {
 		QSortFilterProxyModel *model = static_cast<QSortFilterProxyModel *>(danmulistView->model());
-		QModelIndex curIndex = model->mapFromSource(GlobalObjects::danmuPool->getCurrentIndex());
+		QModelIndex curIndex = model->mapFromSource(danmuListModel->getCurrentIndex());
 		danmulistView->scrollTo(curIndex, QAbstractItemView::PositionAtTop);
 	});
 
@@ -12,6 +12,7 @@
 #include <QRegExp>
 #include <QStyledItemDelegate>
 class DanmuComment;
+class DanmuListModel;
 class FilterBox : public QLineEdit
 {
     Q_OBJECT
@@ -41,24 +42,25 @@ public:
 private:
     void initActions();
     inline QModelIndex getPSParentIndex();
-    inline QSharedPointer<DanmuComment> &getSelectedDanmu();
+    inline QSharedPointer<DanmuComment> getSelectedDanmu();
 
     QWidget *infoTip;
 
     QTreeView *playlistView;
     QToolButton *playlistPageButton,*danmulistPageButton;
     QStackedLayout *contentStackLayout;
-    QAction *act_play,*act_addCollection,*act_addItem,*act_addFolder,
+    QAction *act_play,*act_addCollection,*act_addItem,*act_addFolder,*act_stopScan,
             *act_cut,*act_paste,*act_moveUp,*act_moveDown,*act_merge,
             *act_remove,*act_clear,
             *act_sortSelectionAscending,*act_sortSelectionDescending,*act_sortAllAscending,*act_sortAllDescending,
             *act_noLoopOne,*act_noLoopAll,*act_loopOne,*act_loopAll,*act_random,
-            *act_browseFile,*act_autoAssociate;
+            *act_browseFile,*act_autoAssociate,*act_stopMatch;
     bool actionDisable;
     QActionGroup *loopModeGroup;
     QWidget *setupPlaylistPage();
 
     QTreeView *danmulistView;
+    DanmuListModel *danmuListModel;
     QWidget *setupDanmulistPage();
     QAction *act_addOnlineDanmu,*act_addLocalDanmu,*act_editPool,*act_editBlock,*act_exportAll,
             *act_copyDanmuText,*act_copyDanmuColor,*act_copyDanmuSender,
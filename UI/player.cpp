@@ -18,6 +18,7 @@
 #include "mpvlog.h"
 #include "Play/Playlist/playlist.h"
 #include "Play/Danmu/danmurender.h"
+#include "Play/Video/mpvplayer.h"
 #include "Play/Danmu/Provider/localprovider.h"
 #include "Play/Danmu/danmupool.h"
 #include "Play/Danmu/blocker.h"
@@ -169,6 +170,9 @@ public:
     explicit DanmuStatisInfo(QWidget *parent=nullptr):QWidget(parent),duration(0)
     {
         QObject::connect(GlobalObjects::danmuPool,&DanmuPool::statisInfoChange,this,(void (DanmuStatisInfo:: *)())&DanmuStatisInfo::update);
+        QObject::connect(GlobalObjects::danmuRender,&DanmuRender::shedStatisChanged,this,[this](){
+            if(isVisible())update();
+        });
         setObjectName(QStringLiteral("DanmuStatisBar"));
     }
     int duration;
@@ -180,20 +184,31 @@ protected:
         painter.fillRect(bRect,QColor(0,0,0,150));
         if(duration==0)return;
         bRect.adjust(1, 0, -1, 0);
-        auto &statisInfo=GlobalObjects::danmuPool->getStatisInfo();
-        float hRatio=(float)bRect.height()/statisInfo.maxCountOfMinute;
+        const DanmuDensity &density=GlobalObjects::danmuPool->getDensity();
         float margin=8*logicalDpiX()/96;
+        //buckets narrower than a pixel would be drawn on top of each other
+        DanmuDensity::Level level=DanmuDensity::levelFor(duration,int(bRect.width()-margin*2));
+        const QVector<int> &buckets=density.buckets(level);
+        int maxCount=density.maxCount(level);
+        int bucketSeconds=DanmuDensity::bucketSeconds(level);
+        float hRatio=maxCount>0?(float)bRect.height()/maxCount:0;
         float wRatio=(float)(bRect.width()-margin*2)/duration;
+        float bWidth=wRatio*bucketSeconds;
         float bHeight=bRect.height();
         QColor barColor(51,168,255,200);
-        for(auto iter=statisInfo.countOfMinute.cbegin();iter!=statisInfo.countOfMinute.cend();++iter)
+        for(int i=0;i<buckets.size();++i)
         {
-            float l((*iter).first*wRatio);
-            float h(floor((*iter).second*hRatio));
-            painter.fillRect(l+margin,bHeight-h,wRatio<1.f?1.f:wRatio,h,barColor);
+            if(buckets.at(i)==0)continue;
+            float l(i*bWidth);
+            float h(floor(buckets.at(i)*hRatio));
+            painter.fillRect(l+margin,bHeight-h,bWidth<1.f?1.f:bWidth,h,barColor);
         }
         painter.setPen(QColor(255,255,255));
-        painter.drawText(bRect,Qt::AlignLeft|Qt::AlignTop,QObject::tr("Total:%1 Max:%2").arg(QString::number(GlobalObjects::danmuPool->totalCount())).arg(statisInfo.maxCountOfMinute));
+        QString statisText(QObject::tr("Total:%1 Max:%2").arg(QString::number(GlobalObjects::danmuPool->totalCount())).arg(maxCount));
+        const ShedStatisInfo &shed=GlobalObjects::danmuRender->getShedStatis();
+        if(shed.total>0)
+            statisText+=QObject::tr(" Shed:%1 (Duplicate:%2 Sender:%3 Even:%4)").arg(shed.total).arg(shed.duplicate).arg(shed.sender).arg(shed.even);
+        painter.drawText(bRect,Qt::AlignLeft|Qt::AlignTop,statisText);
     }
 };
 }
@@ -920,6 +935,21 @@ void PlayerWindow::setupPlaySettingPage()
     });
     dbClickBehaviorCombo->setCurrentIndex(GlobalObjects::appSetting->value("Play/DBClickBehavior",0).toInt());
 
+    QCheckBox *prefetchRefresh=new QCheckBox(tr("Update the next item's danmu sources in advance"),playSettingPage);
+    prefetchRefresh->setChecked(GlobalObjects::appSetting->value("Play/PrefetchRefresh",false).toBool());
+    QObject::connect(prefetchRefresh,&QCheckBox::stateChanged,[](int state){
+        GlobalObjects::appSetting->setValue("Play/PrefetchRefresh",state==Qt::Checked);
+    });
+
+    QLabel *poolCacheLabel=new QLabel(tr("Recent Danmu Pools Memory(MB)"),playSettingPage);
+    QSpinBox *poolCacheSpinBox=new QSpinBox(playSettingPage);
+    poolCacheSpinBox->setRange(0,4096);
+    poolCacheSpinBox->setAlignment(Qt::AlignCenter);
+    poolCacheSpinBox->setValue(GlobalObjects::appSetting->value("Play/PoolCacheSize",128).toInt());
+    QObject::connect(poolCacheSpinBox,&QSpinBox::editingFinished,[poolCacheSpinBox](){
+        GlobalObjects::appSetting->setValue("Play/PoolCacheSize",poolCacheSpinBox->value());
+    });
+
     QToolButton *playPage=new QToolButton(playSettingPage);
     playPage->setText(tr("Play"));
     playPage->setCheckable(true);
@@ -983,11 +1013,14 @@ void PlayerWindow::setupPlaySettingPage()
     QGridLayout *appearanceGLayout=new QGridLayout(pageBehavior);
     appearanceGLayout->setContentsMargins(0,0,0,0);
     appearanceGLayout->setColumnStretch(1, 1);
-    appearanceGLayout->setRowStretch(2,1);
+    appearanceGLayout->setRowStretch(4,1);
     appearanceGLayout->addWidget(clickBehaivorLabel,0,0);
     appearanceGLayout->addWidget(clickBehaviorCombo,0,1);
     appearanceGLayout->addWidget(dbClickBehaivorLabel,1,0);
     appearanceGLayout->addWidget(dbClickBehaviorCombo,1,1);
+    appearanceGLayout->addWidget(prefetchRefresh,2,0,1,2);
+    appearanceGLayout->addWidget(poolCacheLabel,3,0);
+    appearanceGLayout->addWidget(poolCacheSpinBox,3,1);
 }
 
 void PlayerWindow::setupSignals()
@@ -1002,6 +1035,7 @@ void PlayerWindow::setupSignals()
         totalTimeStr=QString("/%1:%2").arg(lmin,2,10,QChar('0')).arg(ls,2,10,QChar('0'));
         timeLabel->setText("00:00"+this->totalTimeStr);
         static_cast<DanmuStatisInfo *>(danmuStatisBar)->duration=ts;
+        GlobalObjects::danmuRender->resetShedStatis();
         const PlayListItem *currentItem=GlobalObjects::playlist->getCurrentItem();
         if(currentItem->animeTitle.isEmpty())
         {
@@ -1032,6 +1066,7 @@ void PlayerWindow::setupSignals()
             GlobalObjects::mpvplayer->seek(currentItem->playTime*1000);
             showMessage(tr("Jumped to the last play position"));
         }
+        GlobalObjects::playlist->prefetchNext();
     });
     QObject::connect(GlobalObjects::playlist,&PlayList::currentMatchChanged,[this](){
         const PlayListItem *currentItem=GlobalObjects::playlist->getCurrentItem();
@@ -1153,7 +1188,12 @@ void PlayerWindow::setupSignals()
         int cs=pos/1000;
         int cmin=cs/60;
         int cls=cs-cmin*60;
-        timeInfoTip->setText(QString("%1:%2").arg(cmin,2,10,QChar('0')).arg(cls,2,10,QChar('0')));
+        QString timeText(QString("%1:%2").arg(cmin,2,10,QChar('0')).arg(cls,2,10,QChar('0')));
+        //comments within 5s around the position
+        int nearbyCount=GlobalObjects::danmuPool->rangeCount(pos-5000,pos+5000);
+        if(nearbyCount>0)
+            timeText+=QString(" ")+tr("Danmu:%1").arg(nearbyCount);
+        timeInfoTip->setText(timeText);
         timeInfoTip->adjustSize();
         int ty=danmuStatisBar->isHidden()?height()-controlPanelHeight-timeInfoTip->height():height()-controlPanelHeight-timeInfoTip->height()-statisBarHeight;
         timeInfoTip->move(x-timeInfoTip->width()/3,ty);
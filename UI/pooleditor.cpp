@@ -58,6 +58,7 @@ PoolItem::PoolItem(DanmuSourceInfo *sourceInfo, QWidget *parent):source(sourceIn
            sourceInfo->show=false;
        else
            sourceInfo->show=true;
+       GlobalObjects::danmuPool->markChanged();
     });
     QHBoxLayout *itemControlHLayout1=new QHBoxLayout();
     itemControlHLayout1->addWidget(name);
@@ -109,25 +110,9 @@ PoolItem::PoolItem(DanmuSourceInfo *sourceInfo, QWidget *parent):source(sourceIn
         deleteButton->setEnabled(false);
         editTimeline->setEnabled(false);
         delaySpinBox->setEnabled(false);
-        QString errInfo = GlobalObjects::providerManager->downloadBySourceURL(sourceInfo->url,tmpList);
+        QString errInfo = GlobalObjects::providerManager->updateSource(GlobalObjects::danmuPool->getPoolID(),*sourceInfo,tmpList);
         if(errInfo.isEmpty())
         {
-            if(tmpList.count()>0)
-            {
-                QSet<QString> danmuHashSet(GlobalObjects::danmuPool->getDanmuHash(sourceInfo->id));
-                for(auto iter=tmpList.begin();iter!=tmpList.end();)
-                {
-                    QByteArray hashData(QString("%0%1%2%3").arg((*iter)->text).arg((*iter)->originTime).arg((*iter)->sender).arg((*iter)->color).toUtf8());
-                    QString danmuHash(QString(QCryptographicHash::hash(hashData,QCryptographicHash::Md5).toHex()));
-                    if(danmuHashSet.contains(danmuHash))
-                    {
-                        delete *iter;
-                        iter=tmpList.erase(iter);
-                    }
-                    else
-                        ++iter;
-                }
-            }
             if(tmpList.count()>0)
             {
                 DanmuSourceInfo si;
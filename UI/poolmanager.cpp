@@ -7,7 +7,9 @@
 #include <QGridLayout>
 #include <QMessageBox>
 #include <QSortFilterProxyModel>
+#include <QLabel>
 #include "Play/Danmu/danmumanager.h"
+#include "Play/Danmu/danmurefresher.h"
 #include "globalobjects.h"
 
 PoolManager::PoolManager(QWidget *parent) : CFramelessDialog(tr("Danmu Pool Manager"),parent)
@@ -79,6 +81,50 @@ PoolManager::PoolManager(QWidget *parent) : CFramelessDialog(tr("Danmu Pool Mana
         deletePool->setEnabled(true);
     });
 
+    DanmuRefresher *refresher=GlobalObjects::danmuManager->getRefresher();
+    QPushButton *refreshPool=new QPushButton(refresher->isRunning()?tr("Stop Refreshing"):tr("Refresh Pool(s)"),this);
+    QPushButton *resumeRefresh=new QPushButton(tr("Resume Refreshing"),this);
+    resumeRefresh->setVisible(!refresher->isRunning() && refresher->hasPending());
+    QLabel *refreshTip=new QLabel(this);
+    QObject::connect(refreshPool,&QPushButton::clicked,[poolView,refresher,refreshPool,resumeRefresh](){
+        if(refresher->isRunning())
+        {
+            refresher->stop();
+            refreshPool->setEnabled(false);
+            return;
+        }
+        auto selection = poolView->selectionModel()->selectedRows();
+        if (selection.size() == 0)return;
+        QSortFilterProxyModel *model = static_cast<QSortFilterProxyModel *>(poolView->model());
+        QModelIndexList tmpList;
+        for(const QModelIndex &index:selection)
+        {
+            tmpList.append(model->mapToSource(index));
+        }
+        GlobalObjects::danmuManager->refreshPool(tmpList);
+        if(refresher->isRunning())
+        {
+            refreshPool->setText(tr("Stop Refreshing"));
+            resumeRefresh->hide();
+        }
+    });
+    QObject::connect(resumeRefresh,&QPushButton::clicked,[refresher,refreshPool,resumeRefresh](){
+        refresher->resume();
+        resumeRefresh->hide();
+        if(refresher->isRunning())
+            refreshPool->setText(tr("Stop Refreshing"));
+    });
+    QObject::connect(refresher,&DanmuRefresher::progress,refreshTip,[refreshTip](int done,int total,int newDanmu,int failed){
+        refreshTip->setText(tr("Refreshing %1/%2, %3 New Danmu, %4 Failed").arg(done).arg(total).arg(newDanmu).arg(failed));
+    });
+    QObject::connect(refresher,&DanmuRefresher::finished,this,[refresher,refreshPool,resumeRefresh,refreshTip](bool canceled){
+        refreshPool->setText(tr("Refresh Pool(s)"));
+        refreshPool->setEnabled(true);
+        resumeRefresh->setVisible(refresher->hasPending());
+        refreshTip->setText(canceled?tr("Refreshing Stopped"):tr("Refreshing Done"));
+        GlobalObjects::danmuManager->refreshPoolInfo();
+    });
+
     QLineEdit *searchEdit=new QLineEdit(this);
     searchEdit->setPlaceholderText(tr("Search"));
     searchEdit->setMinimumWidth(150*logicalDpiX()/96);
@@ -91,10 +137,13 @@ PoolManager::PoolManager(QWidget *parent) : CFramelessDialog(tr("Danmu Pool Mana
     QGridLayout *managerGLayout=new QGridLayout(this);
     managerGLayout->addWidget(exportPool,0,0);
     managerGLayout->addWidget(deletePool,0,1);
-    managerGLayout->addWidget(searchEdit,0,3);
-    managerGLayout->addWidget(poolView,1,0,1,4);
+    managerGLayout->addWidget(refreshPool,0,2);
+    managerGLayout->addWidget(resumeRefresh,0,3);
+    managerGLayout->addWidget(refreshTip,0,4);
+    managerGLayout->addWidget(searchEdit,0,5);
+    managerGLayout->addWidget(poolView,1,0,1,6);
     managerGLayout->setRowStretch(1,1);
-    managerGLayout->setColumnStretch(2,1);
+    managerGLayout->setColumnStretch(4,1);
     managerGLayout->setContentsMargins(0, 0, 0, 0);
     resize(620*logicalDpiX()/96, 420*logicalDpiY()/96);
     QHeaderView *poolHeader = poolView->header();
@@ -9,9 +9,11 @@
 #include "LANServer/lanserver.h"
 #include "Download/downloadmodel.h"
 #include "Play/Danmu/danmumanager.h"
+#include "Play/Danmu/Provider/matchprovider.h"
 
 #include <QSqlDatabase>
 #include <QSqlQuery>
+#include <QSqlRecord>
 #include <QApplication>
 #include <QSqlError>
 
@@ -38,6 +40,12 @@ void GlobalObjects::init()
     danmuPool=new DanmuPool();
     danmuRender=new DanmuRender();
     mpvplayer->setDanmuRender(danmuRender);
+    QObject::connect(mpvplayer,&MPVPlayer::initContext,danmuRender,[](){
+        danmuRender->initContext(mpvplayer->context());
+    });
+    QObject::connect(mpvplayer,&MPVPlayer::resized,danmuRender,[](){
+        danmuRender->setSurfaceSize(mpvplayer->size());
+    });
     QObject::connect(mpvplayer,&MPVPlayer::positionChanged, danmuPool,&DanmuPool::mediaTimeElapsed);
     QObject::connect(mpvplayer,&MPVPlayer::positionJumped,danmuPool,&DanmuPool::mediaTimeJumped);
     playlist=new PlayList();
@@ -72,6 +80,8 @@ void GlobalObjects::clear()
 { 
     workThread->quit();
     workThread->wait();
+    //queued saves won't run once the event loop is gone
+    MatchProvider::flushFileHashes();
 	mpvplayer->deleteLater();
 	danmuRender->deleteLater();
 	danmuPool->deleteLater();
@@ -114,6 +124,7 @@ void GlobalObjects::initDatabase()
                           'Source'  INTEGER,\
                           'User'  TEXT,\
                           'Text'  TEXT,\
+                          'Hash'  INTEGER,\
                           CONSTRAINT 'PoolID' FOREIGN KEY ('PoolID') REFERENCES 'bangumi' ('PoolID') ON DELETE CASCADE\
                           );");
         sqlQuery.exec("CREATE TABLE 'source' (\
@@ -123,6 +134,7 @@ void GlobalObjects::initDatabase()
                            'Delay'  INTEGER,\
                            'URL'  TEXT,\
                            'TimeLine'  TEXT,\
+                           'LastDate'  INTEGER DEFAULT 0,\
                            CONSTRAINT 'PoolID' FOREIGN KEY ('PoolID') REFERENCES 'bangumi' ('PoolID') ON DELETE CASCADE\
                            );");
         sqlQuery.exec("CREATE TABLE 'match' (\
@@ -187,4 +199,17 @@ void GlobalObjects::initDatabase()
                             CONSTRAINT 'Anime' FOREIGN KEY ('Anime') REFERENCES 'anime' ('Anime') ON DELETE CASCADE ON UPDATE CASCADE\
                             );");
     }
+    //columns added after the tables were first created
+    if(!database.record("danmu").contains("Hash"))
+        query.exec("ALTER TABLE 'danmu' ADD COLUMN 'Hash' INTEGER;");
+    if(!database.record("source").contains("LastDate"))
+        query.exec("ALTER TABLE 'source' ADD COLUMN 'LastDate' INTEGER DEFAULT 0;");
+    //tables added later
+    query.exec("CREATE TABLE IF NOT EXISTS 'fingerprint' (\
+                   'Path'  TEXT NOT NULL,\
+                   'Size'  INTEGER,\
+                   'MTime'  INTEGER,\
+                   'MD5'  TEXT,\
+                   PRIMARY KEY ('Path')\
+                   );");
 }
@@ -0,0 +1,9 @@
+include(../common/common.pri)
+include(../common/danmucore.pri)
+
+QT += testlib
+TARGET = blockerbench
+TEMPLATE = app
+
+SOURCES += \
+    tst_blockerbench.cpp
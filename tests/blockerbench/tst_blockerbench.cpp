@@ -0,0 +1,122 @@
+#include <QtTest>
+#include <QSqlQuery>
+#include "globalobjects.h"
+#include "danmugenerator.h"
+#include "fixturedb.h"
+#include "Play/Danmu/danmupool.h"
+#include "Play/Danmu/blocker.h"
+namespace
+{
+    struct RuleSet
+    {
+        int textRules;
+        int regExpRules;
+        int senderRules;
+        int colorRules;
+    };
+    //rules are written to the block table, the Blocker reads them like it does on startup
+    void writeRules(const RuleSet &ruleSet)
+    {
+        QSqlQuery query(QSqlDatabase::database("MT"));
+        query.exec("delete from block");
+        query.prepare("insert into block(Id,Field,Relation,IsRegExp,Enable,Content) values(?,?,?,?,1,?)");
+        int id=1;
+        auto addRule=[&query,&id](BlockRule::Field field,BlockRule::Relation relation,bool isRegExp,const QString &content){
+            query.bindValue(0,id++);
+            query.bindValue(1,int(field));
+            query.bindValue(2,int(relation));
+            query.bindValue(3,isRegExp?1:0);
+            query.bindValue(4,content);
+            query.exec();
+        };
+        for(int i=0;i<ruleSet.textRules;++i)
+            addRule(BlockRule::DanmuText,BlockRule::Contain,false,QString("blocked%1").arg(i));
+        for(int i=0;i<ruleSet.regExpRules;++i)
+            addRule(BlockRule::DanmuText,i%2?BlockRule::Equal:BlockRule::Contain,true,QString("^(233|666)+%1.*$").arg(i));
+        for(int i=0;i<ruleSet.senderRules;++i)
+            addRule(BlockRule::DanmuSender,BlockRule::Equal,false,QString("u%1").arg(i*37));
+        for(int i=0;i<ruleSet.colorRules;++i)
+            addRule(BlockRule::DanmuColor,BlockRule::NotEqual,false,"ffffff");
+    }
+}
+Q_DECLARE_METATYPE(RuleSet)
+class BlockerBench : public QObject
+{
+    Q_OBJECT
+private:
+    QList<DanmuComment *> danmuList;
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void checkDanmu_data();
+    void checkDanmu();
+    void checkSharedDanmu_data();
+    void checkSharedDanmu();
+};
+
+void BlockerBench::initTestCase()
+{
+    QVERIFY(FixtureDB::create("MT"));
+    DanmuWorkload workload;
+    workload.duration=1000;
+    workload.commentsPerSecond=100;
+    danmuList=DanmuGenerator::generate(workload);
+    GlobalObjects::danmuPool=new DanmuPool;
+}
+
+void BlockerBench::cleanupTestCase()
+{
+    delete GlobalObjects::danmuPool;
+    qDeleteAll(danmuList);
+    FixtureDB::remove("MT");
+}
+
+void BlockerBench::checkDanmu_data()
+{
+    QTest::addColumn<RuleSet>("ruleSet");
+    QTest::newRow("none") << RuleSet{0,0,0,0};
+    QTest::newRow("text-10") << RuleSet{10,0,0,0};
+    QTest::newRow("text-100") << RuleSet{100,0,0,0};
+    QTest::newRow("regexp-10") << RuleSet{0,10,0,0};
+    QTest::newRow("regexp-50") << RuleSet{0,50,0,0};
+    QTest::newRow("sender-100") << RuleSet{0,0,100,0};
+    QTest::newRow("color-1") << RuleSet{0,0,0,1};
+    QTest::newRow("mixed") << RuleSet{20,10,20,1};
+}
+
+void BlockerBench::checkDanmu()
+{
+    QFETCH(RuleSet, ruleSet);
+    writeRules(ruleSet);
+    Blocker blocker;
+    QBENCHMARK
+    {
+        blocker.checkDanmu(danmuList);
+    }
+}
+
+void BlockerBench::checkSharedDanmu_data()
+{
+    checkDanmu_data();
+}
+
+void BlockerBench::checkSharedDanmu()
+{
+    QFETCH(RuleSet, ruleSet);
+    writeRules(ruleSet);
+    Blocker blocker;
+    QList<QSharedPointer<DanmuComment> > sharedList;
+    for(DanmuComment *danmu:danmuList)
+    {
+        DanmuComment *copy=new DanmuComment(*danmu);
+        sharedList.append(QSharedPointer<DanmuComment>(copy));
+    }
+    QBENCHMARK
+    {
+        blocker.checkDanmu(sharedList);
+    }
+}
+
+QTEST_MAIN(BlockerBench)
+
+#include "tst_blockerbench.moc"
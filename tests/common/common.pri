@@ -0,0 +1,20 @@
+# Shared by all test and benchmark targets. Sources of the player are compiled into each
+# target directly, GlobalObjects::init is never called and every target sets up what it needs.
+
+QT += core gui sql widgets
+CONFIG += c++11 console
+CONFIG -= app_bundle
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += \
+    $$PWD \
+    $$PWD/../..
+
+SOURCES += \
+    $$PWD/testglobals.cpp \
+    $$PWD/danmugenerator.cpp \
+    $$PWD/fixturedb.cpp
+
+HEADERS += \
+    $$PWD/danmugenerator.h \
+    $$PWD/fixturedb.h
@@ -0,0 +1,28 @@
+# The danmu engine: pool, blocker, render, layouts and the local XML parser
+
+SOURCES += \
+    $$PWD/../../Play/Danmu/common.cpp \
+    $$PWD/../../Play/Danmu/danmupool.cpp \
+    $$PWD/../../Play/Danmu/danmudensity.cpp \
+    $$PWD/../../Play/Danmu/blocker.cpp \
+    $$PWD/../../Play/Danmu/danmurender.cpp \
+    $$PWD/../../Play/Danmu/layoutplanner.cpp \
+    $$PWD/../../Play/Danmu/Layouts/rolllayout.cpp \
+    $$PWD/../../Play/Danmu/Layouts/toplayout.cpp \
+    $$PWD/../../Play/Danmu/Layouts/bottomlayout.cpp \
+    $$PWD/../../Play/Danmu/Layouts/danmugrid.cpp \
+    $$PWD/../../Play/Danmu/Provider/localprovider.cpp
+
+HEADERS += \
+    $$PWD/../../Play/Danmu/common.h \
+    $$PWD/../../Play/Danmu/danmupool.h \
+    $$PWD/../../Play/Danmu/danmudensity.h \
+    $$PWD/../../Play/Danmu/blocker.h \
+    $$PWD/../../Play/Danmu/danmurender.h \
+    $$PWD/../../Play/Danmu/layoutplanner.h \
+    $$PWD/../../Play/Danmu/Layouts/danmulayout.h \
+    $$PWD/../../Play/Danmu/Layouts/rolllayout.h \
+    $$PWD/../../Play/Danmu/Layouts/toplayout.h \
+    $$PWD/../../Play/Danmu/Layouts/bottomlayout.h \
+    $$PWD/../../Play/Danmu/Layouts/danmugrid.h \
+    $$PWD/../../Play/Danmu/Provider/localprovider.h
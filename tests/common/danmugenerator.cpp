@@ -0,0 +1,100 @@
+#include "danmugenerator.h"
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include "Play/Danmu/common.h"
+namespace
+{
+    const int recentTextCount=64;
+    const qint64 baseDate=1500000000;
+    int textLength(QRandomGenerator &random,const DanmuWorkload &workload)
+    {
+        int spread=qMax(0,workload.meanTextLength-workload.minTextLength);
+        int length=workload.minTextLength+int(-std::log(1-random.generateDouble())*spread);
+        return qBound(qMax(1,workload.minTextLength),length,qMax(1,workload.maxTextLength));
+    }
+}
+DanmuWorkload::DanmuWorkload():duration(300),commentsPerSecond(20),minTextLength(2),meanTextLength(8),maxTextLength(40),
+    colorCount(8),whitePercent(70),topPercent(10),bottomPercent(10),duplicatePercent(20),senderCount(2000),seed(1)
+{
+
+}
+
+QList<DanmuComment *> DanmuGenerator::generate(const DanmuWorkload &workload)
+{
+    static const QString charset(QStringLiteral("的一是不了人我在有他这为之大来以个中上们哈草前方高能好耶awsl233666wwwAB？！"));
+    QRandomGenerator random(workload.seed);
+    QVector<int> colors;
+    for(int i=0;i<workload.colorCount;++i)
+        colors.append(random.bounded(0x1000000));
+    QStringList recentText;
+    QList<DanmuComment *> danmuList;
+    int count=workload.duration*workload.commentsPerSecond;
+    danmuList.reserve(count);
+    for(int i=0;i<count;++i)
+    {
+        DanmuComment *danmu=new DanmuComment;
+        danmu->originTime=danmu->time=random.bounded(qMax(1,workload.duration*1000));
+        if(!recentText.isEmpty() && random.bounded(100)<workload.duplicatePercent)
+        {
+            danmu->text=recentText.at(random.bounded(recentText.count()));
+        }
+        else
+        {
+            int length=textLength(random,workload);
+            QString text;
+            text.reserve(length);
+            for(int j=0;j<length;++j)
+                text.append(charset.at(random.bounded(charset.length())));
+            danmu->text=text;
+            recentText.append(text);
+            if(recentText.count()>recentTextCount)recentText.removeFirst();
+        }
+        danmu->color=(colors.isEmpty() || random.bounded(100)<workload.whitePercent)?0xffffff:colors.at(random.bounded(colors.count()));
+        int typeRoll=random.bounded(100);
+        danmu->setType(typeRoll<workload.topPercent?5:(typeRoll<workload.topPercent+workload.bottomPercent?4:1));
+        danmu->fontSizeLevel=DanmuComment::Normal;
+        danmu->sender=QString("u%1").arg(random.bounded(qMax(1,workload.senderCount)));
+        danmu->date=baseDate+danmu->time/1000;
+        danmu->source=0;
+        danmuList.append(danmu);
+    }
+    std::stable_sort(danmuList.begin(),danmuList.end(),[](const DanmuComment *d1,const DanmuComment *d2){
+        return d1->time<d2->time;
+    });
+    return danmuList;
+}
+
+QByteArray DanmuGenerator::toXml(const QList<DanmuComment *> &danmuList)
+{
+    static const int modes[]={1,5,4};
+    static const int sizes[]={25,18,36};
+    QByteArray xml("<?xml version=\"1.0\" encoding=\"UTF-8\"?><i><chatserver>chat.bilibili.com</chatserver>\n");
+    int id=0;
+    for(const DanmuComment *danmu:danmuList)
+    {
+        xml+=QString("<d p=\"%1,%2,%3,%4,%5,0,%6,%7\">%8</d>\n").arg(danmu->originTime/1000.0,0,'f',3)
+                .arg(modes[danmu->type]).arg(sizes[danmu->fontSizeLevel]).arg(danmu->color).arg(danmu->date)
+                .arg(danmu->sender).arg(++id).arg(danmu->text.toHtmlEscaped()).toUtf8();
+    }
+    xml+="</i>";
+    return xml;
+}
+
+QByteArray DanmuGenerator::toIqiyiXml(const QList<DanmuComment *> &danmuList)
+{
+    QByteArray xml("<?xml version=\"1.0\" encoding=\"UTF-8\"?><danmu><code>A00000</code><data><entry><int>0</int><list>");
+    int id=0;
+    for(const DanmuComment *danmu:danmuList)
+    {
+        xml+=QString("<bulletInfo><contentId>%1%2</contentId><content>%3</content><showTime>%4</showTime>"
+                     "<color>%5</color><font>14</font><opacity>1.0</opacity><position>0</position>"
+                     "<userInfo><uid>%6</uid><name>%6</name></userInfo></bulletInfo>")
+                .arg(danmu->date).arg(++id,8,10,QChar('0')).arg(danmu->text.toHtmlEscaped())
+                .arg(danmu->originTime/1000).arg(danmu->color,6,16,QChar('0')).arg(danmu->sender).toUtf8();
+    }
+    xml+="</list></entry></data></danmu>";
+    return xml;
+}
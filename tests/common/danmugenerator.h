@@ -0,0 +1,35 @@
+#ifndef DANMUGENERATOR_H
+#define DANMUGENERATOR_H
+#include <QList>
+#include <QByteArray>
+class DanmuComment;
+//the same workload always gives the same comments
+struct DanmuWorkload
+{
+    DanmuWorkload();
+    int duration; //s
+    int commentsPerSecond;
+    //text lengths are exponentially distributed from minTextLength with mean meanTextLength, capped at maxTextLength
+    int minTextLength;
+    int meanTextLength;
+    int maxTextLength;
+    int colorCount; //random colors besides white
+    int whitePercent;
+    int topPercent;
+    int bottomPercent;
+    int duplicatePercent; //comments repeating one of the recent texts
+    int senderCount;
+    quint32 seed;
+};
+class DanmuGenerator
+{
+public:
+    //comments are ordered by time, the caller owns them
+    static QList<DanmuComment *> generate(const DanmuWorkload &workload);
+    //Bilibili XML: <i><d p="time,mode,size,color,date,pool,sender,id">text</d></i>
+    static QByteArray toXml(const QList<DanmuComment *> &danmuList);
+    //uncompressed iqiyi segment: <danmu><data><entry><list><bulletInfo>...</bulletInfo></list></entry></data></danmu>
+    static QByteArray toIqiyiXml(const QList<DanmuComment *> &danmuList);
+};
+
+#endif // DANMUGENERATOR_H
@@ -0,0 +1,79 @@
+#include "fixturedb.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QVariant>
+#include "Play/Danmu/common.h"
+namespace
+{
+    const char *schema[]=
+    {
+        "CREATE TABLE 'bangumi' ('PoolID' TEXT(32) NOT NULL,'AnimeTitle' TEXT,'Title' TEXT,"
+        "PRIMARY KEY ('PoolID') ON CONFLICT REPLACE);",
+        "CREATE UNIQUE INDEX 'PoolID' ON 'bangumi' ('PoolID' ASC);",
+        "CREATE TABLE 'danmu' ('PoolID' TEXT(32) NOT NULL,'Time' INTEGER,'Date' INTEGER,'Color' INTEGER,"
+        "'Mode' INTEGER,'Size' INTEGER,'Source' INTEGER,'User' TEXT,'Text' TEXT,'Hash' INTEGER,"
+        "CONSTRAINT 'PoolID' FOREIGN KEY ('PoolID') REFERENCES 'bangumi' ('PoolID') ON DELETE CASCADE);",
+        "CREATE TABLE 'source' ('PoolID' TEXT(32),'ID' INTEGER,'Name' TEXT,'Delay' INTEGER,'URL' TEXT,"
+        "'TimeLine' TEXT,'LastDate' INTEGER DEFAULT 0,"
+        "CONSTRAINT 'PoolID' FOREIGN KEY ('PoolID') REFERENCES 'bangumi' ('PoolID') ON DELETE CASCADE);",
+        "CREATE TABLE 'match' ('MD5' TEXT NOT NULL ON CONFLICT IGNORE,'PoolID' TEXT(32) NOT NULL ON CONFLICT IGNORE,"
+        "PRIMARY KEY ('MD5'),CONSTRAINT 'PoolID' FOREIGN KEY ('PoolID') REFERENCES 'bangumi' ('PoolID') ON DELETE CASCADE);",
+        "CREATE TABLE 'block' ('Id' INTEGER NOT NULL,'Field' INTEGER,'Relation' INTEGER,'IsRegExp' INTEGER,"
+        "'Enable' INTEGER,'Content' TEXT,PRIMARY KEY ('Id' ASC));",
+        "CREATE TABLE 'fingerprint' ('Path' TEXT NOT NULL,'Size' INTEGER,'MTime' INTEGER,'MD5' TEXT,PRIMARY KEY ('Path'));"
+    };
+}
+bool FixtureDB::create(const QString &connection, const QString &fileName)
+{
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE",connection);
+    database.setDatabaseName(fileName.isEmpty()?QString(":memory:"):fileName);
+    if(!database.open())return false;
+    QSqlQuery query(database);
+    query.exec("PRAGMA foreign_keys = ON;");
+    for(const char *statement:schema)
+    {
+        if(!query.exec(statement))return false;
+    }
+    return true;
+}
+
+void FixtureDB::remove(const QString &connection)
+{
+    {
+        QSqlDatabase database=QSqlDatabase::database(connection,false);
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connection);
+}
+
+void FixtureDB::addPool(const QString &connection, const QString &pid, const QList<DanmuComment *> &danmuList)
+{
+    QSqlDatabase database=QSqlDatabase::database(connection);
+    database.transaction();
+    QSqlQuery query(database);
+    query.prepare("insert into bangumi(PoolID,AnimeTitle,Title) values(?,?,?)");
+    query.bindValue(0,pid);
+    query.bindValue(1,QString("anime_%1").arg(pid));
+    query.bindValue(2,QString("ep_%1").arg(pid));
+    query.exec();
+    query.prepare("insert into source(PoolID,ID,Name,Delay,URL,TimeLine,LastDate) values(?,0,?,0,?,'',0)");
+    query.bindValue(0,pid);
+    query.bindValue(1,QString("fixture"));
+    query.bindValue(2,QString("fixture:%1").arg(pid));
+    query.exec();
+    query.prepare("insert into danmu(PoolID,Time,Date,Color,Mode,Size,Source,User,Text,Hash) values(?,?,?,?,?,?,0,?,?,?)");
+    for(const DanmuComment *danmu:danmuList)
+    {
+        query.bindValue(0,pid);
+        query.bindValue(1,danmu->originTime);
+        query.bindValue(2,danmu->date);
+        query.bindValue(3,danmu->color);
+        query.bindValue(4,int(danmu->type));
+        query.bindValue(5,int(danmu->fontSizeLevel));
+        query.bindValue(6,danmu->sender);
+        query.bindValue(7,danmu->text);
+        query.bindValue(8,qint64(danmu->contentHash()));
+        query.exec();
+    }
+    database.commit();
+}
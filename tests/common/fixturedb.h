@@ -0,0 +1,17 @@
+#ifndef FIXTUREDB_H
+#define FIXTUREDB_H
+#include <QString>
+#include <QList>
+class DanmuComment;
+//A database with the tables of GlobalObjects::initDatabase, kept in step with it by hand
+class FixtureDB
+{
+public:
+    //an empty fileName gives an in-memory database
+    static bool create(const QString &connection,const QString &fileName=QString());
+    static void remove(const QString &connection);
+    //a pool with one source holding danmuList, rows are written in one transaction
+    static void addPool(const QString &connection,const QString &pid,const QList<DanmuComment *> &danmuList);
+};
+
+#endif // FIXTUREDB_H
@@ -0,0 +1,11 @@
+# The shared network client and the local stand-in server it is measured against
+
+QT += network
+
+SOURCES += \
+    $$PWD/stubhttpserver.cpp \
+    $$PWD/../../Common/network.cpp
+
+HEADERS += \
+    $$PWD/stubhttpserver.h \
+    $$PWD/../../Common/network.h
@@ -0,0 +1,9 @@
+# ProviderBase and the zlib stream decoder, on top of network.pri
+include(zlib.pri)
+
+SOURCES += \
+    $$PWD/../../Play/Danmu/Provider/providerbase.cpp
+
+HEADERS += \
+    $$PWD/../../Play/Danmu/Provider/providerbase.h \
+    $$PWD/../../Play/Danmu/Provider/info.h
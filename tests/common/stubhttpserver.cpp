@@ -0,0 +1,56 @@
+#include "stubhttpserver.h"
+#include <QTcpSocket>
+#include <QTimer>
+#include <QPointer>
+StubHttpServer::StubHttpServer(Handler handler, QObject *parent):QTcpServer(parent),handler(handler),latency(0),connections(0),requests(0)
+{
+    QObject::connect(this,&QTcpServer::newConnection,this,[this](){
+        while(hasPendingConnections())
+        {
+            QTcpSocket *socket=nextPendingConnection();
+            connections++;
+            QObject::connect(socket,&QTcpSocket::readyRead,this,[this,socket](){readRequests(socket);});
+            QObject::connect(socket,&QTcpSocket::disconnected,socket,&QObject::deleteLater);
+        }
+    });
+    listen(QHostAddress::LocalHost);
+}
+
+void StubHttpServer::readRequests(QTcpSocket *socket)
+{
+    //requests that are not complete yet stay in the socket buffer until more bytes arrive
+    while(true)
+    {
+        QByteArray buffered(socket->peek(socket->bytesAvailable()));
+        int headerEnd=buffered.indexOf("\r\n\r\n");
+        if(headerEnd<0)return;
+        QList<QByteArray> lines(buffered.left(headerEnd).split('\n'));
+        QList<QByteArray> requestLine(lines.first().trimmed().split(' '));
+        int contentLength=0;
+        for(const QByteArray &line:lines)
+        {
+            if(line.toLower().startsWith("content-length:"))
+                contentLength=line.mid(15).trimmed().toInt();
+        }
+        if(buffered.size()<headerEnd+4+contentLength)return;
+        socket->read(headerEnd+4);
+        QByteArray data(socket->read(contentLength));
+        requests++;
+        QByteArray body;
+        int status=handler(requestLine.value(0),requestLine.value(1),data,body);
+        QByteArray response(QString("HTTP/1.1 %1 %2\r\nContent-Type: application/octet-stream\r\nContent-Length: %3\r\nConnection: keep-alive\r\n\r\n")
+                            .arg(status).arg(status==200?"OK":"Error").arg(body.size()).toLatin1());
+        response.append(body);
+        if(latency>0)
+        {
+            QPointer<QTcpSocket> target(socket);
+            QTimer::singleShot(latency,this,[target,response](){
+                if(target)target->write(response);
+            });
+        }
+        else
+        {
+            socket->write(response);
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef STUBHTTPSERVER_H
+#define STUBHTTPSERVER_H
+#include <QTcpServer>
+#include <functional>
+//A local stand-in for provider endpoints: HTTP/1.1 with keep-alive, answers come from a handler
+class StubHttpServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    //returns the status code and fills body, path includes the query
+    typedef std::function<int(const QByteArray &method,const QByteArray &path,const QByteArray &data,QByteArray &body)> Handler;
+    explicit StubHttpServer(Handler handler,QObject *parent=nullptr);
+    //delay before each reply is sent, in ms
+    inline void setLatency(int ms){latency=ms;}
+    inline QString baseUrl() const {return QString("http://127.0.0.1:%1").arg(serverPort());}
+    inline int connectionCount() const {return connections;}
+    inline int requestCount() const {return requests;}
+    inline void resetCounters(){connections=requests=0;}
+private:
+    Handler handler;
+    int latency;
+    int connections,requests;
+    void readRequests(QTcpSocket *socket);
+};
+
+#endif // STUBHTTPSERVER_H
@@ -0,0 +1,16 @@
+#include "globalobjects.h"
+#include <QFont>
+//only the objects a target creates itself are set, the rest stay null
+MPVPlayer *GlobalObjects::mpvplayer=nullptr;
+DanmuPool *GlobalObjects::danmuPool=nullptr;
+DanmuRender *GlobalObjects::danmuRender=nullptr;
+PlayList *GlobalObjects::playlist=nullptr;
+Blocker *GlobalObjects::blocker=nullptr;
+QThread *GlobalObjects::workThread=nullptr;
+QSettings *GlobalObjects::appSetting=nullptr;
+ProviderManager *GlobalObjects::providerManager=nullptr;
+AnimeLibrary *GlobalObjects::library=nullptr;
+DownloadModel *GlobalObjects::downloadModel=nullptr;
+DanmuManager *GlobalObjects::danmuManager=nullptr;
+LANServer *GlobalObjects::lanServer=nullptr;
+QFont GlobalObjects::iconfont;
@@ -0,0 +1,14 @@
+# The zlib stream decoder
+
+SOURCES += \
+    $$PWD/../../Common/zlibstream.cpp
+
+HEADERS += \
+    $$PWD/../../Common/zlibstream.h
+
+contains(QT_ARCH, i386){
+    win32: LIBS += -L$$PWD/../../lib/ -lzlibstat
+}else{
+    win32: LIBS += -L$$PWD/../../lib/x64/ -lzlibstat
+}
+unix: LIBS += -lz
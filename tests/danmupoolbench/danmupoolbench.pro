@@ -0,0 +1,9 @@
+include(../common/common.pri)
+include(../common/danmucore.pri)
+
+QT += testlib
+TARGET = danmupoolbench
+TEMPLATE = app
+
+SOURCES += \
+    tst_danmupoolbench.cpp
@@ -0,0 +1,160 @@
+#include <QtTest>
+#include "globalobjects.h"
+#include "danmugenerator.h"
+#include "fixturedb.h"
+#include "Play/Danmu/danmupool.h"
+#include "Play/Danmu/danmurender.h"
+#include "Play/Danmu/blocker.h"
+namespace
+{
+    DanmuSourceInfo generatedSource(int count)
+    {
+        DanmuSourceInfo source;
+        source.delay=0;
+        source.count=count;
+        source.name="generated";
+        source.url=QString("generated:%1").arg(count);
+        return source;
+    }
+    DanmuWorkload workloadOf(int count)
+    {
+        DanmuWorkload workload;
+        workload.commentsPerSecond=50;
+        workload.duration=count/workload.commentsPerSecond;
+        return workload;
+    }
+}
+class DanmuPoolBench : public QObject
+{
+    Q_OBJECT
+private:
+    QTemporaryDir settingDir;
+    //a pool of fixturePoolSize comments is kept in the database
+    const int fixturePoolSize=100000;
+    const QString fixturePool="fixturepool";
+    void loadFixturePool();
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+    void addDanmu_data();
+    void addDanmu();
+    void loadDanmuFromDB();
+    void setDelay();
+    void mediaTimeJumped();
+    void deleteDanmu();
+};
+
+void DanmuPoolBench::loadFixturePool()
+{
+    GlobalObjects::danmuPool->setPoolID(fixturePool);
+    GlobalObjects::danmuPool->loadDanmuFromDB();
+}
+
+void DanmuPoolBench::initTestCase()
+{
+    GlobalObjects::appSetting=new QSettings(settingDir.filePath("settings.ini"),QSettings::IniFormat);
+    //nothing kept resident, every load goes to the database
+    GlobalObjects::appSetting->setValue("Play/PoolCacheSize",0);
+    QVERIFY(FixtureDB::create("MT",settingDir.filePath("fixture.db")));
+    QList<DanmuComment *> danmuList(DanmuGenerator::generate(workloadOf(fixturePoolSize)));
+    FixtureDB::addPool("MT",fixturePool,danmuList);
+    qDeleteAll(danmuList);
+    GlobalObjects::blocker=new Blocker;
+    GlobalObjects::danmuPool=new DanmuPool;
+    GlobalObjects::danmuRender=new DanmuRender;
+}
+
+void DanmuPoolBench::cleanupTestCase()
+{
+    delete GlobalObjects::danmuRender;
+    delete GlobalObjects::danmuPool;
+    delete GlobalObjects::blocker;
+    FixtureDB::remove("MT");
+    delete GlobalObjects::appSetting;
+}
+
+void DanmuPoolBench::cleanup()
+{
+    GlobalObjects::danmuPool->cleanUp();
+}
+
+void DanmuPoolBench::addDanmu_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+    QTest::newRow("300k") << 300000;
+}
+
+void DanmuPoolBench::addDanmu()
+{
+    QFETCH(int, count);
+    QList<DanmuComment *> danmuList(DanmuGenerator::generate(workloadOf(count)));
+    DanmuSourceInfo source(generatedSource(danmuList.count()));
+    //the pool takes the comments, so the list can only be added once
+    QBENCHMARK_ONCE
+    {
+        GlobalObjects::danmuPool->addDanmu(source,danmuList,false);
+    }
+    QCOMPARE(GlobalObjects::danmuPool->totalCount(),danmuList.count());
+}
+
+void DanmuPoolBench::loadDanmuFromDB()
+{
+    QBENCHMARK
+    {
+        loadFixturePool();
+        GlobalObjects::danmuPool->cleanUp();
+    }
+    loadFixturePool();
+    QCOMPARE(GlobalObjects::danmuPool->totalCount(),fixturePoolSize);
+}
+
+void DanmuPoolBench::setDelay()
+{
+    loadFixturePool();
+    DanmuSourceInfo *source=&GlobalObjects::danmuPool->getSources().begin().value();
+    int delay=0;
+    QBENCHMARK
+    {
+        delay=delay==0?3000:0;
+        GlobalObjects::danmuPool->setDelay(source,delay);
+    }
+    GlobalObjects::danmuPool->setDelay(source,0);
+}
+
+void DanmuPoolBench::mediaTimeJumped()
+{
+    loadFixturePool();
+    const int jumpCount=1000;
+    QRandomGenerator random(1);
+    QVector<int> targets;
+    for(int i=0;i<jumpCount;++i)
+        targets.append(random.bounded(workloadOf(fixturePoolSize).duration*1000));
+    QBENCHMARK
+    {
+        for(int target:targets)
+            GlobalObjects::danmuPool->mediaTimeJumped(target);
+    }
+}
+
+void DanmuPoolBench::deleteDanmu()
+{
+    loadFixturePool();
+    QRandomGenerator random(1);
+    QSet<qint64> ids;
+    const QList<QSharedPointer<DanmuComment> > &danmuList=GlobalObjects::danmuPool->getDanmuList();
+    while(ids.count()<1000)
+        ids.insert(danmuList.at(random.bounded(danmuList.count()))->id);
+    //deleted rows are gone from the fixture too
+    QBENCHMARK_ONCE
+    {
+        GlobalObjects::danmuPool->deleteDanmu(ids);
+    }
+    QCOMPARE(GlobalObjects::danmuPool->totalCount(),fixturePoolSize-ids.count());
+}
+
+QTEST_MAIN(DanmuPoolBench)
+
+#include "tst_danmupoolbench.moc"
@@ -0,0 +1,15 @@
+# Drives DanmuRender on an offscreen surface with a synthetic clock and prints frame cost percentiles.
+# Without a GPU it runs on Mesa llvmpipe, e.g.
+#   LIBGL_ALWAYS_SOFTWARE=1 xvfb-run ./danmurenderbench --rate 60 --duration 120
+# or with an XML file instead of generated comments:
+#   ./danmurenderbench --xml comments.xml --dense --out result.json
+
+include(../common/common.pri)
+include(../common/danmucore.pri)
+
+TARGET = danmurenderbench
+TEMPLATE = app
+DEFINES += DANMU_STATIS
+
+SOURCES += \
+    main.cpp
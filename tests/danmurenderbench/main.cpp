@@ -0,0 +1,205 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QTemporaryDir>
+#include <QSettings>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFile>
+#include <algorithm>
+#include "globalobjects.h"
+#include "danmugenerator.h"
+#include "fixturedb.h"
+#include "Play/Danmu/danmupool.h"
+#include "Play/Danmu/danmurender.h"
+#include "Play/Danmu/blocker.h"
+#include "Play/Danmu/Provider/localprovider.h"
+namespace
+{
+    QJsonObject costSummary(QVector<qint64> samples)
+    {
+        QJsonObject summary;
+        if(samples.isEmpty())return summary;
+        std::sort(samples.begin(),samples.end());
+        auto percentile=[&samples](int p){
+            return samples.at(qMin(samples.count()-1,samples.count()*p/100));
+        };
+        qint64 sum=0;
+        for(qint64 sample:samples) sum+=sample;
+        summary.insert("p50",percentile(50));
+        summary.insert("p95",percentile(95));
+        summary.insert("p99",percentile(99));
+        summary.insert("max",samples.last());
+        summary.insert("mean",double(sum)/samples.count());
+        return summary;
+    }
+}
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Frame cost of the danmu render under a synthetic clock, costs are in us");
+    parser.addHelpOption();
+    DanmuWorkload workload;
+    QCommandLineOption xmlOption("xml","Replay comments of a Bilibili XML file instead of generating them.","file");
+    QCommandLineOption rateOption("rate","Generated comments per second.","n",QString::number(workload.commentsPerSecond));
+    QCommandLineOption durationOption("duration","Length of the generated timeline in seconds.","s",QString::number(workload.duration));
+    QCommandLineOption textMinOption("text-min","Shortest generated text.","n",QString::number(workload.minTextLength));
+    QCommandLineOption textMeanOption("text-mean","Mean length of generated text.","n",QString::number(workload.meanTextLength));
+    QCommandLineOption textMaxOption("text-max","Longest generated text.","n",QString::number(workload.maxTextLength));
+    QCommandLineOption colorsOption("colors","Colors besides white.","n",QString::number(workload.colorCount));
+    QCommandLineOption whiteOption("white","Percent of white comments.","p",QString::number(workload.whitePercent));
+    QCommandLineOption topOption("top","Percent of top comments.","p",QString::number(workload.topPercent));
+    QCommandLineOption bottomOption("bottom","Percent of bottom comments.","p",QString::number(workload.bottomPercent));
+    QCommandLineOption seedOption("seed","Seed of the generator.","n",QString::number(workload.seed));
+    QCommandLineOption sizeOption("size","Size of the surface.","WxH","1280x720");
+    QCommandLineOption fpsOption("fps","Frames per second of the synthetic clock.","n","60");
+    QCommandLineOption maxCountOption("max-count","Max danmu count of the render, -1 for no limit.","n","-1");
+    QCommandLineOption denseOption("dense","Dense layout.");
+    QCommandLineOption outOption("out","Write the result to a file instead of stdout.","file");
+    parser.addOptions({xmlOption,rateOption,durationOption,textMinOption,textMeanOption,textMaxOption,colorsOption,
+                       whiteOption,topOption,bottomOption,seedOption,sizeOption,fpsOption,maxCountOption,denseOption,outOption});
+    parser.process(app);
+    workload.commentsPerSecond=parser.value(rateOption).toInt();
+    workload.duration=parser.value(durationOption).toInt();
+    workload.minTextLength=parser.value(textMinOption).toInt();
+    workload.meanTextLength=parser.value(textMeanOption).toInt();
+    workload.maxTextLength=parser.value(textMaxOption).toInt();
+    workload.colorCount=parser.value(colorsOption).toInt();
+    workload.whitePercent=parser.value(whiteOption).toInt();
+    workload.topPercent=parser.value(topOption).toInt();
+    workload.bottomPercent=parser.value(bottomOption).toInt();
+    workload.seed=parser.value(seedOption).toUInt();
+    QStringList sizeValues=parser.value(sizeOption).split('x');
+    QSize surfaceSize(sizeValues.value(0).toInt(),sizeValues.value(1).toInt());
+    if(surfaceSize.isEmpty())surfaceSize=QSize(1280,720);
+    int fps=qMax(1,parser.value(fpsOption).toInt());
+
+    QTemporaryDir settingDir;
+    GlobalObjects::appSetting=new QSettings(settingDir.filePath("settings.ini"),QSettings::IniFormat);
+    if(!FixtureDB::create("MT"))
+    {
+        qCritical("failed to create the fixture database");
+        return 1;
+    }
+
+    QOffscreenSurface surface;
+    surface.create();
+    QOpenGLContext context;
+    if(!context.create() || !context.makeCurrent(&surface))
+    {
+        qCritical("no OpenGL context, try LIBGL_ALWAYS_SOFTWARE=1 with a virtual display");
+        return 1;
+    }
+    QOpenGLFramebufferObject target(surfaceSize);
+    QOpenGLFunctions *gl=context.functions();
+
+    GlobalObjects::blocker=new Blocker;
+    GlobalObjects::danmuPool=new DanmuPool;
+    GlobalObjects::danmuRender=new DanmuRender;
+    DanmuPool *pool=GlobalObjects::danmuPool;
+    DanmuRender *render=GlobalObjects::danmuRender;
+    render->initContext(&context);
+    render->setSurfaceSize(surfaceSize);
+    render->setMaxDanmuCount(parser.value(maxCountOption).toInt());
+    render->dense=parser.isSet(denseOption);
+
+    QList<DanmuComment *> danmuList;
+    QElapsedTimer timer;
+    timer.start();
+    if(parser.isSet(xmlOption))
+        LocalProvider::LoadXmlDanmuFile(parser.value(xmlOption),danmuList);
+    else
+        danmuList=DanmuGenerator::generate(workload);
+    int duration=0;
+    for(const DanmuComment *danmu:danmuList)
+        duration=qMax(duration,danmu->originTime);
+    DanmuSourceInfo source;
+    source.delay=0;
+    source.count=danmuList.count();
+    source.name=parser.isSet(xmlOption)?parser.value(xmlOption):QString("generated");
+    source.url=source.name;
+    pool->addDanmu(source,danmuList,false);
+    pool->mediaTimeJumped(0);
+    qint64 loadTime=timer.elapsed();
+
+    const float interval=1000.f/fps;
+    QVector<qint64> frameCost,moveCost,drawCost;
+    int frames=int(duration/interval)+1;
+    frameCost.reserve(frames);
+    moveCost.reserve(frames);
+    drawCost.reserve(frames);
+    QElapsedTimer frameTimer;
+    timer.restart();
+    for(int i=0;i<frames;++i)
+    {
+        pool->mediaTimeElapsed(int(i*interval));
+        //textures and layout plans come back from their threads as queued calls
+        QCoreApplication::processEvents();
+        frameTimer.start();
+        render->moveDanmu(interval);
+        qint64 moveEnd=frameTimer.nsecsElapsed();
+        target.bind();
+        gl->glViewport(0,0,surfaceSize.width(),surfaceSize.height());
+        gl->glClearColor(0,0,0,0);
+        gl->glClear(GL_COLOR_BUFFER_BIT);
+        render->drawDanmu();
+        gl->glFinish();
+        qint64 frameEnd=frameTimer.nsecsElapsed();
+        moveCost.append(moveEnd/1000);
+        drawCost.append((frameEnd-moveEnd)/1000);
+        frameCost.append(frameEnd/1000);
+    }
+    qint64 wallTime=timer.elapsed();
+
+    QJsonObject workloadObj;
+    workloadObj.insert("source",source.name);
+    workloadObj.insert("rate",workload.commentsPerSecond);
+    workloadObj.insert("textLength",QString("%1/%2/%3").arg(workload.minTextLength).arg(workload.meanTextLength).arg(workload.maxTextLength));
+    workloadObj.insert("colors",workload.colorCount);
+    workloadObj.insert("white",workload.whitePercent);
+    workloadObj.insert("top",workload.topPercent);
+    workloadObj.insert("bottom",workload.bottomPercent);
+    workloadObj.insert("seed",qint64(workload.seed));
+    workloadObj.insert("size",QString("%1x%2").arg(surfaceSize.width()).arg(surfaceSize.height()));
+    workloadObj.insert("fps",fps);
+    workloadObj.insert("dense",render->dense);
+    QJsonObject result;
+    result.insert("workload",workloadObj);
+    result.insert("comments",pool->totalCount());
+    result.insert("frames",frames);
+    result.insert("loadTime",loadTime);
+    result.insert("wallTime",wallTime);
+    result.insert("fps",wallTime>0?frames*1000.0/wallTime:0);
+    result.insert("throughput",wallTime>0?pool->totalCount()*1000.0/wallTime:0);
+    result.insert("frameCost",costSummary(frameCost));
+    result.insert("moveCost",costSummary(moveCost));
+    result.insert("drawCost",costSummary(drawCost));
+    result.insert("render",render->getRenderStatis());
+    QByteArray json(QJsonDocument(result).toJson());
+    if(parser.isSet(outOption))
+    {
+        QFile out(parser.value(outOption));
+        if(out.open(QIODevice::WriteOnly))out.write(json);
+    }
+    else
+    {
+        fputs(json.constData(),stdout);
+    }
+
+    //textures belong to the context, release them while it is still alive
+    delete GlobalObjects::danmuRender;
+    delete GlobalObjects::danmuPool;
+    delete GlobalObjects::blocker;
+    GlobalObjects::danmuRender=nullptr;
+    GlobalObjects::danmuPool=nullptr;
+    GlobalObjects::blocker=nullptr;
+    context.doneCurrent();
+    FixtureDB::remove("MT");
+    delete GlobalObjects::appSetting;
+    return 0;
+}
@@ -0,0 +1,9 @@
+include(../common/common.pri)
+include(../common/zlib.pri)
+
+QT += testlib
+TARGET = inflatebench
+TEMPLATE = app
+
+SOURCES += \
+    tst_inflatebench.cpp
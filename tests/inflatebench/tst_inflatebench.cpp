@@ -0,0 +1,248 @@
+#include <QtTest>
+#include "danmugenerator.h"
+#include "Common/zlibstream.h"
+#include "Play/Danmu/common.h"
+namespace
+{
+    //about what one readyRead of a QNetworkReply hands over
+    const int networkChunk=16384;
+    //throughput is averaged over at least this long
+    const int minMeasureTime=500;
+
+    //IqiyiProvider before streaming: inflate the whole segment, then parse it
+    int legacyDecompress(const QByteArray &input, QByteArray &output)
+    {
+        int ret;
+        unsigned have;
+        const int chunkSize=16384;
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        stream.avail_in = 0;
+        stream.next_in = Z_NULL;
+        ret = inflateInit(&stream);
+        if (ret != Z_OK) return ret;
+        unsigned char inBuf[chunkSize];
+        unsigned char outBuf[chunkSize];
+        QDataStream inStream(input);
+        while(!inStream.atEnd())
+        {
+            stream.avail_in=inStream.readRawData((char *)&inBuf,chunkSize);
+            if (stream.avail_in == 0)
+                break;
+            stream.next_in = inBuf;
+            do
+            {
+                stream.avail_out = chunkSize;
+                stream.next_out = outBuf;
+                ret = inflate(&stream, Z_NO_FLUSH);
+                switch (ret)
+                {
+                case Z_NEED_DICT:
+                    ret = Z_DATA_ERROR;
+                case Z_DATA_ERROR:
+                case Z_MEM_ERROR:
+                    (void)inflateEnd(&stream);
+                    return ret;
+                }
+                have = chunkSize - stream.avail_out;
+                output.append((const char *)outBuf,have);
+            } while (stream.avail_out == 0);
+        }
+        (void)inflateEnd(&stream);
+        return Z_OK ;
+    }
+    void legacyParse(const QByteArray &content, QList<DanmuComment *> &danmuList)
+    {
+        QByteArray decompressResult;
+        if(legacyDecompress(content,decompressResult)!=Z_OK)return;
+        QXmlStreamReader reader(decompressResult);
+        DanmuComment tmpDanmu;
+        tmpDanmu.setType(1);
+        tmpDanmu.fontSizeLevel=DanmuComment::Normal;
+        while(!reader.atEnd())
+        {
+            if(reader.isStartElement())
+            {
+                if(reader.name()=="contentId")
+                    tmpDanmu.date=reader.readElementText().mid(0,10).toLongLong();
+                else if(reader.name()=="content")
+                    tmpDanmu.text=reader.readElementText();
+                else if(reader.name()=="showTime")
+                    tmpDanmu.originTime=tmpDanmu.time=reader.readElementText().toFloat()*1000;
+                else if(reader.name()=="color")
+                    tmpDanmu.color=reader.readElementText().toInt(nullptr,16);
+                else if(reader.name()=="uid")
+                    tmpDanmu.sender="[iqiyi]"+reader.readElementText();
+            }
+            else if(reader.isEndElement())
+            {
+                if(reader.name()=="bulletInfo")
+                    danmuList.append(new DanmuComment(tmpDanmu));
+            }
+            reader.readNext();
+        }
+    }
+    //the handler of IqiyiProvider, fed the way a reply arrives
+    void streamParse(const QByteArray &content, QList<DanmuComment *> &danmuList)
+    {
+        DanmuComment tmpDanmu;
+        tmpDanmu.setType(1);
+        tmpDanmu.fontSizeLevel=DanmuComment::Normal;
+        QString elementText;
+        InflateXmlReader xmlReader([&](QXmlStreamReader &reader){
+            if(reader.isStartElement())
+                elementText.clear();
+            else if(reader.isCharacters())
+                elementText.append(reader.text());
+            else if(reader.isEndElement())
+            {
+                if(reader.name()=="contentId")
+                    tmpDanmu.date=elementText.mid(0,10).toLongLong();
+                else if(reader.name()=="content")
+                    tmpDanmu.text=elementText;
+                else if(reader.name()=="showTime")
+                    tmpDanmu.originTime=tmpDanmu.time=elementText.toFloat()*1000;
+                else if(reader.name()=="color")
+                    tmpDanmu.color=elementText.toInt(nullptr,16);
+                else if(reader.name()=="uid")
+                    tmpDanmu.sender="[iqiyi]"+elementText;
+                else if(reader.name()=="bulletInfo")
+                    danmuList.append(new DanmuComment(tmpDanmu));
+                elementText.clear();
+            }
+        });
+        for(int pos=0;pos<content.size();pos+=networkChunk)
+        {
+            if(!xmlReader.feed(content.constData()+pos,qMin(networkChunk,content.size()-pos)))
+                return;
+        }
+    }
+    void parse(bool streaming, const QByteArray &content, QList<DanmuComment *> &danmuList)
+    {
+        if(streaming)
+            streamParse(content,danmuList);
+        else
+            legacyParse(content,danmuList);
+    }
+    //Linux only: writing 5 to clear_refs resets VmHWM to the current resident size
+    bool resetPeakResident()
+    {
+        QFile clearRefs("/proc/self/clear_refs");
+        if(!clearRefs.open(QIODevice::WriteOnly))return false;
+        return clearRefs.write("5")==1;
+    }
+    qint64 residentKB(const char *field)
+    {
+        QFile status("/proc/self/status");
+        if(!status.open(QIODevice::ReadOnly|QIODevice::Text))return -1;
+        //procfs files report size 0, read them line by line
+        QTextStream stream(&status);
+        QString line;
+        while(stream.readLineInto(&line))
+        {
+            if(line.startsWith(field))
+                return line.mid(qstrlen(field)).trimmed().split(' ').first().toLongLong();
+        }
+        return -1;
+    }
+}
+class InflateBench : public QObject
+{
+    Q_OBJECT
+private:
+    QMap<int,QByteArray> segments;
+    QMap<int,int> inflatedSizes;
+    QByteArray segment(int count);
+    void addRows();
+private slots:
+    void throughput_data();
+    void throughput();
+    void peakMemory_data();
+    void peakMemory();
+};
+
+QByteArray InflateBench::segment(int count)
+{
+    if(segments.contains(count))return segments.value(count);
+    DanmuWorkload workload;
+    workload.commentsPerSecond=100;
+    workload.duration=count/workload.commentsPerSecond;
+    QList<DanmuComment *> danmuList(DanmuGenerator::generate(workload));
+    QByteArray xml(DanmuGenerator::toIqiyiXml(danmuList));
+    qDeleteAll(danmuList);
+    //qCompress prepends the uncompressed length to a zlib stream
+    QByteArray compressed(qCompress(xml).mid(4));
+    segments.insert(count,compressed);
+    inflatedSizes.insert(count,xml.size());
+    return compressed;
+}
+
+void InflateBench::addRows()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("streaming");
+    //a usual 5-minute segment, a dense one, and a whole movie recorded as one response
+    for(int count:{3000,30000,300000})
+    {
+        QTest::newRow(QString("%1-legacy").arg(count).toLatin1()) << count << false;
+        QTest::newRow(QString("%1-stream").arg(count).toLatin1()) << count << true;
+    }
+}
+
+void InflateBench::throughput_data()
+{
+    addRows();
+}
+
+void InflateBench::throughput()
+{
+    QFETCH(int, count);
+    QFETCH(bool, streaming);
+    QByteArray content(segment(count));
+    QList<DanmuComment *> danmuList;
+    int rounds=0;
+    QElapsedTimer timer;
+    timer.start();
+    do
+    {
+        qDeleteAll(danmuList);
+        danmuList.clear();
+        parse(streaming,content,danmuList);
+        ++rounds;
+    } while(timer.elapsed()<minMeasureTime);
+    qint64 elapsed=qMax<qint64>(1,timer.elapsed());
+    QCOMPARE(danmuList.count(),count);
+    qDeleteAll(danmuList);
+    //measured against the inflated xml, the amount the parser goes through
+    qreal bytesPerSecond=qreal(inflatedSizes.value(count))*rounds*1000/elapsed;
+    qInfo("%s: %.1f MB/s, %d rounds", QTest::currentDataTag(), bytesPerSecond/1024/1024, rounds);
+    QTest::setBenchmarkResult(bytesPerSecond,QTest::BytesPerSecond);
+}
+
+void InflateBench::peakMemory_data()
+{
+    addRows();
+}
+
+void InflateBench::peakMemory()
+{
+    QFETCH(int, count);
+    QFETCH(bool, streaming);
+    QByteArray content(segment(count));
+    if(!resetPeakResident() || residentKB("VmHWM:")<0)
+        QSKIP("peak resident size can only be reset on Linux");
+    qint64 baseKB=residentKB("VmRSS:");
+    QList<DanmuComment *> danmuList;
+    parse(streaming,content,danmuList);
+    qint64 peakKB=residentKB("VmHWM:")-baseKB;
+    QCOMPARE(danmuList.count(),count);
+    qDeleteAll(danmuList);
+    qInfo("%s: peak +%lld KB, inflated %d KB", QTest::currentDataTag(), peakKB, inflatedSizes.value(count)/1024);
+    QTest::setBenchmarkResult(peakKB*1024,QTest::BytesAllocated);
+}
+
+QTEST_MAIN(InflateBench)
+
+#include "tst_inflatebench.moc"
@@ -0,0 +1,9 @@
+include(../common/common.pri)
+include(../common/danmucore.pri)
+
+QT += testlib
+TARGET = layoutbench
+TEMPLATE = app
+
+SOURCES += \
+    tst_layoutbench.cpp
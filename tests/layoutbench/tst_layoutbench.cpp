@@ -0,0 +1,79 @@
+#include <QtTest>
+#include "globalobjects.h"
+#include "danmugenerator.h"
+#include "Play/Danmu/danmurender.h"
+#include "Play/Danmu/Layouts/rolllayout.h"
+class LayoutBench : public QObject
+{
+    Q_OBJECT
+private:
+    QList<QSharedPointer<DanmuComment> > danmuList;
+    //sizes the cache worker would give the texture of each comment, never drawn here
+    QVector<DanmuDrawInfo> drawInfos;
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void rollBurst_data();
+    void rollBurst();
+};
+
+void LayoutBench::initTestCase()
+{
+    DanmuWorkload workload;
+    workload.duration=100;
+    workload.commentsPerSecond=100;
+    workload.topPercent=workload.bottomPercent=0;
+    QFont font("Microsoft YaHei");
+    font.setPixelSize(20);
+    QFontMetrics metrics(font);
+    const QList<DanmuComment *> generated(DanmuGenerator::generate(workload));
+    drawInfos.resize(generated.count());
+    for(int i=0;i<generated.count();++i)
+    {
+        drawInfos[i].width=metrics.width(generated.at(i)->text)+8;
+        drawInfos[i].height=metrics.height()+8;
+        drawInfos[i].useCount=1;
+        drawInfos[i].texture=0;
+        danmuList.append(QSharedPointer<DanmuComment>(generated.at(i)));
+    }
+    GlobalObjects::danmuRender=new DanmuRender;
+    GlobalObjects::danmuRender->surfaceRect=QRectF(0,0,1920,1080);
+}
+
+void LayoutBench::cleanupTestCase()
+{
+    delete GlobalObjects::danmuRender;
+    GlobalObjects::danmuRender=nullptr;
+}
+
+void LayoutBench::rollBurst_data()
+{
+    QTest::addColumn<int>("burst");
+    QTest::addColumn<bool>("dense");
+    QTest::newRow("100") << 100 << false;
+    QTest::newRow("1000") << 1000 << false;
+    QTest::newRow("1000-dense") << 1000 << true;
+    QTest::newRow("10000") << 10000 << false;
+    QTest::newRow("10000-dense") << 10000 << true;
+}
+
+void LayoutBench::rollBurst()
+{
+    QFETCH(int, burst);
+    QFETCH(bool, dense);
+    GlobalObjects::danmuRender->dense=dense;
+    RollLayout layout(GlobalObjects::danmuRender);
+    //one burst arrives in a single frame, the layout is emptied after each so every burst starts from a clear screen
+    QBENCHMARK
+    {
+        for(int i=0;i<burst;++i)
+            layout.addDanmu(danmuList.at(i),&drawInfos[i]);
+        layout.cleanup();
+    }
+    //returned references go to the cache worker as queued calls
+    QCoreApplication::processEvents();
+}
+
+QTEST_MAIN(LayoutBench)
+
+#include "tst_layoutbench.moc"
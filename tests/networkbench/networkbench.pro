@@ -0,0 +1,9 @@
+include(../common/common.pri)
+include(../common/network.pri)
+
+QT += testlib
+TARGET = networkbench
+TEMPLATE = app
+
+SOURCES += \
+    tst_networkbench.cpp
@@ -0,0 +1,149 @@
+#include <QtTest>
+#include "stubhttpserver.h"
+#include "Common/network.h"
+namespace
+{
+    const int requestCount=50;
+    //what every provider did before Network::manager(): a new manager and a nested loop per request
+    QByteArray legacyGet(const QString &url)
+    {
+        QNetworkAccessManager manager;
+        QNetworkReply *reply=manager.get(QNetworkRequest(QUrl(url)));
+        QEventLoop eventLoop;
+        QObject::connect(reply,&QNetworkReply::finished,&eventLoop,&QEventLoop::quit);
+        eventLoop.exec();
+        QByteArray content(reply->readAll());
+        reply->deleteLater();
+        return content;
+    }
+}
+class NetworkBench : public QObject
+{
+    Q_OBJECT
+private:
+    StubHttpServer *server;
+    QString payloadUrl(int size) const {return QString("%1/bytes/%2").arg(server->baseUrl()).arg(size);}
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void sharedManager_data();
+    void sharedManager();
+    void perRequestManager_data();
+    void perRequestManager();
+    void sharedManagerConcurrent_data();
+    void sharedManagerConcurrent();
+    void retryGet();
+    void noRetryPost();
+};
+
+void NetworkBench::initTestCase()
+{
+    server=new StubHttpServer([](const QByteArray &,const QByteArray &path,const QByteArray &,QByteArray &body){
+        if(path.startsWith("/bytes/"))
+        {
+            body=QByteArray(path.mid(7).toInt(),'k');
+            return 200;
+        }
+        if(path.startsWith("/status/"))
+            return path.mid(8).toInt();
+        return 404;
+    });
+    QVERIFY(server->isListening());
+}
+
+void NetworkBench::cleanupTestCase()
+{
+    delete server;
+}
+
+void NetworkBench::init()
+{
+    server->setLatency(0);
+    server->resetCounters();
+}
+
+void NetworkBench::sharedManager_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("latency");
+    QTest::newRow("1KB") << 1024 << 0;
+    QTest::newRow("64KB") << 64*1024 << 0;
+    QTest::newRow("1KB-5ms") << 1024 << 5;
+}
+
+void NetworkBench::sharedManager()
+{
+    QFETCH(int, size);
+    QFETCH(int, latency);
+    server->setLatency(latency);
+    QUrlQuery query;
+    QBENCHMARK
+    {
+        for(int i=0;i<requestCount;++i)
+            QCOMPARE(Network::httpGet(payloadUrl(size),query).size(),size);
+    }
+    qInfo("requests: %d, connections: %d",server->requestCount(),server->connectionCount());
+}
+
+void NetworkBench::perRequestManager_data()
+{
+    sharedManager_data();
+}
+
+void NetworkBench::perRequestManager()
+{
+    QFETCH(int, size);
+    QFETCH(int, latency);
+    server->setLatency(latency);
+    QBENCHMARK
+    {
+        for(int i=0;i<requestCount;++i)
+            QCOMPARE(legacyGet(payloadUrl(size)).size(),size);
+    }
+    qInfo("requests: %d, connections: %d",server->requestCount(),server->connectionCount());
+}
+
+void NetworkBench::sharedManagerConcurrent_data()
+{
+    sharedManager_data();
+}
+
+void NetworkBench::sharedManagerConcurrent()
+{
+    QFETCH(int, size);
+    QFETCH(int, latency);
+    server->setLatency(latency);
+    QBENCHMARK
+    {
+        int pending=requestCount;
+        QEventLoop eventLoop;
+        for(int i=0;i<requestCount;++i)
+        {
+            Network::httpGetAsync(payloadUrl(size),QUrlQuery(),QStringList(),[&](const Network::Reply &reply){
+                QVERIFY(!reply.hasError);
+                if(--pending==0)eventLoop.quit();
+            });
+        }
+        if(pending>0)eventLoop.exec();
+    }
+    qInfo("requests: %d, connections: %d",server->requestCount(),server->connectionCount());
+}
+
+void NetworkBench::retryGet()
+{
+    QUrlQuery query;
+    QVERIFY_EXCEPTION_THROWN(Network::httpGet(server->baseUrl()+"/status/503",query),Network::NetworkError);
+    QCOMPARE(server->requestCount(),Network::maxRetry+1);
+}
+
+void NetworkBench::noRetryPost()
+{
+    QByteArray data("match");
+    QVERIFY_EXCEPTION_THROWN(Network::httpPost(server->baseUrl()+"/status/503",data),Network::NetworkError);
+    QCOMPARE(server->requestCount(),1);
+}
+
+QTEST_MAIN(NetworkBench)
+
+#include "tst_networkbench.moc"
@@ -0,0 +1,12 @@
+include(../common/common.pri)
+
+QT += testlib
+TARGET = playlistbench
+TEMPLATE = app
+
+SOURCES += \
+    tst_playlistbench.cpp \
+    $$PWD/../../Play/Playlist/playlistitem.cpp
+
+HEADERS += \
+    $$PWD/../../Play/Playlist/playlistitem.h
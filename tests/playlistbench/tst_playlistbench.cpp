@@ -0,0 +1,155 @@
+#include <QtTest>
+#include "Play/Playlist/playlistitem.h"
+namespace
+{
+    const int itemCount=50000;
+    //index and parent as PlayList implements them, the row of an item comes from rowOf
+    class ItemTreeModel : public QAbstractItemModel
+    {
+    public:
+        ItemTreeModel(bool legacyRow):legacyRow(legacyRow){}
+        PlayListItem root;
+        inline int rowOf(const PlayListItem *item) const
+        {
+            //before row() was cached, every lookup scanned the siblings
+            return legacyRow?item->parent->children->indexOf(const_cast<PlayListItem *>(item)):item->row();
+        }
+        inline QModelIndex indexOf(PlayListItem *item) const {return createIndex(rowOf(item),0,item);}
+        virtual QModelIndex index(int row, int column, const QModelIndex &parent) const override
+        {
+            if(!hasIndex(row,column,parent))return QModelIndex();
+            const PlayListItem *parentItem=parent.isValid()?static_cast<PlayListItem *>(parent.internalPointer()):&root;
+            PlayListItem *childItem=parentItem->children->value(row);
+            return childItem?createIndex(row,column,childItem):QModelIndex();
+        }
+        virtual QModelIndex parent(const QModelIndex &child) const override
+        {
+            if(!child.isValid())return QModelIndex();
+            PlayListItem *parentItem=static_cast<PlayListItem *>(child.internalPointer())->parent;
+            if(parentItem==&root)return QModelIndex();
+            return createIndex(rowOf(parentItem),0,parentItem);
+        }
+        virtual int rowCount(const QModelIndex &parent) const override
+        {
+            if(parent.column()>0)return 0;
+            const PlayListItem *parentItem=parent.isValid()?static_cast<PlayListItem *>(parent.internalPointer()):&root;
+            return parentItem->children?parentItem->children->size():0;
+        }
+        virtual int columnCount(const QModelIndex &) const override {return 1;}
+        virtual QVariant data(const QModelIndex &index, int role) const override
+        {
+            if(!index.isValid() || role!=Qt::DisplayRole)return QVariant();
+            return static_cast<PlayListItem *>(index.internalPointer())->title;
+        }
+    private:
+        bool legacyRow;
+    };
+    //collectionCount 0: all items in the root, otherwise spread over that many collections
+    QList<PlayListItem *> build(ItemTreeModel &model,int collectionCount)
+    {
+        QList<PlayListItem *> leaves;
+        QList<PlayListItem *> collections;
+        for(int i=0;i<collectionCount;++i)
+        {
+            PlayListItem *collection=new PlayListItem(&model.root,false);
+            collection->title=QString("Collection %1").arg(i);
+            collections.append(collection);
+        }
+        for(int i=0;i<itemCount;++i)
+        {
+            PlayListItem *item=new PlayListItem(collections.isEmpty()?&model.root:collections.at(i%collectionCount),true);
+            item->title=QString("Episode %1").arg(i);
+            item->path=QString("/anime/%1.mkv").arg(i);
+            leaves.append(item);
+        }
+        return leaves;
+    }
+}
+class PlayListBench : public QObject
+{
+    Q_OBJECT
+private:
+    void addRows();
+private slots:
+    void detachedRow();
+    void indexOfEveryItem_data();
+    void indexOfEveryItem();
+    void indexAfterInsert_data();
+    void indexAfterInsert();
+};
+
+void PlayListBench::addRows()
+{
+    QTest::addColumn<int>("collectionCount");
+    QTest::addColumn<bool>("legacyRow");
+    QTest::newRow("flat-legacy") << 0 << true;
+    QTest::newRow("flat-cached") << 0 << false;
+    QTest::newRow("500collections-legacy") << 500 << true;
+    QTest::newRow("500collections-cached") << 500 << false;
+}
+
+void PlayListBench::detachedRow()
+{
+    PlayListItem root;
+    PlayListItem *first=new PlayListItem(&root,true);
+    PlayListItem *second=new PlayListItem(&root,true);
+    QCOMPARE(second->row(),1);
+    //cut to the clipboard: out of the list, parent still set
+    root.children->removeAt(1);
+    QCOMPARE(second->row(),-1);
+    QCOMPARE(first->row(),0);
+    second->moveTo(&root,0);
+    QCOMPARE(second->row(),0);
+    QCOMPARE(first->row(),1);
+}
+
+void PlayListBench::indexOfEveryItem_data()
+{
+    addRows();
+}
+
+void PlayListBench::indexOfEveryItem()
+{
+    QFETCH(int, collectionCount);
+    QFETCH(bool, legacyRow);
+    ItemTreeModel model(legacyRow);
+    QList<PlayListItem *> leaves(build(model,collectionCount));
+    //what a view does when it scrolls through everything, or a search marks every match
+    QBENCHMARK
+    {
+        for(PlayListItem *item:leaves)
+        {
+            QModelIndex index(model.indexOf(item));
+            QVERIFY(model.parent(index).isValid()==(collectionCount>0));
+        }
+    }
+}
+
+void PlayListBench::indexAfterInsert_data()
+{
+    addRows();
+}
+
+void PlayListBench::indexAfterInsert()
+{
+    QFETCH(int, collectionCount);
+    QFETCH(bool, legacyRow);
+    ItemTreeModel model(legacyRow);
+    QList<PlayListItem *> leaves(build(model,collectionCount));
+    PlayListItem *parentItem=leaves.last()->parent;
+    //every insert at the front makes the rows of all siblings stale
+    QBENCHMARK
+    {
+        for(int i=0;i<100;++i)
+        {
+            PlayListItem *item=new PlayListItem(parentItem,true,0);
+            QCOMPARE(model.indexOf(leaves.last()).row(),parentItem->children->count()-1);
+            parentItem->children->removeAt(0);
+            delete item;
+        }
+    }
+}
+
+QTEST_MAIN(PlayListBench)
+
+#include "tst_playlistbench.moc"
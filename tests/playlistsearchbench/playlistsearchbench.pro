@@ -0,0 +1,14 @@
+include(../common/common.pri)
+
+QT += testlib
+TARGET = playlistsearchbench
+TEMPLATE = app
+
+SOURCES += \
+    tst_playlistsearchbench.cpp \
+    $$PWD/../../Play/Playlist/playlistitem.cpp \
+    $$PWD/../../Play/Playlist/playlistindex.cpp
+
+HEADERS += \
+    $$PWD/../../Play/Playlist/playlistitem.h \
+    $$PWD/../../Play/Playlist/playlistindex.h
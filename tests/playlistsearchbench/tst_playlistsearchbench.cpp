@@ -0,0 +1,146 @@
+#include <QtTest>
+#include "Play/Playlist/playlistitem.h"
+#include "Play/Playlist/playlistindex.h"
+namespace
+{
+    //2000 series of 50 episodes
+    const int seriesCount=2000;
+    const int episodeCount=50;
+    const char *groups[]={"Lilith-Raws","VCB-Studio","Nekomoe","SweetSub","LoliHouse"};
+    const char *syllables[]={"ka","ri","no","shi","ma","to","yu","ki","ra","me","so","ha","ne","mi","ta"};
+    const char *kanji[]={"物","語","少","女","空","海","夜","星","風","花","猫","剣","恋","魔","法"};
+    QString seriesTitle(QRandomGenerator &random)
+    {
+        QString title;
+        int words=2+random.bounded(3);
+        for(int w=0;w<words;++w)
+        {
+            if(w>0)title.append(' ');
+            int length=2+random.bounded(3);
+            for(int i=0;i<length;++i)title.append(syllables[random.bounded(int(sizeof(syllables)/sizeof(syllables[0])))]);
+            title[title.length()-length*2]=title.at(title.length()-length*2).toUpper();
+        }
+        title.append(' ');
+        for(int i=0;i<2;++i)title.append(QString::fromUtf8(kanji[random.bounded(int(sizeof(kanji)/sizeof(kanji[0])))]));
+        return title;
+    }
+    //before the index, every item's text was checked
+    QList<const PlayListItem *> scan(const QList<PlayListItem *> &items,const QString &text,Qt::CaseSensitivity cs)
+    {
+        QList<const PlayListItem *> results;
+        for(const PlayListItem *item:items)
+        {
+            if(item->title.contains(text,cs) || item->animeTitle.contains(text,cs) || item->path.contains(text,cs))
+                results.append(item);
+        }
+        return results;
+    }
+}
+class PlayListSearchBench : public QObject
+{
+    Q_OBJECT
+private:
+    PlayListItem root;
+    QList<PlayListItem *> items;
+    PlayListIndex index;
+    QString sampleTitle;
+private slots:
+    void initTestCase();
+    void buildIndex();
+    void search_data();
+    void search();
+    void updateChurn();
+};
+
+void PlayListSearchBench::initTestCase()
+{
+    QRandomGenerator random(1);
+    for(int s=0;s<seriesCount;++s)
+    {
+        QString title(seriesTitle(random));
+        QString group(groups[random.bounded(int(sizeof(groups)/sizeof(groups[0])))]);
+        PlayListItem *collection=new PlayListItem(&root,false);
+        collection->title=title;
+        for(int e=1;e<=episodeCount;++e)
+        {
+            PlayListItem *item=new PlayListItem(collection,true);
+            item->title=QString("[%1] %2 - %3 [1080p]").arg(group,title).arg(e,2,10,QChar('0'));
+            item->animeTitle=title;
+            item->path=QString("D:/Anime/%1/%2.mkv").arg(title,item->title);
+            items.append(item);
+        }
+        if(s==seriesCount/2)sampleTitle=title;
+    }
+    for(const PlayListItem *item:items)
+        index.update(item);
+}
+
+void PlayListSearchBench::buildIndex()
+{
+    QBENCHMARK
+    {
+        PlayListIndex newIndex;
+        for(const PlayListItem *item:items)
+            newIndex.update(item);
+    }
+}
+
+void PlayListSearchBench::search_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<bool>("caseSensitive");
+    QTest::addColumn<bool>("indexed");
+    QList<QPair<QByteArray,QString> > queries;
+    //every item, one series, one episode of every series, a short query below trigram length, nothing
+    queries << qMakePair(QByteArray("all"),QString("1080p"))
+            << qMakePair(QByteArray("series"),sampleTitle)
+            << qMakePair(QByteArray("episode"),QString("- 07 ["))
+            << qMakePair(QByteArray("short"),QString("物語"))
+            << qMakePair(QByteArray("none"),QString("zzqxj"));
+    for(const auto &query:queries)
+    {
+        QTest::newRow((query.first+"-scan").constData()) << query.second << false << false;
+        QTest::newRow((query.first+"-index").constData()) << query.second << false << true;
+    }
+    QTest::newRow("series-cs-scan") << sampleTitle.toLower() << true << false;
+    QTest::newRow("series-cs-index") << sampleTitle.toLower() << true << true;
+}
+
+void PlayListSearchBench::search()
+{
+    QFETCH(QString, text);
+    QFETCH(bool, caseSensitive);
+    QFETCH(bool, indexed);
+    Qt::CaseSensitivity cs=caseSensitive?Qt::CaseSensitive:Qt::CaseInsensitive;
+    QList<const PlayListItem *> results;
+    QBENCHMARK
+    {
+        results=indexed?index.search(text,cs):scan(items,text,cs);
+    }
+    //both give the same items in the same order
+    QCOMPARE(results,scan(items,text,cs));
+}
+
+void PlayListSearchBench::updateChurn()
+{
+    //renames and matches re-index single items while the list is searched
+    PlayListIndex churnIndex;
+    for(const PlayListItem *item:items)
+        churnIndex.update(item);
+    QList<PlayListItem *> changed(items.mid(0,1000));
+    int round=0;
+    QBENCHMARK
+    {
+        ++round;
+        for(PlayListItem *item:changed)
+        {
+            item->title=QString("%1 v%2").arg(item->animeTitle).arg(round);
+            churnIndex.update(item);
+        }
+        QCOMPARE(churnIndex.search(QString(" v%1").arg(round),Qt::CaseSensitive).count(),changed.count());
+    }
+}
+
+QTEST_MAIN(PlayListSearchBench)
+
+#include "tst_playlistsearchbench.moc"
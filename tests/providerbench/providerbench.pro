@@ -0,0 +1,36 @@
+include(../common/common.pri)
+include(../common/danmucore.pri)
+include(../common/network.pri)
+include(../common/provider.pri)
+
+QT += testlib
+TARGET = providerbench
+TEMPLATE = app
+
+# the cases to record, see tst_providerbench.cpp
+DEFINES += PROVIDER_FIXTURE_DIR=\\\"$$PWD/fixtures\\\"
+
+SOURCES += \
+    tst_providerbench.cpp \
+    syntheticfixtures.cpp \
+    $$PWD/../../Play/Danmu/providermanager.cpp \
+    $$PWD/../../Play/Danmu/Provider/bilibiliprovider.cpp \
+    $$PWD/../../Play/Danmu/Provider/acfunprovider.cpp \
+    $$PWD/../../Play/Danmu/Provider/tucaoprovider.cpp \
+    $$PWD/../../Play/Danmu/Provider/dililiprovider.cpp \
+    $$PWD/../../Play/Danmu/Provider/dandanprovider.cpp \
+    $$PWD/../../Play/Danmu/Provider/bahamutprovider.cpp \
+    $$PWD/../../Play/Danmu/Provider/iqiyiprovider.cpp \
+    $$PWD/../../Common/htmlparsersax.cpp
+
+HEADERS += \
+    syntheticfixtures.h \
+    $$PWD/../../Play/Danmu/providermanager.h \
+    $$PWD/../../Play/Danmu/Provider/bilibiliprovider.h \
+    $$PWD/../../Play/Danmu/Provider/acfunprovider.h \
+    $$PWD/../../Play/Danmu/Provider/tucaoprovider.h \
+    $$PWD/../../Play/Danmu/Provider/dililiprovider.h \
+    $$PWD/../../Play/Danmu/Provider/dandanprovider.h \
+    $$PWD/../../Play/Danmu/Provider/bahamutprovider.h \
+    $$PWD/../../Play/Danmu/Provider/iqiyiprovider.h \
+    $$PWD/../../Common/htmlparsersax.h
@@ -0,0 +1,256 @@
+#include "syntheticfixtures.h"
+#include <QtCore>
+#include "danmugenerator.h"
+#include "Play/Danmu/common.h"
+namespace
+{
+    const quint32 fixtureMagic=0x4b504658; //as in Common/network.cpp
+    const char keyword[]="keion";
+    const int episodeDuration=1440; //s
+    //mode of the XML and JSON formats for Rolling, Top, Bottom
+    const int modes[]={1,5,4};
+
+    class FixtureWriter
+    {
+    public:
+        explicit FixtureWriter(const QString &dir):dir(dir){}
+        //same url as Network::httpGet(url,query) and Network::httpPost(url,data) request
+        void get(const QString &url,const QUrlQuery &query,const QByteArray &content)
+        {
+            QUrl queryUrl(url);
+            if(!query.isEmpty())
+                queryUrl.setQuery(query);
+            write("GET ",queryUrl,QByteArray(),content);
+        }
+        void post(const QString &url,const QByteArray &data,const QByteArray &content)
+        {
+            write("POST ",QUrl(url),data,content);
+        }
+    private:
+        QString dir;
+        void write(const char *op,const QUrl &url,const QByteArray &data,const QByteArray &content)
+        {
+            QByteArray key(op);
+            key.append(url.toEncoded());
+            key.append('\n');
+            key.append(data);
+            QFile file(QString("%1/%2.fixture").arg(dir,QString(QCryptographicHash::hash(key,QCryptographicHash::Sha1).toHex())));
+            if(!file.open(QIODevice::WriteOnly))return;
+            QDataStream ds(&file);
+            ds<<fixtureMagic<<url.toString()<<content;
+        }
+    };
+    QList<DanmuComment *> episodeDanmu(quint32 seed)
+    {
+        DanmuWorkload workload;
+        workload.duration=episodeDuration;
+        workload.commentsPerSecond=2;
+        workload.seed=seed;
+        return DanmuGenerator::generate(workload);
+    }
+    QByteArray toJson(const QJsonObject &obj){return QJsonDocument(obj).toJson(QJsonDocument::Compact);}
+    QByteArray toJson(const QJsonArray &array){return QJsonDocument(array).toJson(QJsonDocument::Compact);}
+
+    void writeBilibili(FixtureWriter &writer)
+    {
+        const int mediaId=28220978,aid=32531200,cid=56969401;
+        QUrlQuery searchQuery;
+        searchQuery.addQueryItem("keyword",keyword);
+        QJsonObject bangumi{{"title","<em class=\"keyword\">Keion</em>"},{"desc","synthetic"},{"media_id",mediaId}};
+        writer.get("https://api.bilibili.com/x/web-interface/search/all",searchQuery,
+                   toJson(QJsonObject{{"data",QJsonObject{{"result",QJsonObject{{"media_bangumi",QJsonArray{bangumi}}}}}}}));
+        QJsonArray episodes;
+        for(int i=0;i<12;++i)
+            episodes.append(QJsonObject{{"index_title",QString("Episode %1").arg(i+1)},{"index",QString::number(i+1)},
+                                        {"cid",cid+i},{"aid",aid},{"duration",episodeDuration*1000}});
+        QUrlQuery seasonQuery;
+        seasonQuery.addQueryItem("media_id",QString::number(mediaId));
+        writer.get("https://bangumi.bilibili.com/view/web_api/season",seasonQuery,
+                   toJson(QJsonObject{{"result",QJsonObject{{"episodes",episodes}}}}));
+        QList<DanmuComment *> danmuList(episodeDanmu(1));
+        writer.get(QString("http://comment.bilibili.com/%1.xml").arg(cid),QUrlQuery(),DanmuGenerator::toXml(danmuList));
+        qDeleteAll(danmuList);
+    }
+
+    void writeAcfun(FixtureWriter &writer)
+    {
+        const int videoId=9876543;
+        QUrlQuery searchQuery;
+        searchQuery.addQueryItem("q", keyword);
+        searchQuery.addQueryItem("isArticle", "1");
+        searchQuery.addQueryItem("pageSize", "20");
+        searchQuery.addQueryItem("pageNo", "1");
+        searchQuery.addQueryItem("aiCount", "3");
+        searchQuery.addQueryItem("spCount", "3");
+        searchQuery.addQueryItem("sortField", "score");
+        QJsonObject listItem{{"title","Keion"},{"description","synthetic"},{"contentId","ac4418423"}};
+        writer.get("http://search.aixifan.com/search",searchQuery,
+                   toJson(QJsonObject{{"data",QJsonObject{{"page",QJsonObject{{"list",QJsonArray{listItem}}}}}}}));
+        writer.get("http://www.acfun.cn/v/ac4418423",QUrlQuery(),
+                   QString("<script>var pageInfo={\"videoId\":%1,\"title\":\"Keion\"};</script>").arg(videoId).toUtf8());
+        //pages of 1000 from the newest, each one starts below the date of the last comment of the previous one
+        QList<DanmuComment *> danmuList(episodeDanmu(2));
+        for(int i=0;i<danmuList.count();++i)
+            danmuList[i]->date=1500000000000LL+i*1000LL;
+        QString timeStamp("4073558400000");
+        int next=danmuList.count()-1;
+        QJsonArray page;
+        do
+        {
+            page=QJsonArray();
+            int end=qMax(-1,next-1000);
+            QString lastDate;
+            for(int i=next;i>end;--i)
+            {
+                const DanmuComment *danmu=danmuList.at(i);
+                page.append(QJsonObject{{"c",QString("%1,%2,%3,25,%4,%5").arg(danmu->originTime/1000.0,0,'f',3).arg(danmu->color)
+                                         .arg(modes[danmu->type]).arg(danmu->sender).arg(danmu->date)},{"m",danmu->text}});
+                lastDate=QString::number(danmu->date);
+            }
+            QUrlQuery pageQuery;
+            pageQuery.addQueryItem("order", "-1");
+            writer.get(QString("http://danmu.aixifan.com/V4/%1_2/%2/1000").arg(videoId).arg(timeStamp),pageQuery,
+                       toJson(QJsonArray{QJsonArray(),QJsonArray(),page}));
+            timeStamp=lastDate;
+            next=end;
+        }while(page.count()>=1000);
+        qDeleteAll(danmuList);
+    }
+
+    void writeTucao(FixtureWriter &writer)
+    {
+        const int hid=4077044;
+        QUrlQuery searchQuery;
+        searchQuery.addQueryItem("m", "search");
+        searchQuery.addQueryItem("a", "init2");
+        searchQuery.addQueryItem("time", "all");
+        searchQuery.addQueryItem("q", keyword);
+        writer.get("http://www.tucao.one/index.php",searchQuery,
+                   QString("<div class=\"search_list\" style=\"border-top:1px solid #eee;\"><div class=\"list\"><div class=\"info\">"
+                           "<a class=\"blue\" href=\"http://www.tucao.one/play/h%1/\">Keion</a><div class=\"d\">synthetic</div>"
+                           "</div></div></div><div id=\"float_show\"></div>").arg(hid).toUtf8());
+        QString eps;
+        for(int i=0;i<12;++i)
+            eps+=QString("|Episode %1*http://www.tucao.one/play/h%2/#%3").arg(i+1).arg(hid).arg(i+1);
+        writer.get(QString("http://www.tucao.one/play/h%1/").arg(hid),QUrlQuery(),
+                   QString("<h1 class=\"show_title\">Keion<span style=\"color:#F40;\">[12]</span></h1>"
+                           "<ul id=\"player_code\" mid=\"1\"><li>11%1</li><li></li></ul>").arg(eps).toUtf8());
+        QUrlQuery downloadQuery;
+        downloadQuery.addQueryItem("m", "mukio");
+        downloadQuery.addQueryItem("a", "init");
+        downloadQuery.addQueryItem("c", "index");
+        downloadQuery.addQueryItem("playerID", QString("11-%1-1-0").arg(hid));
+        QList<DanmuComment *> danmuList(episodeDanmu(3));
+        writer.get("http://www.tucao.one/index.php",downloadQuery,DanmuGenerator::toXml(danmuList));
+        qDeleteAll(danmuList);
+    }
+
+    void writeDilili(FixtureWriter &writer)
+    {
+        const QString bangumiUrl("https://www.5dm.tv/bangumi/dv41292");
+        writer.get(QString("https://www.5dm.tv/search/%1").arg(keyword),QUrlQuery(),
+                   QString("<div class=\"post_ajax_tm\"><div class=\"video-item\"><h3><a href=\"%1\" title=\"Keion\">Keion</a></h3>"
+                           "<div class=\"item-content hidden\"><p>synthetic</p></div></div><div class=\"clearfix\"></div> </div>").arg(bangumiUrl).toUtf8());
+        QString rows;
+        for(int i=0;i<12;++i)
+            rows+=QString("<tr><td><a href=\"%1?link=%2\"><i class=\"fa\"></i>Episode %3</a></td></tr>").arg(bangumiUrl).arg(i).arg(i+1);
+        writer.get(bangumiUrl,QUrlQuery(),QString("<table class=\"table table-bordered\">%1</table>").arg(rows).toUtf8());
+        writer.get(bangumiUrl+"?link=0",QUrlQuery(),
+                   QByteArray("<h1 class=\"video-title\">Keion 01</h1><div id=\"player-embed\"><iframe src=\"https://www.5dm.tv/player/?cid=41292_0&t=1\"></iframe></div>"));
+        QUrlQuery downloadQuery;
+        downloadQuery.addQueryItem("id", "41292_0");
+        QList<DanmuComment *> danmuList(episodeDanmu(4));
+        writer.get("https://www.5dm.tv/player/xml.php",downloadQuery,DanmuGenerator::toXml(danmuList));
+        qDeleteAll(danmuList);
+    }
+
+    void writeDandan(FixtureWriter &writer)
+    {
+        const int episodeId=100960001;
+        QJsonArray episodes;
+        for(int i=0;i<12;++i)
+            episodes.append(QJsonObject{{"episodeId",episodeId+i},{"episodeTitle",QString("Episode %1").arg(i+1)}});
+        QUrlQuery searchQuery;
+        searchQuery.addQueryItem("anime", keyword);
+        writer.get("https://api.acplay.net/api/v2/search/episodes",searchQuery,
+                   toJson(QJsonObject{{"success",true},{"animes",QJsonArray{QJsonObject{{"animeTitle","Keion"},{"episodes",episodes}}}}}));
+        QList<DanmuComment *> danmuList(episodeDanmu(5));
+        QJsonArray comments;
+        int cid=0;
+        for(const DanmuComment *danmu:danmuList)
+            comments.append(QJsonObject{{"cid",++cid},{"p",QString("%1,%2,%3,%4").arg(danmu->originTime/1000.0,0,'f',2)
+                                         .arg(modes[danmu->type]).arg(danmu->color).arg(danmu->sender)},{"m",danmu->text}});
+        writer.get(QString("https://api.acplay.net/api/v2/comment/%1").arg(episodeId),QUrlQuery(),
+                   toJson(QJsonObject{{"count",comments.count()},{"comments",comments}}));
+        qDeleteAll(danmuList);
+    }
+
+    void writeBahamut(FixtureWriter &writer)
+    {
+        const int refSn=111,videoSn=2001;
+        QUrlQuery searchQuery;
+        searchQuery.addQueryItem("kw", keyword);
+        writer.get("https://ani.gamer.com.tw/search.php",searchQuery,
+                   QString("<ul class=\"anime_list\"><li><a href=\"animeRef.php?sn=%1\"><div class=\"info\"><p>Keion</p>"
+                           "<p>synthetic</p></div></a></li></ul>").arg(refSn).toUtf8());
+        QString eps;
+        for(int i=0;i<12;++i)
+            eps+=QString("<li><a href=\"?sn=%1\">%2</a></li>").arg(videoSn+i).arg(i+1);
+        QUrlQuery epQuery;
+        epQuery.addQueryItem("sn",QString::number(refSn));
+        //the real page redirects to animeVideo.php, replay answers with the episode list directly
+        writer.get("https://ani.gamer.com.tw/animeRef.php",epQuery,QString("<section class=\"season\"><ul>%1</ul></section>").arg(eps).toUtf8());
+        QList<DanmuComment *> danmuList(episodeDanmu(6));
+        QJsonArray comments;
+        for(const DanmuComment *danmu:danmuList)
+            comments.append(QJsonObject{{"text",danmu->text},{"color",QString("#%1").arg(danmu->color,6,16,QChar('0'))},
+                                        {"size",1},{"position",int(danmu->type)},{"time",danmu->originTime/100},{"userid",danmu->sender}});
+        writer.post("https://ani.gamer.com.tw/ajax/danmuGet.php",QString("sn=%1").arg(videoSn).toUtf8(),toJson(comments));
+        qDeleteAll(danmuList);
+    }
+
+    void writeIqiyi(FixtureWriter &writer)
+    {
+        const QString videoUrl("https://www.iqiyi.com/v_19rr1jer2o.html");
+        const QString tvId("1234567890");
+        writer.get(QString("https://so.iqiyi.com/so/q_%1_site_iqiyi_m_").arg(keyword),QUrlQuery(),
+                   QString("<ul class=\"mod_result_list\"><li class=\"list_item\" data-widget-searchlist-tvname=\"Keion\">"
+                           "<h3 class=\"result_title\"><a href=\"%1\" title=\"Keion\">Keion</a></h3>"
+                           "<span class=\"result_info_txt\">synthetic</span></li></ul><div class=\"mod-page\"></div>").arg(videoUrl).toUtf8());
+        writer.get(videoUrl,QUrlQuery(),QString("<script>var info={\"tvId\":%1,\"tvName\":\"Keion\",\"vid\":\"0\"};</script>").arg(tvId).toUtf8());
+        //5-minute segments until one is missing
+        QString paddedId("0000"+tvId);
+        QString segmentUrl(QString("http://cmts.iqiyi.com/bullet/%1/%2/%3_300_%4.z").arg(paddedId.mid(paddedId.length()-4,2))
+                           .arg(paddedId.mid(paddedId.length()-2)).arg(tvId));
+        QList<DanmuComment *> danmuList(episodeDanmu(7));
+        for(int segment=0;segment*300<episodeDuration;++segment)
+        {
+            QList<DanmuComment *> segmentList;
+            for(DanmuComment *danmu:danmuList)
+                if(danmu->originTime/300000==segment)segmentList.append(danmu);
+            //qCompress prepends the uncompressed length to a zlib stream
+            writer.get(segmentUrl.arg(segment+1),QUrlQuery(),qCompress(DanmuGenerator::toIqiyiXml(segmentList)).mid(4));
+        }
+        qDeleteAll(danmuList);
+    }
+}
+
+QJsonArray SyntheticFixtures::write(const QString &dir)
+{
+    QDir().mkpath(dir);
+    FixtureWriter writer(dir);
+    writeBilibili(writer);
+    writeAcfun(writer);
+    writeTucao(writer);
+    writeDilili(writer);
+    writeDandan(writer);
+    writeBahamut(writer);
+    writeIqiyi(writer);
+    QJsonArray cases;
+    for(const char *providerId:{"Bilibili","Acfun","Tucao","5dm","Dandan","Gamer","Iqiyi"})
+        cases.append(QJsonObject{{"provider",providerId},{"keyword",keyword}});
+    QFile casesFile(dir+"/cases.json");
+    if(casesFile.open(QIODevice::WriteOnly))
+        casesFile.write(QJsonDocument(cases).toJson());
+    return cases;
+}
@@ -0,0 +1,15 @@
+#ifndef SYNTHETICFIXTURES_H
+#define SYNTHETICFIXTURES_H
+#include <QJsonArray>
+#include <QString>
+//Offline replies for every provider: a search with one result, its episodes and the comments of
+//one 24-minute episode, in the fixture format of Common/network.cpp.
+//URLs are built the way the providers build them, so the replay finds them under the same key.
+class SyntheticFixtures
+{
+public:
+    //writes the fixtures and cases.json to dir, returns the cases
+    static QJsonArray write(const QString &dir);
+};
+
+#endif // SYNTHETICFIXTURES_H
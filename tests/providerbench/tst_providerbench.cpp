@@ -0,0 +1,183 @@
+#include <QtTest>
+#include <new>
+#include <cstdlib>
+#include "globalobjects.h"
+#include "Play/Danmu/providermanager.h"
+#include "syntheticfixtures.h"
+//Runs ProviderManager search -> getEpInfo -> downloadDanmu for every case in cases.json,
+//each stage is measured on its own while the stages before it run once untimed.
+//Without KIKOPLAY_FIXTURE_DIR, synthetic replies of every provider are written to a temporary directory and replayed.
+//Record real ones for fixtures/cases.json once with
+//  KIKOPLAY_FIXTURE=record providerbench
+//and replay them with KIKOPLAY_FIXTURE_DIR pointing there.
+//KIKOPLAY_FIXTURE_LATENCY and KIKOPLAY_FIXTURE_BANDWIDTH work as in Common/network.h
+namespace
+{
+    enum Stage
+    {
+        Search,
+        EpInfo,
+        Download
+    };
+    //operator new calls of the whole process, QString/QByteArray/QList data come from malloc and are not counted
+    QAtomicInteger<qint64> allocCount(0),allocBytes(0);
+}
+void *operator new(std::size_t size)
+{
+    allocCount.fetchAndAddRelaxed(1);
+    allocBytes.fetchAndAddRelaxed(qint64(size));
+    if(void *p=std::malloc(size?size:1))return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+class ProviderBench : public QObject
+{
+    Q_OBJECT
+private:
+    QThread *workThread;
+    ProviderManager *providerManager;
+    QTemporaryDir syntheticDir;
+    //the first search result, or the first episode of it, as a user would pick
+    DanmuAccessResult *search(const QString &providerId,const QString &keyword);
+    DanmuAccessResult *getEpInfo(const QString &providerId,DanmuSourceItem *item);
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void pipeline_data();
+    void pipeline();
+};
+
+DanmuAccessResult *ProviderBench::search(const QString &providerId, const QString &keyword)
+{
+    DanmuAccessResult *result=providerManager->search(providerId,keyword);
+    if(!result->error && result->list.isEmpty())
+    {
+        result->error=true;
+        result->errorInfo="no search result";
+    }
+    return result;
+}
+
+DanmuAccessResult *ProviderBench::getEpInfo(const QString &providerId, DanmuSourceItem *item)
+{
+    DanmuAccessResult *result=providerManager->getEpInfo(providerId,item);
+    if(!result->error && result->list.isEmpty())
+    {
+        result->error=true;
+        result->errorInfo="no episode";
+    }
+    return result;
+}
+
+void ProviderBench::initTestCase()
+{
+    //read once by the network client, so before the first request
+    if(qEnvironmentVariableIsEmpty("KIKOPLAY_FIXTURE"))
+        qputenv("KIKOPLAY_FIXTURE","replay");
+    if(qEnvironmentVariableIsEmpty("KIKOPLAY_FIXTURE_DIR"))
+    {
+        if(qgetenv("KIKOPLAY_FIXTURE")=="record")
+        {
+            qputenv("KIKOPLAY_FIXTURE_DIR",QByteArray(PROVIDER_FIXTURE_DIR));
+        }
+        else
+        {
+            QVERIFY(syntheticDir.isValid());
+            SyntheticFixtures::write(syntheticDir.path());
+            qputenv("KIKOPLAY_FIXTURE_DIR",QFile::encodeName(syntheticDir.path()));
+        }
+    }
+    workThread=new QThread;
+    workThread->setObjectName(QStringLiteral("workThread"));
+    workThread->start();
+    GlobalObjects::workThread=workThread;
+    providerManager=new ProviderManager;
+}
+
+void ProviderBench::cleanupTestCase()
+{
+    workThread->quit();
+    workThread->wait();
+}
+
+void ProviderBench::pipeline_data()
+{
+    QTest::addColumn<QString>("providerId");
+    QTest::addColumn<QString>("keyword");
+    QTest::addColumn<int>("stage");
+    QFile casesFile(QString::fromLocal8Bit(qgetenv("KIKOPLAY_FIXTURE_DIR"))+"/cases.json");
+    if(!casesFile.open(QIODevice::ReadOnly))return;
+    const QJsonArray cases(QJsonDocument::fromJson(casesFile.readAll()).array());
+    for(const QJsonValue &value:cases)
+    {
+        QString providerId(value.toObject().value("provider").toString());
+        QString keyword(value.toObject().value("keyword").toString());
+        QTest::newRow(QString("%1-search").arg(providerId).toUtf8()) << providerId << keyword << int(Search);
+        QTest::newRow(QString("%1-epinfo").arg(providerId).toUtf8()) << providerId << keyword << int(EpInfo);
+        QTest::newRow(QString("%1-download").arg(providerId).toUtf8()) << providerId << keyword << int(Download);
+    }
+}
+
+void ProviderBench::pipeline()
+{
+    QFETCH(QString, providerId);
+    QFETCH(QString, keyword);
+    QFETCH(int, stage);
+    QScopedPointer<DanmuAccessResult> searchResult,epInfo;
+    QList<DanmuComment *> danmuList;
+    std::function<QString()> runStage;
+    if(stage==Search)
+    {
+        runStage=[&]()->QString{
+            QScopedPointer<DanmuAccessResult> result(search(providerId,keyword));
+            return result->error?result->errorInfo:QString();
+        };
+    }
+    else
+    {
+        searchResult.reset(search(providerId,keyword));
+        if(searchResult->error)QSKIP(qPrintable(searchResult->errorInfo));
+        if(stage==EpInfo)
+        {
+            runStage=[&]()->QString{
+                DanmuSourceItem item(searchResult->list.first());
+                QScopedPointer<DanmuAccessResult> result(getEpInfo(providerId,&item));
+                return result->error?result->errorInfo:QString();
+            };
+        }
+        else
+        {
+            DanmuSourceItem item(searchResult->list.first());
+            epInfo.reset(getEpInfo(providerId,&item));
+            if(epInfo->error)QSKIP(qPrintable(epInfo->errorInfo));
+            runStage=[&]()->QString{
+                qDeleteAll(danmuList);
+                danmuList.clear();
+                //providers rewrite the item while downloading, every run starts from the episode as listed
+                DanmuSourceItem item(epInfo->list.first());
+                return providerManager->downloadDanmu(epInfo->providerId,&item,danmuList);
+            };
+        }
+    }
+    QBENCHMARK
+    {
+        QString errorInfo(runStage());
+        if(!errorInfo.isEmpty())QSKIP(qPrintable(errorInfo));
+    }
+    //one more run, counted on its own
+    qint64 count=allocCount.load(),bytes=allocBytes.load();
+    runStage();
+    count=allocCount.load()-count;
+    bytes=allocBytes.load()-bytes;
+    qInfo("%s: %lld allocations, %lld KB by operator new", QTest::currentDataTag(), count, bytes/1024);
+    if(stage==Download)
+        qInfo("%s: %d danmu", QTest::currentDataTag(), danmuList.count());
+    qDeleteAll(danmuList);
+}
+
+QTEST_MAIN(ProviderBench)
+
+#include "tst_providerbench.moc"
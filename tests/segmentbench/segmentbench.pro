@@ -0,0 +1,10 @@
+include(../common/common.pri)
+include(../common/network.pri)
+include(../common/provider.pri)
+
+QT += testlib
+TARGET = segmentbench
+TEMPLATE = app
+
+SOURCES += \
+    tst_segmentbench.cpp
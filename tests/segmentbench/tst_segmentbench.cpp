@@ -0,0 +1,154 @@
+#include <QtTest>
+#include "danmugenerator.h"
+#include "stubhttpserver.h"
+#include "Common/zlibstream.h"
+#include "Play/Danmu/Provider/providerbase.h"
+namespace
+{
+    //5-minute segments of a 2-hour movie, as iqiyi serves them
+    const int segmentCount=24;
+    const int segmentLength=300;
+    class SegmentProvider : public ProviderBase
+    {
+    public:
+        inline virtual bool supportSearch(){return false;}
+        inline virtual QString id(){return "Segment";}
+        inline virtual QStringList supportedURLs(){return QStringList();}
+        inline virtual QString sourceURL(DanmuSourceItem *){return QString();}
+        inline virtual bool supportSourceURL(const QString &){return false;}
+        inline virtual DanmuAccessResult *search(const QString &){return nullptr;}
+        inline virtual DanmuAccessResult *getEpInfo(DanmuSourceItem *){return nullptr;}
+        inline virtual DanmuAccessResult *getURLInfo(const QString &){return nullptr;}
+        inline virtual QString downloadDanmu(DanmuSourceItem *,QList<DanmuComment *> &){return QString();}
+        inline virtual QString downloadBySourceURL(const QString &,QList<DanmuComment *> &){return QString();}
+        QString download(const QString &baseUrl,int count,int maxInFlight,QList<DanmuComment *> &danmuList);
+    private:
+        //the fields IqiyiProvider reads
+        class BulletDecoder : public SegmentDecoder
+        {
+        public:
+            BulletDecoder():xmlReader([this](QXmlStreamReader &reader){
+                if(reader.isStartElement())
+                    elementText.clear();
+                else if(reader.isCharacters())
+                    elementText.append(reader.text());
+                else if(reader.isEndElement())
+                {
+                    if(reader.name()=="content")
+                        tmpDanmu.text=elementText;
+                    else if(reader.name()=="showTime")
+                        tmpDanmu.originTime=tmpDanmu.time=elementText.toFloat()*1000;
+                    else if(reader.name()=="color")
+                        tmpDanmu.color=elementText.toInt(nullptr,16);
+                    else if(reader.name()=="uid")
+                        tmpDanmu.sender="[iqiyi]"+elementText;
+                    else if(reader.name()=="bulletInfo")
+                        danmuList.append(new DanmuComment(tmpDanmu));
+                    elementText.clear();
+                }
+            })
+            {
+                tmpDanmu.setType(1);
+                tmpDanmu.fontSizeLevel=DanmuComment::Normal;
+            }
+            virtual bool feed(const QByteArray &chunk) override {return xmlReader.feed(chunk);}
+        private:
+            InflateXmlReader xmlReader;
+            DanmuComment tmpDanmu;
+            QString elementText;
+        };
+    };
+    QString SegmentProvider::download(const QString &baseUrl, int count, int maxInFlight, QList<DanmuComment *> &danmuList)
+    {
+        return downloadSegments([baseUrl](int index){
+            return QString("%1/seg/%2").arg(baseUrl).arg(index+1);
+        },count,[](){
+            return new BulletDecoder;
+        },danmuList,maxInFlight);
+    }
+}
+class SegmentBench : public QObject
+{
+    Q_OBJECT
+private:
+    StubHttpServer *server;
+    QVector<QByteArray> segments;
+    int totalCount;
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void downloadSegments_data();
+    void downloadSegments();
+};
+
+void SegmentBench::initTestCase()
+{
+    totalCount=0;
+    for(int i=0;i<segmentCount;++i)
+    {
+        DanmuWorkload workload;
+        workload.duration=segmentLength;
+        workload.commentsPerSecond=10;
+        workload.seed=i+1;
+        QList<DanmuComment *> danmuList(DanmuGenerator::generate(workload));
+        for(DanmuComment *danmu:danmuList)
+            danmu->originTime=danmu->time+=i*segmentLength*1000;
+        totalCount+=danmuList.count();
+        //qCompress prepends the uncompressed length to a zlib stream
+        segments.append(qCompress(DanmuGenerator::toIqiyiXml(danmuList)).mid(4));
+        qDeleteAll(danmuList);
+    }
+    server=new StubHttpServer([this](const QByteArray &,const QByteArray &path,const QByteArray &,QByteArray &body){
+        int index=path.startsWith("/seg/")?path.mid(5).toInt()-1:-1;
+        if(index<0 || index>=segments.count())return 404;
+        body=segments.at(index);
+        return 200;
+    });
+    QVERIFY(server->isListening());
+}
+
+void SegmentBench::cleanupTestCase()
+{
+    delete server;
+}
+
+void SegmentBench::downloadSegments_data()
+{
+    QTest::addColumn<int>("latency");
+    QTest::addColumn<int>("maxInFlight");
+    QTest::addColumn<bool>("countKnown");
+    for(int latency:{0,20,80})
+    {
+        for(int maxInFlight:{1,4,8})
+        {
+            QTest::newRow(QString("%1ms-window%2").arg(latency).arg(maxInFlight).toLatin1()) << latency << maxInFlight << true;
+            QTest::newRow(QString("%1ms-window%2-probe").arg(latency).arg(maxInFlight).toLatin1()) << latency << maxInFlight << false;
+        }
+    }
+}
+
+void SegmentBench::downloadSegments()
+{
+    QFETCH(int, latency);
+    QFETCH(int, maxInFlight);
+    QFETCH(bool, countKnown);
+    server->setLatency(latency);
+    SegmentProvider provider;
+    QList<DanmuComment *> danmuList;
+    QBENCHMARK
+    {
+        qDeleteAll(danmuList);
+        danmuList.clear();
+        QString errInfo(provider.download(server->baseUrl(),countKnown?segmentCount:-1,maxInFlight,danmuList));
+        QVERIFY(errInfo.isEmpty());
+    }
+    QCOMPARE(danmuList.count(),totalCount);
+    //segments are merged in order
+    for(int i=1;i<danmuList.count();++i)
+        QVERIFY(danmuList.at(i-1)->time/1000/segmentLength<=danmuList.at(i)->time/1000/segmentLength);
+    qDeleteAll(danmuList);
+}
+
+QTEST_MAIN(SegmentBench)
+
+#include "tst_segmentbench.moc"
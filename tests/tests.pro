@@ -0,0 +1,15 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    danmurenderbench \
+    danmupoolbench \
+    blockerbench \
+    xmlimportbench \
+    layoutbench \
+    torrentbench \
+    networkbench \
+    segmentbench \
+    inflatebench \
+    providerbench \
+    playlistbench \
+    playlistsearchbench
@@ -0,0 +1,18 @@
+include(../common/common.pri)
+
+QT += testlib
+TARGET = torrentbench
+TEMPLATE = app
+
+# torrent.cpp includes mpvplayer.h, the mpv headers are part of the tree
+INCLUDEPATH += \
+    $$PWD/../../Play/Video
+
+SOURCES += \
+    tst_torrentbench.cpp \
+    $$PWD/../../Download/torrent.cpp \
+    $$PWD/../../Download/util.cpp
+
+HEADERS += \
+    $$PWD/../../Download/torrent.h \
+    $$PWD/../../Download/util.h
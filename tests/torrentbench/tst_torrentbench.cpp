@@ -0,0 +1,78 @@
+#include <QtTest>
+#include "Download/torrent.h"
+namespace
+{
+    QByteArray bencode(const QByteArray &str)
+    {
+        return QByteArray::number(str.length())+':'+str;
+    }
+    QByteArray bencode(qint64 val)
+    {
+        return 'i'+QByteArray::number(val)+'e';
+    }
+    //a multi-file torrent of dirCount directories with filesPerDir files each, keys are in bencode order
+    QByteArray generateTorrent(int dirCount,int filesPerDir,quint32 seed)
+    {
+        QRandomGenerator random(seed);
+        const qint64 pieceLength=4*1024*1024;
+        qint64 totalLength=0;
+        QByteArray files("l");
+        for(int i=0;i<dirCount;++i)
+        {
+            for(int j=0;j<filesPerDir;++j)
+            {
+                qint64 length=random.bounded(1024*1024*1024)+1;
+                totalLength+=length;
+                files+="d"+bencode("length")+bencode(length)+bencode("path")+"l"+bencode(QString("Season %1").arg(i).toUtf8())
+                        +bencode(QString("[KikoPlay] 第%1话 %2.mkv").arg(j,3,10,QChar('0')).arg(random.generate()).toUtf8())+"ee";
+            }
+        }
+        files+="e";
+        QByteArray pieces((totalLength+pieceLength-1)/pieceLength*20,'\0');
+        for(int i=0;i<pieces.length();++i)
+            pieces[i]=char(random.bounded(256));
+        QByteArray info("d");
+        info+=bencode("files")+files;
+        info+=bencode("name")+bencode("generated");
+        info+=bencode("piece length")+bencode(pieceLength);
+        info+=bencode("pieces")+bencode(pieces);
+        info+="e";
+        return "d"+bencode("announce")+bencode("http://tracker.example.com/announce")+bencode("info")+info+"e";
+    }
+}
+class TorrentBench : public QObject
+{
+    Q_OBJECT
+private slots:
+    void decodeTorrent_data();
+    void decodeTorrent();
+};
+
+void TorrentBench::decodeTorrent_data()
+{
+    QTest::addColumn<QByteArray>("content");
+    QTest::addColumn<int>("fileCount");
+    QTest::newRow("100 files") << generateTorrent(4,25,1) << 100;
+    QTest::newRow("2k files") << generateTorrent(20,100,1) << 2000;
+    QTest::newRow("20k files") << generateTorrent(100,200,1) << 20000;
+}
+
+void TorrentBench::decodeTorrent()
+{
+    QFETCH(QByteArray, content);
+    QFETCH(int, fileCount);
+    int decodedCount=0;
+    QBENCHMARK
+    {
+        TorrentDecoder decoder(content);
+        decodedCount=0;
+        for(TorrentFile *dir:decoder.root->children)
+            decodedCount+=dir->children.count();
+        delete decoder.root;
+    }
+    QCOMPARE(decodedCount,fileCount);
+}
+
+QTEST_MAIN(TorrentBench)
+
+#include "tst_torrentbench.moc"
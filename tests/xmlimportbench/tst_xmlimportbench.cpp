@@ -0,0 +1,172 @@
+#include <QtTest>
+#include "danmugenerator.h"
+#include "Play/Danmu/Provider/localprovider.h"
+namespace
+{
+    //throughput is averaged over at least this long
+    const int minMeasureTime=500;
+    //LoadXmlDanmuFile before the scanner: QXmlStreamReader and a split of p
+    void legacyLoadXmlDanmuFile(const QString &filePath, QList<DanmuComment *> &list)
+    {
+        QFile xmlFile(filePath);
+        if(!xmlFile.open(QIODevice::ReadOnly|QIODevice::Text))return;
+        QXmlStreamReader reader(&xmlFile);
+        while(!reader.atEnd())
+        {
+            if(reader.isStartElement() && reader.name()=="d")
+            {
+                QXmlStreamAttributes attributes=reader.attributes();
+                QStringList attrList=attributes.value("p").toString().split(',');
+                if(attrList.length()>=4)
+                {
+                    DanmuComment *danmu=new DanmuComment();
+                    danmu->text=reader.readElementText();
+                    danmu->time = attrList[0].toFloat() * 1000;
+                    danmu->originTime=danmu->time;
+                    danmu->setType(attrList[1].toInt());
+                    danmu->color=attrList[3].toInt();
+                    if(attrList.length()>4)
+                        danmu->date=attrList[4].toLongLong();
+                    if(attrList.length()>6)
+                        danmu->sender=attrList[6];
+                    switch (attrList[2].toInt())
+                    {
+                    case 25:
+                        danmu->fontSizeLevel=DanmuComment::Normal;
+                        break;
+                    case 18:
+                        danmu->fontSizeLevel=DanmuComment::Small;
+                        break;
+                    case 36:
+                        danmu->fontSizeLevel=DanmuComment::Large;
+                        break;
+                    default:
+                        break;
+                    }
+                    if(danmu->type!=DanmuComment::UNKNOW)list.append(danmu);
+                    else delete danmu;
+                }
+            }
+            reader.readNext();
+        }
+    }
+}
+class XmlImportBench : public QObject
+{
+    Q_OBJECT
+private:
+    QTemporaryDir fileDir;
+    QString generateFile(int count);
+private slots:
+    void loadXmlDanmuFile_data();
+    void loadXmlDanmuFile();
+    void throughput_data();
+    void throughput();
+    void attributeVariants_data();
+    void attributeVariants();
+};
+
+QString XmlImportBench::generateFile(int count)
+{
+    QString fileName(fileDir.filePath(QString("danmu_%1.xml").arg(count)));
+    if(QFile::exists(fileName))return fileName;
+    DanmuWorkload workload;
+    workload.commentsPerSecond=100;
+    workload.duration=count/workload.commentsPerSecond;
+    QList<DanmuComment *> danmuList(DanmuGenerator::generate(workload));
+    QFile xmlFile(fileName);
+    if(xmlFile.open(QIODevice::WriteOnly))
+        xmlFile.write(DanmuGenerator::toXml(danmuList));
+    qDeleteAll(danmuList);
+    return fileName;
+}
+
+void XmlImportBench::loadXmlDanmuFile_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+    QTest::newRow("500k") << 500000;
+}
+
+void XmlImportBench::loadXmlDanmuFile()
+{
+    QFETCH(int, count);
+    QString fileName(generateFile(count));
+    QList<DanmuComment *> danmuList;
+    QBENCHMARK
+    {
+        qDeleteAll(danmuList);
+        danmuList.clear();
+        LocalProvider::LoadXmlDanmuFile(fileName,danmuList);
+    }
+    QCOMPARE(danmuList.count(),count);
+    qDeleteAll(danmuList);
+}
+
+void XmlImportBench::throughput_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("legacy");
+    for(int count:{10000,100000,500000})
+    {
+        QTest::newRow(QString("%1-legacy").arg(count).toLatin1()) << count << true;
+        QTest::newRow(QString("%1-scanner").arg(count).toLatin1()) << count << false;
+    }
+}
+
+void XmlImportBench::throughput()
+{
+    QFETCH(int, count);
+    QFETCH(bool, legacy);
+    QString fileName(generateFile(count));
+    QList<DanmuComment *> danmuList;
+    int rounds=0;
+    QElapsedTimer timer;
+    timer.start();
+    do
+    {
+        qDeleteAll(danmuList);
+        danmuList.clear();
+        if(legacy)
+            legacyLoadXmlDanmuFile(fileName,danmuList);
+        else
+            LocalProvider::LoadXmlDanmuFile(fileName,danmuList);
+        ++rounds;
+    } while(timer.elapsed()<minMeasureTime);
+    qint64 elapsed=qMax<qint64>(1,timer.elapsed());
+    QCOMPARE(danmuList.count(),count);
+    qDeleteAll(danmuList);
+    qreal bytesPerSecond=qreal(QFileInfo(fileName).size())*rounds*1000/elapsed;
+    qInfo("%s: %.1f MB/s, %d rounds", QTest::currentDataTag(), bytesPerSecond/1024/1024, rounds);
+    QTest::setBenchmarkResult(bytesPerSecond,QTest::BytesPerSecond);
+}
+
+void XmlImportBench::attributeVariants_data()
+{
+    QTest::addColumn<QByteArray>("element");
+    QTest::newRow("plain") << QByteArray("<d p=\"1.5,1,25,16777215,1500000000,0,abc,1\">text</d>");
+    QTest::newRow("single-quote") << QByteArray("<d p='1.5,1,25,16777215,1500000000,0,abc,1'>text</d>");
+    QTest::newRow("attribute-before-p") << QByteArray("<d id=\"1\" p=\"1.5,1,25,16777215,1500000000,0,abc,1\">text</d>");
+    QTest::newRow("whitespace") << QByteArray("<d\n  p = \"1.5,1,25,16777215,1500000000,0,abc,1\">text</d>");
+}
+
+void XmlImportBench::attributeVariants()
+{
+    QFETCH(QByteArray, element);
+    QString fileName(fileDir.filePath("variant.xml"));
+    QFile xmlFile(fileName);
+    QVERIFY(xmlFile.open(QIODevice::WriteOnly|QIODevice::Truncate));
+    xmlFile.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?><i>"+element+"</i>");
+    xmlFile.close();
+    QList<DanmuComment *> danmuList;
+    LocalProvider::LoadXmlDanmuFile(fileName,danmuList);
+    QCOMPARE(danmuList.count(),1);
+    QCOMPARE(danmuList.first()->text,QString("text"));
+    QCOMPARE(danmuList.first()->time,1500);
+    qDeleteAll(danmuList);
+}
+
+QTEST_MAIN(XmlImportBench)
+
+#include "tst_xmlimportbench.moc"
@@ -0,0 +1,9 @@
+include(../common/common.pri)
+include(../common/danmucore.pri)
+
+QT += testlib
+TARGET = xmlimportbench
+TEMPLATE = app
+
+SOURCES += \
+    tst_xmlimportbench.cpp